@@ -0,0 +1,129 @@
+#!/bin/env python
+
+from __future__ import print_function
+
+verbose = __name__ == "__main__"
+
+import os
+import sys
+if not verbose:
+    out = open(os.devnull, 'w')
+else:
+    out = sys.stdout
+from graph_tool.all import *
+import numpy.random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+
+def edge_set(g):
+    return set((int(e.source()), int(e.target()), int(g.edge_index[e]))
+               for e in g.edges())
+
+# edge removal through reversed views
+
+for mode in ["iterable", "array"]:
+    g = random_graph(100, lambda: 5, directed=True)
+    u = GraphView(g, reversed=True)
+
+    es = list(u.edges())[::3]
+    rm = set((int(e.target()), int(e.source()), int(u.edge_index[e]))
+             for e in es)
+    expected = edge_set(g) - rm
+
+    if mode == "iterable":
+        u.remove_edge(es)
+    else:
+        u.remove_edge(numpy.array([(int(e.source()), int(e.target()),
+                                    int(u.edge_index[e])) for e in es],
+                                  dtype="int64"))
+
+    print("reversed removal:", mode, g.num_edges(), len(expected), file=out)
+    assert g.num_edges() == len(expected)
+    assert edge_set(g) == expected
+
+g = random_graph(100, lambda: 5, directed=True)
+u = GraphView(g, reversed=True)
+es = list(u.edges())[::3]
+rm = set((int(e.target()), int(e.source()), int(u.edge_index[e])) for e in es)
+expected = edge_set(g) - rm
+with u.mutation_batch() as batch:
+    for e in es:
+        batch.remove_edge(e)
+print("reversed batch removal:", g.num_edges(), len(expected), file=out)
+assert edge_set(g) == expected
+
+# edge reindexing with property maps which share their storage
+
+g = random_graph(100, lambda: 5, directed=True)
+u = GraphView(g)
+p = g.new_ep("int")
+q = u.own_property(p)
+w = g.new_ep("vector<int>")
+wu = u.own_property(w)
+for e in g.edges():
+    p[e] = g.edge_index[e]
+    w[e] = [int(e.source()), int(e.target())]
+g.remove_edge(list(g.edges())[::2])
+old = dict(((int(e.source()), int(e.target())), p[e]) for e in g.edges())
+g.reindex_edges()
+assert g.edge_index_range == g.num_edges()
+for e in g.edges():
+    s, t = int(e.source()), int(e.target())
+    assert p[e] == old[(s, t)]
+    assert q[e] == p[e]
+    assert list(w[e]) == [s, t]
+    assert list(wu[e]) == [s, t]
+print("shared map reindexing: OK", file=out)
+
+import tempfile
+tmpdir = tempfile.mkdtemp()
+
+# frozen snapshots of graphs which are replaced by load()
+
+fnames = []
+for i in range(2):
+    h = random_graph(100, lambda: 3, directed=True)
+    fnames.append(os.path.join(tmpdir, "g%d.gt" % i))
+    h.save(fnames[-1])
+
+g = Graph()
+g.load(fnames[0])
+g.set_frozen(True)
+pagerank(g)
+g.load(fnames[1])  # same sequence of modifications, hence same version
+assert numpy.allclose(pagerank(g).a, pagerank(load_graph(fnames[1])).a)
+print("frozen snapshot after load(): OK", file=out)
+
+# native edge list reader
+
+def read_csv(content, **kwargs):
+    fname = os.path.join(tmpdir, "edges.csv")
+    with open(fname, "w") as f:
+        f.write(content)
+    return load_graph_from_csv(fname, **kwargs)
+
+g = read_csv("")
+assert g.num_vertices() == 0 and g.num_edges() == 0
+
+g = read_csv("# only a comment\n\n", comment="#")
+assert g.num_vertices() == 0 and g.num_edges() == 0
+
+g = read_csv("a,b,1\nb,c,2\nc,a,3")  # no newline at the end
+assert g.num_edges() == 3
+assert [g.ep.c0[e] for e in g.edges()] == ["1", "2", "3"]
+
+g = read_csv("source,target\n0,1\n\n1,2\r\n", skip_first=True,
+             string_vals=False)
+assert g.num_edges() == 2
+
+for content in ["a,b,1\nb,c\n", "a,b,1\nb,c,2,3\n"]:
+    try:
+        read_csv(content)
+        assert False, "rows with a different number of columns were accepted"
+    except ValueError:
+        pass
+print("edge list reader: OK", file=out)
+
+print("OK")
@@ -248,6 +248,227 @@ for pvals in iter_ranges(pranges):
 
     print(state.entropy(), "\n", file=out)
 
+# batched Gibbs moves with self-loops: the batched entropy differences must
+# agree with the individual ones, and with the change of the entropy after a
+# sweep
+
+from graph_tool.inference.blockmodel import get_entropy_args
+
+gs = g.copy()
+for v in list(gs.vertices())[::5]:
+    gs.add_edge(v, v)
+    gs.add_edge(v, v)
+
+for directed in [False, True]:
+    for deg_corr in [False, True]:
+        for exact in [True, False]:
+            for B in [10, gs.num_vertices()]:
+                print("gibbs with self-loops:", directed, deg_corr, exact, B,
+                      file=out)
+                state = BlockState(GraphView(gs, directed=directed), B=B,
+                                   deg_corr=deg_corr)
+                eargs = dict(state._entropy_args, exact=exact)
+
+                rs = numpy.unique(state.b.fa).astype("uint64")
+                for v in list(gs.vertices())[::10]:
+                    dS = numpy.zeros(len(rs))
+                    state._state.virtual_moves(int(v), rs, dS,
+                                               get_entropy_args(eargs))
+                    ddS = [state.virtual_vertex_move(v, int(r), exact=exact)
+                           for r in rs]
+                    assert numpy.allclose(dS, ddS), \
+                        "inconsistent batched moves: %s %s" % (str(dS),
+                                                               str(ddS))
+
+                S = state.entropy(exact=exact)
+                ret = state.gibbs_sweep(niter=5, entropy_args=dict(exact=exact))
+                print("\t\t", ret, state.get_nonempty_B(), file=out)
+                assert abs(ret[0] - (state.entropy(exact=exact) - S)) < 1e-6, \
+                    "inconsistent entropy delta %g (%g)" % \
+                    (ret[0], state.entropy(exact=exact) - S)
+
+# edge matrix layouts: with max_BE=0 the hash table is always used, otherwise
+# the layout is chosen according to the size of the block graph, and is sparse
+# for large B
+
+def check_moves(state, n):
+    for i in range(n):
+        v = int(randint(0, state.g.num_vertices()))
+        s = int(randint(0, state.B))
+        r = int(state.b[v])
+        if r == s:
+            continue
+        dS = state.virtual_vertex_move(v, s)
+        S = state.entropy()
+        state.move_vertex(v, s)
+        assert abs(dS - (state.entropy() - S)) < 1e-6, \
+            "inconsistent virtual move: %g %g" % (dS, state.entropy() - S)
+        state.move_vertex(v, r)
+
+    # the entries must be the same after rebuilding the table from scratch
+    moves = [(int(randint(0, state.g.num_vertices())),
+              int(randint(0, state.B))) for i in range(n)]
+    dS = [state.virtual_vertex_move(v, s) for v, s in moves]
+    state._state.sync_emat()
+    assert numpy.allclose(dS, [state.virtual_vertex_move(v, s)
+                               for v, s in moves])
+
+gr = random_graph(2000, lambda: 3)
+for directed in [False, True]:
+    for max_BE in [None, 0]:
+        print("edge matrix churn:", directed, max_BE, file=out)
+        u = GraphView(gr, directed=directed)
+        N = u.num_vertices()
+        state = BlockState(u, b=numpy.zeros(N, dtype="int"), B=N,
+                           allow_empty=True, max_BE=max_BE)
+
+        # split into singletons, which grows the table from a single entry
+        for v in numpy.random.permutation(N):
+            state.move_vertex(v, int(v))
+        check_moves(state, 100)
+
+        # random moves, which insert and erase entries
+        for i in range(5):
+            for v in numpy.random.permutation(N):
+                state.move_vertex(v, int(randint(0, N)))
+            check_moves(state, 100)
+
+        # collapse into a few groups, which erases most entries
+        for v in numpy.random.permutation(N):
+            state.move_vertex(v, int(randint(0, 10)))
+        check_moves(state, 100)
+
+for directed in [False, True]:
+    Ss = []
+    for max_BE in [None, 0]:
+        u = GraphView(g, directed=directed)
+        state = BlockState(u, b=u.vertex_index.copy("int"),
+                           B=u.num_vertices(), max_BE=max_BE)
+        seed_rng(43)
+        state.mcmc_sweep(niter=5)
+        bstate = state.get_block_state(vweight=True)
+        bstate.merge_sweep(50, parallel=False,
+                           entropy_args=dict(multigraph=False))
+        Ss.append((state.entropy(), bstate.entropy()))
+    print("dense vs. sparse:", directed, Ss, file=out)
+    assert numpy.allclose(Ss[0], Ss[1])
+
+# snapshots
+
+for directed in [False, True]:
+    print("snapshot, directed:", directed, file=out)
+    state = BlockState(GraphView(g, directed=directed), B=10)
+    S = state.entropy()
+    snap = state.get_snapshot()
+    state.mcmc_sweep(beta=0, niter=5)
+    state.set_snapshot(snap)
+    assert abs(state.entropy() - S) < 1e-8
+
+    # move the first vertex to another group, without updating the counts
+    pos = state._state.snapshot_header_size  # the partition follows it
+    r = numpy.frombuffer(snap, dtype="int32", count=1, offset=pos)[0]
+    bad = bytearray(snap)
+    bad[pos:pos + 4] = numpy.int32((r + 1) % 10).tobytes()
+    for s in [bytes(bad), snap[:-1]]:
+        try:
+            state.set_snapshot(s)
+            assert False, "invalid snapshot was accepted"
+        except ValueError:
+            pass
+        assert abs(state.entropy() - S) < 1e-8
+
+# parallel sweeps, where non-conflicting moves are committed concurrently; the
+# group and edge counts are validated against a full recount by restoring a
+# snapshot of the state
+
+nthreads = openmp_get_num_threads()
+openmp_set_num_threads(4)
+for u, B in [(g, 10), (gr, 100)]:
+    for directed in [False, True]:
+        for deg_corr in [False, True]:
+            print("parallel mcmc:", u.num_vertices(), directed, deg_corr,
+                  file=out)
+            state = BlockState(GraphView(u, directed=directed), B=B,
+                               deg_corr=deg_corr)
+            for i in range(5):
+                S = state.entropy()
+                dS, nmoves = state.mcmc_sweep(niter=2, parallel=True)
+                print("\t", dS, nmoves, file=out)
+                assert abs(dS - (state.entropy() - S)) < 1e-6, \
+                    "inconsistent entropy delta %g (%g)" % (dS,
+                                                            state.entropy() - S)
+                state.set_snapshot(state.get_snapshot())
+openmp_set_num_threads(nthreads)
+
+# parallel tempering; the first two states are always swapped, since they are
+# at the same temperature
+
+betas = [1., 1., .9, .5]
+for directed in [False, True]:
+    u = GraphView(g, directed=directed)
+    b0 = randint(0, 10, u.num_vertices())
+    rets = []
+    for nt in [1, 4]:
+        openmp_set_num_threads(nt)
+        states = [BlockState(u, b=b0.copy()) for beta in betas]
+        tstate = TemperingState(list(states), betas)
+        S = tstate.entropy()
+        seed_rng(44)
+        dS, nmoves, nswaps = tstate.tempering_sweep(niter=10)
+        print("tempering:", directed, nt, dS, nmoves, nswaps, file=out)
+        assert nswaps > 0
+        assert abs(dS - (tstate.entropy() - S)) < 1e-6, \
+            "inconsistent entropy delta %g (%g)" % (dS, tstate.entropy() - S)
+        ids = [id(s) for s in states]
+        order = [ids.index(id(s)) for s in tstate.states]
+        assert sorted(order) == list(range(len(betas)))
+        rets.append((dS, nmoves, nswaps, order,
+                     [s.b.fa.copy() for s in tstate.states]))
+    openmp_set_num_threads(nthreads)
+
+    # the result does not depend on the number of threads
+    assert abs(rets[0][0] - rets[1][0]) < 1e-8
+    assert rets[0][1:4] == rets[1][1:4]
+    assert all((b1 == b2).all() for b1, b2 in zip(rets[0][4], rets[1][4]))
+
+# replicas must be of the same kind
+vfilt = g.new_vp("bool")
+vfilt.a = True
+states = [BlockState(g), BlockState(GraphView(g, vfilt=vfilt))]
+try:
+    TemperingState(states, [1., .5]).tempering_sweep()
+    assert False, "replicas of different kinds were accepted"
+except ValueError:
+    pass
+
+# checkpoints of the minimization
+
+import tempfile
+fname = os.path.join(tempfile.mkdtemp(), "checkpoint.pkl")
+
+for deg_corr in [False, True]:
+    state = minimize_blockmodel_dl(g, deg_corr=deg_corr, checkpoint=fname)
+    lstate = load_checkpoint(fname, g)
+    print("checkpoint:", deg_corr, state.entropy(), lstate.entropy(), file=out)
+    assert isinstance(lstate, BlockState)
+    assert lstate.B == state.B and lstate.deg_corr == deg_corr
+    assert abs(state.entropy() - lstate.entropy()) < 1e-8
+
+    # restoring into an existing state
+    lstate = BlockState(g, B=state.B, deg_corr=deg_corr)
+    assert load_checkpoint(fname, lstate) is lstate
+    assert abs(state.entropy() - lstate.entropy()) < 1e-8
+
+    state = minimize_nested_blockmodel_dl(g, deg_corr=deg_corr,
+                                          checkpoint=fname)
+    lstate = load_checkpoint(fname, g)
+    print("nested checkpoint:", deg_corr, state.entropy(), lstate.entropy(),
+          file=out)
+    assert isinstance(lstate, NestedBlockState)
+    assert [s.B for s in lstate.levels] == [s.B for s in state.levels]
+    assert abs(state.entropy() - lstate.entropy()) < 1e-8
+os.remove(fname)
+
 graph_tool.inference.set_test(False)
 
 print("OK")
\ No newline at end of file
@@ -0,0 +1,260 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BENCH_HH
+#define BENCH_HH
+
+#include "config.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Common harness for the micro-benchmarks in this directory. Each program
+// generates a graph according to the command line options, runs a set of
+// kernels on it with increasing numbers of threads, and prints the best
+// running time of each, together with the throughput in edges per second and
+// the speedup relative to the first thread count.
+//
+// Options (all optional):
+//
+//   -n N        number of vertices (default: 100000)
+//   -k K        average out-degree (default: 10)
+//   -m MODEL    "er" (Erdős–Rényi) or "pa" (preferential attachment, with a
+//               power-law degree distribution) (default: "pa")
+//   -t T1,T2..  comma-separated list of thread counts (default: powers of two
+//               up to the number of available threads)
+//   -r R        number of repetitions of each kernel (default: 3)
+//   -s SEED     random seed (default: 42)
+//   -f NAME     only run kernels whose name contains NAME
+
+struct bench_options
+{
+    size_t N = 100000;
+    size_t k = 10;
+    std::string model = "pa";
+    std::vector<size_t> threads;
+    size_t repeat = 3;
+    size_t seed = 42;
+    std::string filter;
+    size_t max_threads = 1;
+};
+
+inline size_t get_max_threads()
+{
+#ifdef USING_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+inline void set_threads(size_t n)
+{
+#ifdef USING_OPENMP
+    omp_set_num_threads(n);
+#else
+    (void) n;
+#endif
+}
+
+inline bench_options parse_options(int argc, char** argv)
+{
+    bench_options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.size() != 2 || arg[0] != '-' || i + 1 >= argc)
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [-n N] [-k K] [-m er|pa] [-t T1,T2,...] [-r R]"
+                      << " [-s SEED] [-f NAME]" << std::endl;
+            std::exit(1);
+        }
+        std::string val = argv[++i];
+        switch (arg[1])
+        {
+        case 'n':
+            opts.N = std::stoul(val);
+            break;
+        case 'k':
+            opts.k = std::stoul(val);
+            break;
+        case 'm':
+            opts.model = val;
+            break;
+        case 't':
+            {
+                size_t pos = 0;
+                while (pos < val.size())
+                {
+                    size_t end = val.find(',', pos);
+                    if (end == std::string::npos)
+                        end = val.size();
+                    opts.threads.push_back(std::stoul(val.substr(pos, end - pos)));
+                    pos = end + 1;
+                }
+            }
+            break;
+        case 'r':
+            opts.repeat = std::max(std::stoul(val), 1ul);
+            break;
+        case 's':
+            opts.seed = std::stoul(val);
+            break;
+        case 'f':
+            opts.filter = val;
+            break;
+        default:
+            std::cerr << "unknown option: " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+
+    if (opts.model != "er" && opts.model != "pa")
+    {
+        std::cerr << "unknown graph model: " << opts.model << std::endl;
+        std::exit(1);
+    }
+
+    opts.max_threads = get_max_threads();
+    if (opts.threads.empty())
+    {
+        for (size_t t = 1; t < opts.max_threads; t *= 2)
+            opts.threads.push_back(t);
+        opts.threads.push_back(opts.max_threads);
+    }
+    return opts;
+}
+
+// Generate a directed graph with N vertices and approximately N * k edges,
+// either with uniformly random endpoints ("er"), or by preferential attachment
+// ("pa"), where each new vertex is connected to k existing vertices chosen
+// proportionally to their degree.
+template <class RNG>
+boost::adj_list<size_t> generate_graph(const bench_options& opts, RNG& rng)
+{
+    boost::adj_list<size_t> g;
+    size_t N = opts.N;
+    size_t k = opts.k;
+    for (size_t i = 0; i < N; ++i)
+        add_vertex(g);
+
+    if (opts.model == "er")
+    {
+        std::uniform_int_distribution<size_t> sample(0, N - 1);
+        for (size_t i = 0; i < N * k; ++i)
+            add_edge(sample(rng), sample(rng), g);
+    }
+    else
+    {
+        std::vector<size_t> targets;
+        for (size_t v = 1; v < N; ++v)
+        {
+            targets.push_back(v - 1);
+            for (size_t i = 0; i < std::min(k, v); ++i)
+            {
+                std::uniform_int_distribution<size_t> sample(0, targets.size() - 1);
+                size_t u = targets[sample(rng)];
+                add_edge(v, u, g);
+                targets.push_back(u);
+                targets.push_back(v);
+            }
+        }
+    }
+    return g;
+}
+
+inline void print_header(const bench_options& opts, size_t N, size_t E)
+{
+    std::printf("# graph: model=%s N=%zu E=%zu\n", opts.model.c_str(), N, E);
+    std::printf("%-36s %8s %12s %14s %8s\n", "# kernel", "threads",
+                "time (s)", "edges/s", "speedup");
+}
+
+// Run the kernel f() for each of the thread counts given in the options (or
+// only once with a single thread, if parallel == false), and report the best
+// time of opts.repeat runs. The throughput is computed assuming each call of
+// f() processes "work" edges. If reset is given, it is called before each run,
+// and is not included in the measured time.
+template <class F, class Reset>
+void run_bench(const bench_options& opts, const std::string& name,
+               size_t work, bool parallel, F&& f, Reset&& reset)
+{
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos)
+        return;
+
+    std::vector<size_t> threads = opts.threads;
+    if (!parallel)
+        threads = {1};
+
+    double t_1 = 0;
+    for (auto nt : threads)
+    {
+        set_threads(nt);
+        double t_min = std::numeric_limits<double>::max();
+        for (size_t r = 0; r < opts.repeat; ++r)
+        {
+            reset();
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto stop = std::chrono::steady_clock::now();
+            t_min = std::min(t_min,
+                             std::chrono::duration<double>(stop - start).count());
+        }
+        if (t_1 == 0)
+            t_1 = t_min;
+        std::printf("%-36s %8zu %12.6f %14.4g %8.2f\n", name.c_str(), nt,
+                    t_min, work / t_min, t_1 / t_min);
+        std::fflush(stdout);
+    }
+    set_threads(opts.max_threads);
+}
+
+template <class F>
+void run_bench(const bench_options& opts, const std::string& name,
+               size_t work, bool parallel, F&& f)
+{
+    run_bench(opts, name, work, parallel, std::forward<F>(f), [](){});
+}
+
+// prevents the compiler from optimizing away the result of a kernel
+template <class T>
+void do_not_optimize(const T& x)
+{
+    asm volatile("" : : "g"(&x) : "memory");
+}
+
+} // namespace graph_tool
+
+#endif // BENCH_HH
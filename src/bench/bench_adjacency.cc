@@ -0,0 +1,139 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// Traversal of the adjacency lists, for the plain adj_list, and the filtered,
+// reversed and undirected views.
+
+#include "bench.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+template <class Graph>
+void bench_traversal(const bench_options& opts, const string& view, Graph& g,
+                     size_t E)
+{
+    vector<size_t> r(num_vertices(g));
+    typedef typename is_directed::apply<Graph>::type directed_t;
+
+    run_bench(opts, view + " out_edges", directed_t::value ? E : 2 * E, true,
+              [&]()
+              {
+                  parallel_vertex_loop
+                      (g,
+                       [&](auto v)
+                       {
+                           size_t x = 0;
+                           for (auto e : out_edges_range(v, g))
+                               x += target(e, g);
+                           r[v] = x;
+                       });
+                  do_not_optimize(r);
+              });
+
+    // the in-edges of undirected graphs are the same as the out-edges
+    if (directed_t::value)
+    {
+        run_bench(opts, view + " in_edges", E, true,
+                  [&]()
+                  {
+                      parallel_vertex_loop
+                          (g,
+                           [&](auto v)
+                           {
+                               size_t x = 0;
+                               for (auto e : in_edges_range(v, g))
+                                   x += source(e, g);
+                               r[v] = x;
+                           });
+                      do_not_optimize(r);
+                  });
+    }
+
+    for (auto sched : {loop_schedule::runtime, loop_schedule::degree})
+    {
+        string name = view + " edge_loop" +
+            ((sched == loop_schedule::degree) ? " (degree)" : "");
+        vector<double> w(E);
+        run_bench(opts, name, E, true,
+                  [&]()
+                  {
+                      auto eindex = get(edge_index_t(), g);
+                      parallel_edge_loop
+                          (g,
+                           [&](const auto& e)
+                           {
+                               w[eindex[e]] = source(e, g) + target(e, g);
+                           }, sched);
+                      do_not_optimize(w);
+                  });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto opts = parse_options(argc, argv);
+    std::mt19937 rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t E = num_edges(g);
+    print_header(opts, num_vertices(g), E);
+
+    run_bench(opts, "adj_list edges (serial)", E, false,
+              [&]()
+              {
+                  size_t x = 0;
+                  for (auto e : edges_range(g))
+                      x += source(e, g) ^ target(e, g);
+                  do_not_optimize(x);
+              });
+
+    bench_traversal(opts, "adj_list", g, E);
+
+    typedef property_map_type::apply<uint8_t,
+                                     typed_identity_property_map<size_t>>::type
+        vmask_t;
+    typedef property_map_type::apply<uint8_t,
+                                     adj_edge_index_property_map<size_t>>::type
+        emask_t;
+
+    // all vertices and edges are kept, so that only the filtering overhead is
+    // measured
+    vmask_t vmask(num_vertices(g));
+    emask_t emask(g.get_edge_index_range());
+    for (auto v : vertices_range(g))
+        vmask[v] = true;
+    for (auto e : edges_range(g))
+        emask[e] = true;
+    bool vinv = false, einv = false;
+    auto uvmask = vmask.get_unchecked();
+    auto uemask = emask.get_unchecked();
+    typedef decltype(uvmask) uvmask_t;
+    typedef decltype(uemask) uemask_t;
+    filtered_graph<adj_list<size_t>, graph_tool::detail::MaskFilter<uemask_t>, graph_tool::detail::MaskFilter<uvmask_t>>
+        fg(g, graph_tool::detail::MaskFilter<uemask_t>(uemask, einv),
+           graph_tool::detail::MaskFilter<uvmask_t>(uvmask, vinv));
+    bench_traversal(opts, "filtered", fg, E);
+
+    reverse_graph<adj_list<size_t>> rg(g);
+    bench_traversal(opts, "reversed", rg, E);
+
+    UndirectedAdaptor<adj_list<size_t>> ug(g);
+    bench_traversal(opts, "undirected", ug, E);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// PageRank, on the adjacency list and on its frozen CSR snapshot, and with
+// residual pushes, both from scratch and warm-started.
+
+#include "bench.hh"
+#include "centrality/graph_pagerank.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+template <class Graph>
+void bench_pagerank(const bench_options& opts, const string& name, Graph& g,
+                    size_t E)
+{
+    typedef typed_identity_property_map<size_t> vindex_t;
+    typedef property_map_type::apply<double, vindex_t>::type rank_t;
+    rank_t rank(num_vertices(g));
+    ConstantPropertyMap<double, size_t> pers(1. / num_vertices(g));
+    UnityPropertyMap<int, GraphInterface::edge_t> weight;
+
+    // a fixed number of iterations is performed, so that all runs do the same
+    // amount of work
+    size_t max_iter = 10;
+    size_t iter;
+    run_bench(opts, name, max_iter * E, true,
+              [&]()
+              {
+                  get_pagerank()(g, vindex_t(), rank.get_unchecked(), pers,
+                                 weight, 0.85, 0., max_iter, iter);
+                  do_not_optimize(rank);
+              });
+}
+
+// Residual-push PageRank to a fixed precision, starting either from the uniform
+// vector, or from the converged values for the same graph with 0.1% of the
+// edges removed (given zero weight), which corresponds to an incremental
+// update after a small batch of edits.
+template <class Graph, class RNG>
+void bench_pagerank_push(const bench_options& opts, Graph& g, size_t E,
+                         RNG& rng)
+{
+    typedef typed_identity_property_map<size_t> vindex_t;
+    typedef property_map_type::apply<double, vindex_t>::type rank_t;
+    typedef property_map_type::apply<double,
+                                     GraphInterface::edge_index_map_t>::type
+        weight_t;
+    rank_t rank(num_vertices(g)), rank0(num_vertices(g));
+    ConstantPropertyMap<double, size_t> pers(1. / num_vertices(g));
+    weight_t weight, weight0;
+    auto uweight = weight.get_unchecked(g.get_edge_index_range());
+    auto uweight0 = weight0.get_unchecked(g.get_edge_index_range());
+    std::bernoulli_distribution removed(0.001);
+    for (auto e : edges_range(g))
+    {
+        uweight[e] = 1;
+        uweight0[e] = removed(rng) ? 0 : 1;
+    }
+
+    auto reset = [&]()
+        {
+            for (auto v : vertices_range(g))
+                rank[v] = 1. / num_vertices(g);
+        };
+
+    double epsilon = 1e-6;
+    size_t iter;
+    run_bench(opts, "pagerank (push)", E, true,
+              [&]()
+              {
+                  get_pagerank_push()(g, vindex_t(), rank.get_unchecked(),
+                                      pers, uweight, 0.85, epsilon, 0, iter);
+                  do_not_optimize(rank);
+              }, reset);
+
+    reset();
+    get_pagerank_push()(g, vindex_t(), rank0.get_unchecked(), pers, uweight0,
+                        0.85, epsilon, 0, iter);
+    run_bench(opts, "pagerank (push, warm start)", E, true,
+              [&]()
+              {
+                  get_pagerank_push()(g, vindex_t(), rank.get_unchecked(),
+                                      pers, uweight, 0.85, epsilon, 0, iter);
+                  do_not_optimize(rank);
+              },
+              [&]()
+              {
+                  for (auto v : vertices_range(g))
+                      rank[v] = rank0[v];
+              });
+}
+
+int main(int argc, char** argv)
+{
+    auto opts = parse_options(argc, argv);
+    std::mt19937 rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t E = num_edges(g);
+    print_header(opts, num_vertices(g), E);
+
+    bench_pagerank(opts, "pagerank", g, E);
+
+    set_loop_schedule(loop_schedule::degree, 0);
+    bench_pagerank(opts, "pagerank (degree)", g, E);
+    set_loop_schedule(loop_schedule::runtime, 0);
+
+    bench_pagerank_push(opts, g, E, rng);
+
+    csr_adj_list<size_t> fg(g);
+    bench_pagerank(opts, "pagerank (frozen)", fg, E);
+
+    csr_adj_list<size_t, uint32_t> cfg(g);
+    bench_pagerank(opts, "pagerank (frozen, compact)", cfg, E);
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+// Global and local clustering coefficients.
+
+#include "bench.hh"
+#include "clustering/graph_clustering.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+int main(int argc, char** argv)
+{
+    auto opts = parse_options(argc, argv);
+    std::mt19937 rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t E = num_edges(g);
+    print_header(opts, num_vertices(g), E);
+
+    UndirectedAdaptor<adj_list<size_t>> ug(g);
+
+    double c, c_err;
+    run_bench(opts, "global_clustering", E, true,
+              [&]()
+              {
+                  get_global_clustering()(ug, c, c_err);
+                  do_not_optimize(c);
+              });
+
+    typedef property_map_type::apply<double,
+                                     typed_identity_property_map<size_t>>::type
+        clust_t;
+    clust_t clust(num_vertices(g));
+    run_bench(opts, "local_clustering", E, true,
+              [&]()
+              {
+                  set_clustering_to_property()(ug, clust.get_unchecked());
+                  do_not_optimize(clust);
+              });
+
+    return 0;
+}
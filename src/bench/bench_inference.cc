@@ -0,0 +1,334 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// Sweeps of the (degree-corrected) stochastic block model, with the same
+// BlockState and MCMC, Gibbs and merge states that are used by
+// BlockState.mcmc_sweep(), BlockState.gibbs_sweep() and
+// BlockState.merge_sweep().
+//
+// The states are normally constructed from Python, so here they are built in
+// the same way as in BlockState.__init__(), with the default arguments: the
+// block graph and the group counts are obtained from a random partition of
+// the (undirected) graph, with no covariates or label constraints.
+
+#include "bench.hh"
+#include "random.hh"
+
+#include <boost/python.hpp>
+
+#include "inference/graph_blockmodel_util.hh"
+#include "inference/graph_blockmodel.hh"
+#include "inference/graph_blockmodel_mcmc.hh"
+#include "inference/graph_blockmodel_gibbs.hh"
+#include "inference/graph_blockmodel_merge.hh"
+#include "inference/mcmc_loop.hh"
+#include "inference/gibbs_loop.hh"
+#include "inference/merge_loop.hh"
+#include "inference/int_part.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef UndirectedAdaptor<adj_list<size_t>> ug_t;
+typedef eprop_map_t<std::vector<double>>::type vemap_t;
+typedef vprop_map_t<double>::type dmap_t;
+typedef vprop_map_t<uint8_t>::type bmap_t;
+
+// Owns the graph, the block graph and the property maps of a BlockState,
+// which only keeps references or shallow copies of them. The graph is copied,
+// since it is modified by the merges. As in get_block_state(), the weighted
+// states keep the degrees of the vertices (which are merged together) in a
+// separate property map.
+template <class IsWeighted>
+struct block_model
+{
+    typedef typename std::conditional<IsWeighted::value, vmap_t,
+                                      vcmap_t>::type vweight_t;
+    typedef typename std::conditional<IsWeighted::value, emap_t,
+                                      ecmap_t>::type eweight_t;
+    typedef typename std::conditional<IsWeighted::value,
+                                      degs_map_t::unchecked_t,
+                                      simple_degs_t>::type degs_t;
+
+    typedef BlockState<ug_t, degs_t, IsWeighted, std::false_type,
+                       boost::any, boost::any, boost::any,
+                       emap_t::unchecked_t, vmap_t::unchecked_t,
+                       vmap_t::unchecked_t, vmap_t::unchecked_t,
+                       vmap_t::unchecked_t, std::vector<size_t>,
+                       vmap_t::unchecked_t, std::vector<size_t>,
+                       vmap_t::unchecked_t, vmap_t::unchecked_t,
+                       vmap_t::unchecked_t, vmap_t::unchecked_t, bool,
+                       std::vector<int32_t>, vemap_t::unchecked_t,
+                       vemap_t::unchecked_t, vemap_t::unchecked_t,
+                       vemap_t::unchecked_t, dmap_t::unchecked_t,
+                       std::vector<std::vector<double>>,
+                       bmap_t::unchecked_t, bmap_t::unchecked_t, bool>
+        state_t;
+
+    block_model(const adj_list<size_t>& g, const std::vector<size_t>& b,
+                size_t B, rng_t& rng)
+        : _g(g), _ug(_g), _ubg(_bg)
+    {
+        size_t N = num_vertices(_g);
+
+        vweight_t vweight;
+        eweight_t eweight;
+        init_weights(vweight, eweight);
+        _avweight = vweight;
+        _aeweight = eweight;
+
+        for (size_t r = 0; r < B; ++r)
+            add_vertex(_bg);
+
+        gt_hash_map<std::pair<size_t, size_t>,
+                    typename graph_traits<adj_list<size_t>>::edge_descriptor>
+            bedges;
+        for (auto e : edges_range(_ug))
+        {
+            size_t r = b[source(e, _ug)];
+            size_t s = b[target(e, _ug)];
+            auto key = std::make_pair(std::min(r, s), std::max(r, s));
+            auto iter = bedges.find(key);
+            if (iter == bedges.end())
+            {
+                auto be = add_edge(r, s, _bg).first;
+                iter = bedges.insert({key, be}).first;
+            }
+            _mrs[iter->second] += eweight[e];
+        }
+
+        for (auto e : edges_range(_ubg))
+        {
+            _mrp[source(e, _ubg)] += _mrs[e];
+            _mrp[target(e, _ubg)] += _mrs[e];
+        }
+
+        for (auto v : vertices_range(_ug))
+        {
+            _b[v] = b[v];
+            _wr[b[v]] += vweight[v];
+            _merge_map[v] = v;
+        }
+
+        size_t BE = _bg.get_edge_index_range();
+        _abg = std::ref(_ubg);
+        _state = std::make_unique<state_t>
+            (rng, _ug, get_degs(N, IsWeighted()), IsWeighted(), std::false_type(), _abg,
+             _aeweight, _avweight, _mrs.get_unchecked(BE),
+             _mrp.get_unchecked(B), _mrp.get_unchecked(B),
+             _wr.get_unchecked(B), _b.get_unchecked(N), _empty_blocks,
+             _empty_pos.get_unchecked(B), _candidate_blocks,
+             _candidate_pos.get_unchecked(B), _bclabel.get_unchecked(B),
+             _pclabel.get_unchecked(N), _merge_map.get_unchecked(N), true,
+             std::vector<int32_t>(),
+             _rec.get_unchecked(_g.get_edge_index_range()),
+             _drec.get_unchecked(_g.get_edge_index_range()),
+             _brec.get_unchecked(BE), _bdrec.get_unchecked(BE),
+             _brecsum.get_unchecked(B), std::vector<std::vector<double>>(),
+             _ignore_degrees.get_unchecked(N),
+             _bignore_degrees.get_unchecked(B), false);
+    }
+
+    void init_weights(vcmap_t&, ecmap_t&) {}
+
+    void init_weights(vmap_t& vweight, emap_t& eweight)
+    {
+        for (auto e : edges_range(_ug))
+            eweight[e] = 1;
+        for (auto v : vertices_range(_ug))
+        {
+            vweight[v] = 1;
+            _degs[v].emplace_back(in_degreeS()(v, _ug, eweight),
+                                  out_degreeS()(v, _ug, eweight), 1);
+        }
+    }
+
+    simple_degs_t get_degs(size_t, std::false_type)
+    {
+        return simple_degs_t();
+    }
+
+    degs_map_t::unchecked_t get_degs(size_t N, std::true_type)
+    {
+        return _degs.get_unchecked(N);
+    }
+
+    adj_list<size_t> _g;
+    ug_t _ug;
+    adj_list<size_t> _bg;
+    typename state_t::bg_t _ubg;
+
+    degs_map_t _degs;
+    boost::any _abg, _aeweight, _avweight;
+    emap_t _mrs;
+    vmap_t _mrp, _wr, _b, _empty_pos, _candidate_pos, _bclabel, _pclabel,
+        _merge_map;
+    std::vector<size_t> _empty_blocks, _candidate_blocks;
+    vemap_t _rec, _drec, _brec, _bdrec;
+    dmap_t _brecsum;
+    bmap_t _ignore_degrees, _bignore_degrees;
+
+    std::unique_ptr<state_t> _state;
+};
+
+// the defaults of BlockState.mcmc_sweep() and friends
+entropy_args_t get_entropy_args()
+{
+    entropy_args_t ea;
+    ea.dense = false;
+    ea.multigraph = true;
+    ea.exact = true;
+    ea.adjacency = true;
+    ea.recs = true;
+    ea.partition_dl = true;
+    ea.degree_dl = true;
+    ea.degree_dl_kind = deg_dl_kind::DIST;
+    ea.edges_dl = true;
+    return ea;
+}
+
+void bench_sweeps(const bench_options& opts, const adj_list<size_t>& g,
+                  size_t E, rng_t& rng)
+{
+    typedef block_model<std::false_type> model_t;
+    typedef model_t::state_t state_t;
+
+    size_t N = num_vertices(g);
+    size_t B = std::min(size_t(100), N);
+    std::vector<size_t> b(N);
+    std::vector<size_t> vlist;
+    for (auto v : vertices_range(g))
+        vlist.push_back(v);
+
+    std::unique_ptr<model_t> model;
+    auto reset = [&]()
+        {
+            std::uniform_int_distribution<size_t> sample(0, B - 1);
+            for (auto& r : b)
+                r = sample(rng);
+            model = std::make_unique<model_t>(g, b, B, rng);
+        };
+
+    auto ea = get_entropy_args();
+
+    // each sweep visits the neighbourhood of every vertex at least once
+    for (bool parallel : {false, true})
+    {
+        run_bench(opts, parallel ? "mcmc_sweep_parallel" : "mcmc_sweep", 2 * E,
+                  parallel,
+                  [&]()
+                  {
+                      typename MCMC<state_t>::template MCMCBlockState
+                          <python::object, state_t, size_t,
+                           std::vector<size_t>, double, double, entropy_args_t,
+                           bool, bool, bool, bool, size_t>
+                          mcmc_state(python::object(), *model->_state, E,
+                                     vlist, 1., 1., ea, true, parallel, true,
+                                     false, 1);
+                      if (parallel)
+                      {
+                          auto ret = mcmc_sweep_async(mcmc_state, rng);
+                          do_not_optimize(ret);
+                      }
+                      else
+                      {
+                          auto ret = mcmc_sweep(mcmc_state, rng);
+                          do_not_optimize(ret);
+                      }
+                  }, reset);
+    }
+
+    // the Gibbs sweeps evaluate every nonempty group for every vertex
+    for (bool parallel : {false, true})
+    {
+        run_bench(opts, parallel ? "gibbs_sweep_parallel" : "gibbs_sweep",
+                  2 * E, parallel,
+                  [&]()
+                  {
+                      typename Gibbs<state_t>::template GibbsBlockState
+                          <python::object, state_t, size_t,
+                           std::vector<size_t>, double, entropy_args_t, bool,
+                           bool, bool, bool, size_t>
+                          gibbs_state(python::object(), *model->_state, E,
+                                      vlist, 1., ea, true, parallel, true,
+                                      false, 1);
+                      auto ret = gibbs_sweep(gibbs_state, rng);
+                      do_not_optimize(ret);
+                  }, reset);
+    }
+}
+
+// Merge half of the vertices (i.e. the first step of the agglomerative
+// heuristic of minimize_blockmodel_dl()), starting from the trivial partition
+// of the weighted graph.
+void bench_merges(const bench_options& opts, const adj_list<size_t>& g,
+                  size_t E, rng_t& rng)
+{
+    typedef block_model<std::true_type> model_t;
+    typedef model_t::state_t state_t;
+
+    size_t N = num_vertices(g);
+    std::vector<size_t> b(N);
+    for (size_t v = 0; v < N; ++v)
+        b[v] = v;
+
+    std::unique_ptr<model_t> model;
+    auto reset = [&]()
+        {
+            model = std::make_unique<model_t>(g, b, N, rng);
+        };
+
+    auto ea = get_entropy_args();
+    ea.multigraph = false;
+
+    for (bool parallel : {false, true})
+    {
+        run_bench(opts, parallel ? "merge_sweep_parallel" : "merge_sweep",
+                  2 * E, parallel,
+                  [&]()
+                  {
+                      typename Merge<state_t>::template MergeBlockState
+                          <python::object, state_t, size_t, entropy_args_t,
+                           bool, bool, size_t, size_t>
+                          merge_state(python::object(), *model->_state, E, ea,
+                                      parallel, false, 10, N / 2);
+                      auto ret = merge_sweep(merge_state, rng);
+                      do_not_optimize(ret);
+                  }, reset);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // the states hold a reference to their Python class
+    Py_Initialize();
+
+    auto opts = parse_options(argc, argv);
+    rng_t rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t N = num_vertices(g);
+    size_t E = num_edges(g);
+    print_header(opts, N, E);
+
+    init_q_cache(std::min(std::max(E, N) + 1, size_t(10000)));
+
+    bench_sweeps(opts, g, E, rng);
+    bench_merges(opts, g, E, rng);
+
+    return 0;
+}
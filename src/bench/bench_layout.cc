@@ -0,0 +1,68 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+// SFDP spring-block layout, at a single level (i.e. without the coarsening
+// performed by the Python function).
+
+#include "bench.hh"
+#include "layout/graph_sfdp.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+int main(int argc, char** argv)
+{
+    auto opts = parse_options(argc, argv);
+    std::mt19937 rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t N = num_vertices(g);
+    size_t E = num_edges(g);
+    print_header(opts, N, E);
+
+    UndirectedAdaptor<adj_list<size_t>> ug(g);
+
+    typedef typed_identity_property_map<size_t> vindex_t;
+    property_map_type::apply<vector<double>, vindex_t>::type pos(N);
+    property_map_type::apply<uint8_t, vindex_t>::type pin(N);
+    property_map_type::apply<int32_t, vindex_t>::type group(N);
+    UnityPropertyMap<int, size_t> vweight;
+    UnityPropertyMap<int, GraphInterface::edge_t> eweight;
+
+    // a fixed number of iterations is performed, so that all runs do the same
+    // amount of work
+    size_t max_iter = 3;
+    double K = 1;
+    get_sfdp_layout layout(0.2, K, 2., 0.6, 1., 0., 1., K, 0.95, 15, 0.,
+                           max_iter, false);
+
+    std::uniform_real_distribution<> sample(0, sqrt(N) * K);
+    run_bench(opts, "sfdp_layout", max_iter * E, true,
+              [&]()
+              {
+                  layout(ug, pos.get_unchecked(), vweight, eweight,
+                         pin.get_unchecked(), group.get_unchecked(), false,
+                         rng);
+                  do_not_optimize(pos);
+              },
+              [&]()
+              {
+                  for (size_t v = 0; v < N; ++v)
+                      pos[v] = {sample(rng), sample(rng)};
+              });
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+// Breadth-first search and Dijkstra's algorithm, from a single source, and
+// from many sources in parallel (as done e.g. by closeness and betweenness).
+
+#include "bench.hh"
+
+#include <boost/graph/breadth_first_search.hpp>
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef typed_identity_property_map<size_t> vindex_t;
+
+template <class Graph>
+void bfs(const Graph& g, size_t s, vector<size_t>& dist,
+         vector<default_color_type>& color)
+{
+    typedef iterator_property_map<size_t*, vindex_t> dist_t;
+    typedef iterator_property_map<default_color_type*, vindex_t> color_t;
+    std::fill(dist.begin(), dist.end(), 0);
+    std::fill(color.begin(), color.end(), color_traits<default_color_type>::white());
+    breadth_first_search(g, vertex(s, g),
+                         visitor(make_bfs_visitor
+                                 (record_distances(dist_t(dist.data(), vindex_t()),
+                                                   on_tree_edge()))).
+                         vertex_index_map(vindex_t()).
+                         color_map(color_t(color.data(), vindex_t())));
+}
+
+template <class Graph, class Weight>
+void dijkstra(const Graph& g, size_t s, Weight weight, vector<double>& dist)
+{
+    typedef iterator_property_map<double*, vindex_t> dist_t;
+    std::fill(dist.begin(), dist.end(), numeric_limits<double>::infinity());
+    dist[s] = 0;
+    dijkstra_shortest_paths_no_color_map
+        (g, vertex(s, g),
+         weight_map(weight).
+         distance_map(dist_t(dist.data(), vindex_t())).
+         vertex_index_map(vindex_t()).
+         distance_inf(numeric_limits<double>::infinity()));
+}
+
+int main(int argc, char** argv)
+{
+    auto opts = parse_options(argc, argv);
+    std::mt19937 rng(opts.seed);
+    auto g = generate_graph(opts, rng);
+    size_t N = num_vertices(g);
+    size_t E = num_edges(g);
+    print_header(opts, N, E);
+
+    typedef property_map_type::apply<double,
+                                     adj_edge_index_property_map<size_t>>::type
+        weight_t;
+    weight_t weight(g.get_edge_index_range());
+    std::uniform_real_distribution<> sample(0, 1);
+    for (auto e : edges_range(g))
+        weight[e] = sample(rng);
+    auto uweight = weight.get_unchecked();
+
+    UndirectedAdaptor<adj_list<size_t>> ug(g);
+
+    // the same set of sources is used for all runs
+    size_t n_sources = 64;
+    vector<size_t> sources;
+    std::uniform_int_distribution<size_t> vsample(0, N - 1);
+    for (size_t i = 0; i < n_sources; ++i)
+        sources.push_back(vsample(rng));
+
+    vector<size_t> dist(N);
+    vector<double> ddist(N);
+    vector<default_color_type> color(N);
+
+    run_bench(opts, "bfs", 2 * E, false,
+              [&]() { bfs(ug, sources[0], dist, color); });
+
+    run_bench(opts, "dijkstra", 2 * E, false,
+              [&]() { dijkstra(ug, sources[0], uweight, ddist); });
+
+    run_bench(opts, "bfs (multi-source)", 2 * E * n_sources, true,
+              [&]()
+              {
+                  #pragma omp parallel firstprivate(dist, color)
+                  parallel_loop_no_spawn
+                      (sources,
+                       [&](size_t, size_t s) { bfs(ug, s, dist, color); });
+              });
+
+    run_bench(opts, "dijkstra (multi-source)", 2 * E * n_sources, true,
+              [&]()
+              {
+                  #pragma omp parallel firstprivate(ddist)
+                  parallel_loop_no_spawn
+                      (sources,
+                       [&](size_t, size_t s) { dijkstra(ug, s, uweight, ddist); });
+              });
+
+    return 0;
+}
@@ -33,6 +33,10 @@
 #include <boost/graph/named_function_params.hpp>
 #include <algorithm>
 
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 namespace boost {
 
 namespace detail { namespace graph {
@@ -241,40 +245,67 @@ namespace detail { namespace graph {
     }
   };
 
-  // When the edge centrality map is a dummy property map, no
-  // initialization is needed.
-  template<typename Iter>
+  // The centrality values are accumulated in thread-local buffers, indexed by
+  // the vertex or edge index, instead of atomically updating the shared maps,
+  // which would cause heavy contention with many threads. The buffers are
+  // summed into the maps at the end. When the centrality map is a dummy
+  // property map, no buffer is allocated and no update is performed.
+  template<typename Buffer>
   inline void
-  init_centrality_map(std::pair<Iter, Iter>, dummy_property_map) { }
+  init_centrality_buffer(dummy_property_map, Buffer&, size_t) { }
 
-  // When we have a real edge centrality map, initialize all of the
-  // centralities to zero.
-  template<typename Iter, typename Centrality>
-  void
-  init_centrality_map(std::pair<Iter, Iter> keys, Centrality centrality_map)
+  template<typename CentralityMap, typename Buffer>
+  inline void
+  init_centrality_buffer(CentralityMap, Buffer& buffer, size_t n)
   {
-    typedef typename property_traits<Centrality>::value_type
-      centrality_type;
-    while (keys.first != keys.second) {
-      put(centrality_map, *keys.first, centrality_type(0));
-      ++keys.first;
-    }
+    buffer.resize(n);
   }
 
-  // When the edge centrality map is a dummy property map, no update
-  // is performed.
-  template<typename Key, typename T>
+  template<typename Buffer, typename IndexMap, typename Key, typename T>
   inline void
-  update_centrality(dummy_property_map, const Key&, const T&) { }
+  update_centrality(dummy_property_map, Buffer&, IndexMap, const Key&,
+                    const T&) { }
 
-  // When we have a real edge centrality map, add the value to the map
-  template<typename CentralityMap, typename Key, typename T>
+  template<typename CentralityMap, typename Buffer, typename IndexMap,
+           typename Key, typename T>
   inline void
-  update_centrality(CentralityMap& centrality_map, const Key& k, const T& x)
+  update_centrality(CentralityMap&, Buffer& buffer, IndexMap index,
+                    const Key& k, const T& x)
   {
-      auto& val = get(centrality_map, k);
-      #pragma omp atomic
-      val += x;
+    buffer[get(index, k)] += x;
+  }
+
+  template<typename Iter, typename Buffers, typename IndexMap>
+  inline void
+  merge_centrality_buffers(std::pair<Iter, Iter>, dummy_property_map,
+                           Buffers&, IndexMap) { }
+
+  template<typename Iter, typename CentralityMap, typename Buffers,
+           typename IndexMap>
+  void
+  merge_centrality_buffers(std::pair<Iter, Iter> keys,
+                           CentralityMap centrality_map, Buffers& buffers,
+                           IndexMap index)
+  {
+    // each thread sums a contiguous range of all the buffers into the first
+    auto& total = buffers[0];
+    size_t n = total.size();
+    #pragma omp parallel for default(shared) schedule(static) \
+        if (n > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < n; ++i)
+    {
+      for (size_t t = 1; t < buffers.size(); ++t)
+      {
+        // threads that did not take part have empty buffers
+        if (!buffers[t].empty())
+          total[i] += buffers[t][i];
+      }
+    }
+
+    while (keys.first != keys.second) {
+      put(centrality_map, *keys.first, total[get(index, *keys.first)]);
+      ++keys.first;
+    }
   }
 
   template<typename Iter>
@@ -310,26 +341,44 @@ namespace detail { namespace graph {
   {
     typedef typename graph_traits<Graph>::vertex_iterator vertex_iterator;
     typedef typename graph_traits<Graph>::vertex_descriptor vertex_descriptor;
-
-    // Initialize centrality
-    init_centrality_map(vertices(g), centrality);
-    init_centrality_map(edges(g), edge_centrality_map);
+    typedef typename property_traits<DependencyMap>::value_type
+        dependency_type;
+
+    auto edge_index = get(edge_index_t(), g);
+    size_t max_eindex = 0;
+    typename graph_traits<Graph>::edge_iterator e, e_end;
+    for (tie(e, e_end) = edges(g); e != e_end; ++e)
+      max_eindex = std::max(max_eindex, size_t(get(edge_index, *e)) + 1);
+
+    size_t nthreads = 1;
+#ifdef USING_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<typename property_traits<CentralityMap>::value_type>>
+      vbuffers(nthreads);
+    std::vector<std::vector<typename property_traits<EdgeCentralityMap>::value_type>>
+      ebuffers(nthreads);
 
     std::vector<typename property_traits<IncomingMap>::value_type> vincoming(num_vertices(g));
     std::vector<typename property_traits<DistanceMap>::value_type> vdistance(num_vertices(g));
     std::vector<typename property_traits<DependencyMap>::value_type> vdependency(num_vertices(g));
     std::vector<typename property_traits<PathCountMap>::value_type> vpath_count(num_vertices(g));
 
-    int i, N = num_vertices(g);
-    #pragma omp parallel for default(shared) private(i) \
-        firstprivate(vincoming, vdistance, vdependency, vpath_count) \
-        schedule(runtime)
-    for (i = 0; i < N; ++i)
+    int N = num_vertices(g);
+    #pragma omp parallel default(shared) \
+        firstprivate(vincoming, vdistance, vdependency, vpath_count)
     {
-      auto s = vertex(i, g);
-      if (s == graph_traits<Graph>::null_vertex())
-          continue;
+      size_t tid = 0;
+#ifdef USING_OPENMP
+      tid = omp_get_thread_num();
+#endif
+      // allocated by the thread that uses them
+      auto& vbuffer = vbuffers[tid];
+      auto& ebuffer = ebuffers[tid];
+      init_centrality_buffer(centrality, vbuffer, num_vertices(g));
+      init_centrality_buffer(edge_centrality_map, ebuffer, max_eindex);
 
+      // reused across the sources
       std::stack<vertex_descriptor> ordered_vertices;
 
       auto incoming = make_iterator_property_map(vincoming.begin(), vertex_index);
@@ -337,45 +386,54 @@ namespace detail { namespace graph {
       auto dependency = make_iterator_property_map(vdependency.begin(), vertex_index);
       auto path_count = make_iterator_property_map(vpath_count.begin(), vertex_index);
 
-      // Initialize for this iteration
-      vertex_iterator w, w_end;
-      for (tie(w, w_end) = vertices(g); w != w_end; ++w) {
-        incoming[*w].clear();
-        put(path_count, *w, 0);
-        put(dependency, *w, 0);
-      }
-      put(path_count, s, 1);
+      #pragma omp for schedule(runtime)
+      for (int i = 0; i < N; ++i)
+      {
+        auto s = vertex(i, g);
+        if (s == graph_traits<Graph>::null_vertex())
+          continue;
 
-      // Execute the shortest paths algorithm. This will be either
-      // Dijkstra's algorithm or a customized breadth-first search,
-      // depending on whether the graph is weighted or unweighted.
-      shortest_paths(g, s, ordered_vertices, incoming, distance,
-                     path_count, vertex_index);
+        // Initialize for this iteration
+        vertex_iterator w, w_end;
+        for (tie(w, w_end) = vertices(g); w != w_end; ++w) {
+          incoming[*w].clear();
+          put(path_count, *w, 0);
+          put(dependency, *w, 0);
+        }
+        put(path_count, s, 1);
 
-      while (!ordered_vertices.empty())
-      {
+        // Execute the shortest paths algorithm. This will be either
+        // Dijkstra's algorithm or a customized breadth-first search,
+        // depending on whether the graph is weighted or unweighted.
+        shortest_paths(g, s, ordered_vertices, incoming, distance,
+                       path_count, vertex_index);
+
+        while (!ordered_vertices.empty())
+        {
           vertex_descriptor u = ordered_vertices.top();
           ordered_vertices.pop();
 
-          typedef typename property_traits<DependencyMap>::value_type
-              dependency_type;
-
           for (const auto& vw : incoming[u]) {
-              auto v = source(vw, g);
-              auto factor = dependency_type(get(path_count, v))
-                  / dependency_type(get(path_count, u));
-              factor *= (dependency_type(1) + get(dependency, u));
-              put(dependency, v, get(dependency, v) + factor);
-              update_centrality(edge_centrality_map, vw, factor);
+            auto v = source(vw, g);
+            auto factor = dependency_type(get(path_count, v))
+              / dependency_type(get(path_count, u));
+            factor *= (dependency_type(1) + get(dependency, u));
+            put(dependency, v, get(dependency, v) + factor);
+            update_centrality(edge_centrality_map, ebuffer, edge_index, vw,
+                              factor);
           }
 
           if (u != s) {
-              update_centrality(centrality, u, get(dependency, u));
+            update_centrality(centrality, vbuffer, vertex_index, u,
+                              get(dependency, u));
           }
+        }
       }
-
     }
 
+    merge_centrality_buffers(vertices(g), centrality, vbuffers, vertex_index);
+    merge_centrality_buffers(edges(g), edge_centrality_map, ebuffers,
+                             edge_index);
 
     typedef typename graph_traits<Graph>::directed_category directed_category;
     const bool is_undirected =
@@ -23,6 +23,11 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
+
+#include <cmath>
+#include <random>
 
 using namespace std;
 using namespace boost;
@@ -158,6 +163,392 @@ void betweenness(GraphInterface& g, boost::any weight,
     }
 }
 
+// Approximate betweenness
+// -----------------------
+//
+// The dependencies are accumulated only from a sample of k pivot vertices
+// [brandes-centrality-2007], chosen either uniformly without replacement, or
+// with replacement and probability p(s) proportional to the total degree plus
+// one. Each pivot contributes with an importance weight c_s = 1 / (n p(s)), so
+// that n/k times the accumulated values is an unbiased estimate of the exact
+// betweenness.
+//
+// In terms of the normalized betweenness, each pivot yields a sample
+// y_s(v) = c_s delta_s(v) / (n - 2) in [0, R], with R = max_s c_s. The maximum
+// error over all vertices is bounded (with probability at least 1 - delta) by
+// the smallest of Hoeffding's and the empirical Bernstein
+// [maurer-empirical-2009] inequalities, together with a union bound over the
+// vertices. If a target epsilon is given, the pivots are processed in rounds of
+// geometrically increasing size, until the bound falls below it, or the number
+// of pivots reaches the value for which Hoeffding's inequality alone
+// guarantees it.
+//
+// If top_k > 0, the rounds also stop as soon as the set of the top_k vertices
+// with the largest estimates is certain (with the same probability), i.e. when
+// the k-th largest estimate minus the error bound exceeds the next one plus the
+// error bound, in the style of [riondato-abra-2016]. Only the membership in the
+// set is guaranteed, not the order within it.
+//
+// [riondato-abra-2016] M. Riondato, E. Upfal, "ABRA: Approximating Betweenness
+//                      Centrality in Static and Dynamic Graphs with Rademacher
+//                      Averages", Proceedings of KDD, 2016.
+//                      DOI: 10.1145/2939672.2939770
+
+template <class Graph, class EdgeBetweenness, class VertexBetweenness,
+          class DistType, class ShortestPaths, class RNG>
+void sampled_betweenness(const Graph& g, EdgeBetweenness edge_betweenness,
+                         VertexBetweenness vertex_betweenness,
+                         ShortestPaths shortest_paths, DistType,
+                         multi_array_ref<int64_t,1>& pivots, size_t n_samples,
+                         double epsilon, double delta, bool degree_sampling,
+                         size_t top_k, bool normalize, RNG& rng, double& err,
+                         size_t& k)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+    typedef typename property_traits<EdgeBetweenness>::value_type eval_t;
+
+    auto vertex_index = get(vertex_index_t(), g);
+    size_t N = num_vertices(g);
+
+    vector<vertex_t> vlist;
+    for (auto v : vertices_range(g))
+        vlist.push_back(v);
+    size_t n = vlist.size();
+
+    k = 0;
+    err = 0;
+    if (n == 0)
+        return;
+
+    // pivots, and their importance weights
+    vector<vertex_t> sources;
+    vector<double> c;
+    double R = 1;
+
+    std::discrete_distribution<size_t> sample_degree;
+    if (degree_sampling)
+    {
+        vector<double> probs;
+        double W = 0, w_min = numeric_limits<double>::max();
+        for (auto v : vlist)
+        {
+            probs.push_back(total_degreeS()(v, g) + 1);
+            W += probs.back();
+            w_min = std::min(w_min, probs.back());
+        }
+        sample_degree = std::discrete_distribution<size_t>(probs.begin(),
+                                                           probs.end());
+        c.resize(N);
+        for (size_t i = 0; i < n; ++i)
+            c[vertex_index[vlist[i]]] = W / (n * probs[i]);
+        R = W / (n * w_min);
+    }
+
+    double L = log(4 * n / delta);
+
+    size_t K;
+    if (pivots.size() > 0)
+    {
+        for (auto s : pivots)
+        {
+            if (s < 0 || size_t(s) >= N ||
+                !is_valid_vertex(vertex(s, g), g))
+                throw ValueException("invalid pivot vertex: " +
+                                     lexical_cast<string>(s));
+        }
+        K = pivots.size();
+    }
+    else if (epsilon > 0)
+    {
+        K = ceil(R * R * L / (2 * epsilon * epsilon));
+        if (n_samples > 0)
+            K = std::min(K, n_samples);
+    }
+    else
+    {
+        K = n_samples;
+    }
+
+    // with enough uniform pivots, the exact values are obtained
+    bool exact = (pivots.size() == 0 && !degree_sampling && K >= n);
+    if (exact)
+        K = n;
+
+    // size of the first round; in fewer steps the empirical Bernstein bound
+    // cannot fall below epsilon
+    size_t batch = K;
+    if (epsilon > 0 && pivots.size() == 0 && !exact)
+        batch = std::min(K, size_t(ceil(7 * R * L / (3 * epsilon))) + 1);
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             put(edge_betweenness, e, 0);
+         });
+    vector<double> vsum(N), vsum2(N);
+
+    vector<vector<edge_t>> vincoming(N);
+    vector<DistType> vdistance(N);
+    vector<double> vdependency(N);
+    vector<size_t> vpath_count(N);
+
+    while (k < K)
+    {
+        size_t end = std::min(K, k + batch);
+        for (size_t i = k; i < end; ++i)
+        {
+            if (pivots.size() > 0)
+            {
+                sources.push_back(vertex(pivots[i], g));
+            }
+            else if (degree_sampling)
+            {
+                sources.push_back(vlist[sample_degree(rng)]);
+            }
+            else if (exact)
+            {
+                sources.push_back(vlist[i]);
+            }
+            else
+            {
+                std::uniform_int_distribution<size_t> sample(i, n - 1);
+                std::swap(vlist[i], vlist[sample(rng)]);
+                sources.push_back(vlist[i]);
+            }
+        }
+
+        #pragma omp parallel for default(shared) \
+            firstprivate(vincoming, vdistance, vdependency, vpath_count) \
+            schedule(runtime)
+        for (size_t i = k; i < end; ++i)
+        {
+            auto s = sources[i];
+            double c_s = degree_sampling ? c[vertex_index[s]] : 1;
+
+            std::stack<vertex_t> ordered_vertices;
+
+            auto incoming = make_iterator_property_map(vincoming.begin(),
+                                                       vertex_index);
+            auto distance = make_iterator_property_map(vdistance.begin(),
+                                                       vertex_index);
+            auto dependency = make_iterator_property_map(vdependency.begin(),
+                                                         vertex_index);
+            auto path_count = make_iterator_property_map(vpath_count.begin(),
+                                                         vertex_index);
+
+            for (auto w : vertices_range(g))
+            {
+                incoming[w].clear();
+                put(path_count, w, 0);
+                put(dependency, w, 0);
+            }
+            put(path_count, s, 1);
+
+            shortest_paths(g, s, ordered_vertices, incoming, distance,
+                           path_count, vertex_index);
+
+            while (!ordered_vertices.empty())
+            {
+                vertex_t u = ordered_vertices.top();
+                ordered_vertices.pop();
+
+                for (const auto& vw : incoming[u])
+                {
+                    auto v = source(vw, g);
+                    double factor = double(get(path_count, v)) /
+                        get(path_count, u);
+                    factor *= 1 + get(dependency, u);
+                    put(dependency, v, get(dependency, v) + factor);
+                    auto& eb = edge_betweenness[vw];
+                    #pragma omp atomic
+                    eb += eval_t(c_s * factor);
+                }
+
+                if (u != s)
+                {
+                    double x = c_s * get(dependency, u);
+                    auto& sum = vsum[vertex_index[u]];
+                    auto& sum2 = vsum2[vertex_index[u]];
+                    #pragma omp atomic
+                    sum += x;
+                    #pragma omp atomic
+                    sum2 += x * x;
+                }
+            }
+        }
+
+        k = end;
+
+        if (exact || n < 3)
+            break;
+
+        // error bound of the normalized vertex betweenness
+        double eb = numeric_limits<double>::infinity();
+        if (k > 1)
+        {
+            double sigma2 = 0;
+            for (auto v : vlist)
+            {
+                auto i = vertex_index[v];
+                double m = vsum[i] / (k * (n - 2));
+                double m2 = vsum2[i] / (k * double(n - 2) * (n - 2));
+                sigma2 = std::max(sigma2, (m2 - m * m) * k / (k - 1));
+            }
+            eb = sqrt(2 * sigma2 * L / k) + 7 * R * L / (3 * (k - 1));
+        }
+        double hb = R * sqrt(L / (2 * k));
+        err = (n / double(n - 1)) * std::min(eb, hb);
+
+        if (epsilon > 0 && err <= epsilon && pivots.size() == 0)
+            break;
+
+        if (top_k > 0 && top_k < n && pivots.size() == 0)
+        {
+            vector<double> b;
+            for (auto v : vlist)
+                b.push_back(vsum[vertex_index[v]]);
+            std::nth_element(b.begin(), b.begin() + top_k - 1, b.end(),
+                             std::greater<double>());
+            double b_k = b[top_k - 1];
+            double b_next = *std::max_element(b.begin() + top_k, b.end());
+            double f = n / (double(n - 1) * k * (n - 2));
+            if ((b_k - b_next) * f > 2 * err)
+                break;
+        }
+        batch *= 2;
+    }
+
+    bool is_directed = !std::is_convertible
+        <typename graph_traits<Graph>::directed_category,
+         undirected_tag>::value;
+
+    // in undirected graphs each pair is counted twice
+    double scale = n / double(k);
+    if (!is_directed)
+        scale /= 2;
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             put(vertex_betweenness, v, scale * vsum[vertex_index[v]]);
+         });
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             put(edge_betweenness, e, scale * get(edge_betweenness, e));
+         });
+
+    if (normalize)
+        normalize_betweenness(g, edge_betweenness, vertex_betweenness, n);
+    else if (n > 2)
+        err *= (n - 1) * (n - 2) / (is_directed ? 1. : 2.);
+}
+
+struct get_sampled_betweenness
+{
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
+              class RNG>
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
+                    VertexBetweenness vertex_betweenness,
+                    multi_array_ref<int64_t,1>& pivots, size_t n_samples,
+                    double epsilon, double delta, bool degree_sampling,
+                    size_t top_k, bool normalize, RNG& rng, double& err,
+                    size_t& k) const
+    {
+        sampled_betweenness(g, edge_betweenness, vertex_betweenness,
+                            boost::detail::graph::brandes_unweighted_shortest_paths(),
+                            size_t(), pivots, n_samples, epsilon, delta,
+                            degree_sampling, top_k, normalize, rng, err, k);
+    }
+};
+
+struct get_weighted_sampled_betweenness
+{
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
+              class RNG>
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
+                    VertexBetweenness vertex_betweenness,
+                    boost::any weight_map, size_t max_eindex,
+                    multi_array_ref<int64_t,1>& pivots, size_t n_samples,
+                    double epsilon, double delta, bool degree_sampling,
+                    size_t top_k, bool normalize, RNG& rng, double& err,
+                    size_t& k) const
+    {
+        typename EdgeBetweenness::checked_t weight =
+            any_cast<typename EdgeBetweenness::checked_t>(weight_map);
+        auto uweight = weight.get_unchecked(max_eindex + 1);
+        typedef typename property_traits<EdgeBetweenness>::value_type dist_t;
+        sampled_betweenness(g, edge_betweenness, vertex_betweenness,
+                            boost::detail::graph::brandes_dijkstra_shortest_paths
+                                <decltype(uweight)>(uweight),
+                            dist_t(), pivots, n_samples, epsilon, delta,
+                            degree_sampling, top_k, normalize, rng, err, k);
+    }
+};
+
+python::tuple betweenness_sampled(GraphInterface& g, boost::any weight,
+                                  boost::any edge_betweenness,
+                                  boost::any vertex_betweenness,
+                                  bool normalize, python::object opivots,
+                                  size_t n_samples, double epsilon,
+                                  double delta, bool degree_sampling,
+                                  size_t top_k, rng_t& rng)
+{
+    if (!belongs<edge_floating_properties>()(edge_betweenness))
+        throw ValueException("edge property must be of floating point value"
+                             " type");
+
+    if (!belongs<vertex_floating_properties>()(vertex_betweenness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+
+    if (delta <= 0 || delta >= 1)
+        throw ValueException("delta must lie in the interval (0, 1)");
+
+    auto pivots = get_array<int64_t,1>(opivots);
+    if (pivots.size() == 0 && n_samples == 0 && epsilon <= 0)
+        throw ValueException("either pivots, a positive number of samples,"
+                             " or a positive epsilon must be given");
+    // the importance weights only apply to pivots drawn by degree
+    if (pivots.size() > 0 && degree_sampling)
+        throw ValueException("pivots cannot be given with degree sampling");
+
+    double err = 0;
+    size_t k = 0;
+    if (!weight.empty())
+    {
+        run_action<>()
+            (g, std::bind<>(get_weighted_sampled_betweenness(),
+                            std::placeholders::_1, std::placeholders::_2,
+                            std::placeholders::_3, weight,
+                            g.get_edge_index_range(), std::ref(pivots),
+                            n_samples, epsilon, delta, degree_sampling,
+                            top_k, normalize, std::ref(rng), std::ref(err),
+                            std::ref(k)),
+             edge_floating_properties(),
+             vertex_floating_properties())
+            (edge_betweenness, vertex_betweenness);
+    }
+    else
+    {
+        run_action<>()
+            (g, std::bind<>(get_sampled_betweenness(),
+                            std::placeholders::_1, std::placeholders::_2,
+                            std::placeholders::_3, std::ref(pivots),
+                            n_samples, epsilon, delta, degree_sampling,
+                            top_k, normalize, std::ref(rng), std::ref(err),
+                            std::ref(k)),
+             edge_floating_properties(),
+             vertex_floating_properties())
+            (edge_betweenness, vertex_betweenness);
+    }
+    return python::make_tuple(err, k);
+}
+
 struct get_central_point_dominance
 {
     template <class Graph, class VertexBetweenness>
@@ -183,5 +574,6 @@ void export_betweenness()
 {
     using namespace boost::python;
     def("get_betweenness", &betweenness);
+    def("get_betweenness_sampled", &betweenness_sampled);
     def("get_central_point_dominance", &central_point);
 }
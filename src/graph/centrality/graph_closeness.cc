@@ -19,6 +19,7 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_properties.hh"
+#include "numpy_bind.hh"
 
 #include "graph_closeness.hh"
 
@@ -33,7 +34,7 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
 {
     if (weight.empty())
     {
-        run_action<>()(gi,
+        run_frozen_action<>()(gi,
                        std::bind(get_closeness(), std::placeholders::_1,
                                  gi.get_vertex_index(), no_weightS(),
                                  std::placeholders::_2, harmonic, norm),
@@ -41,7 +42,7 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
     else
     {
-        run_action<>()(gi,
+        run_frozen_action<>()(gi,
                        std::bind(get_closeness(), std::placeholders::_1,
                                  gi.get_vertex_index(), std::placeholders::_2,
                                  std::placeholders::_3, harmonic, norm),
@@ -50,7 +51,38 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
 }
 
+boost::python::tuple do_get_closeness_top_k(GraphInterface& gi,
+                                            boost::any weight, size_t k,
+                                            bool harmonic, bool norm)
+{
+    vector<int64_t> top_v;
+    vector<double> top_c;
+    size_t n_pruned = 0;
+    if (weight.empty())
+    {
+        run_frozen_action<>()(gi,
+                       [&](auto& g)
+                       {
+                           get_closeness_top_k()(g, no_weightS(), k, harmonic,
+                                                 norm, top_v, top_c, n_pruned);
+                       })();
+    }
+    else
+    {
+        run_frozen_action<>()(gi,
+                       [&](auto& g, auto w)
+                       {
+                           get_closeness_top_k()(g, w, k, harmonic, norm,
+                                                 top_v, top_c, n_pruned);
+                       },
+                       edge_scalar_properties())(weight);
+    }
+    return boost::python::make_tuple(wrap_vector_owned(top_v),
+                                     wrap_vector_owned(top_c), n_pruned);
+}
+
 void export_closeness()
 {
     boost::python::def("closeness", &do_get_closeness);
+    boost::python::def("closeness_top_k", &do_get_closeness_top_k);
 }
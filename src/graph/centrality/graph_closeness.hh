@@ -20,6 +20,7 @@
 
 #include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <boost/graph/detail/d_ary_heap.hpp>
 
 #include <boost/python/object.hpp>
 #include <boost/python/list.hpp>
@@ -27,6 +28,7 @@
 
 #include "histogram.hh"
 #include "hash_map_wrap.hh"
+#include "graph_multi_bfs.hh"
 
 namespace graph_tool
 {
@@ -56,15 +58,10 @@ struct get_closeness
     {
         using namespace boost;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
 
-        get_vertex_dists_t get_vertex_dists;
+        get_dists_djk get_vertex_dists;
         size_t HN = HardNumVertices()(g);
         parallel_vertex_loop
             (g,
@@ -93,19 +90,73 @@ struct get_closeness
                      }
                  }
 
-                 if (!harmonic)
-                     closeness[v] = 1 / closeness[v];
+                 finish(closeness[v], harmonic, norm, comp_size, HN);
+             });
+    }
+
+    // unweighted version, with many sources searched at once
+    template <class Graph, class VertexIndex, class Closeness>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    Closeness closeness, bool harmonic, bool norm) const
+    {
+        using namespace boost;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename property_traits<Closeness>::value_type c_type;
+
+        vector<vertex_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+
+        size_t HN = HardNumVertices()(g);
+        multi_source_bfs_batches
+            (g, sources,
+             [&](auto& bfs, auto begin, auto end)
+             {
+                 typedef std::remove_reference_t<decltype(bfs)> bfs_t;
+                 std::array<c_type, bfs_t::width> c;
+                 std::array<size_t, bfs_t::width> comp_size;
+                 c.fill(0);
+                 comp_size.fill(1);
+
+                 bfs.run(g, begin, end,
+                         [&](auto, const auto& bits, size_t d)
+                         {
+                             bfs_t::for_each_bit
+                                 (bits,
+                                  [&](size_t i)
+                                  {
+                                      if (!harmonic)
+                                          c[i] += d;
+                                      else
+                                          c[i] += 1. / d;
+                                      ++comp_size[i];
+                                  });
+                         });
 
-                 if (norm)
+                 size_t i = 0;
+                 for (auto s = begin; s != end; ++s, ++i)
                  {
-                     if (harmonic)
-                         closeness[v] /= HN - 1;
-                     else
-                         closeness[v] *= comp_size - 1;
+                     closeness[*s] = c[i];
+                     finish(closeness[*s], harmonic, norm, comp_size[i], HN);
                  }
              });
     }
 
+    template <class Val>
+    static void finish(Val& c, bool harmonic, bool norm, size_t comp_size,
+                       size_t HN)
+    {
+        if (!harmonic)
+            c = 1 / c;
+
+        if (norm)
+        {
+            if (harmonic)
+                c /= HN - 1;
+            else
+                c *= comp_size - 1;
+        }
+    }
 
     class component_djk_visitor: public boost::dijkstra_visitor<>
     {
@@ -139,53 +190,382 @@ struct get_closeness
                                     weight_map(weights).distance_map(dist_map).visitor(vis));
         }
     };
+};
 
-    template <class DistMap>
-    class component_bfs_visitor: public boost::bfs_visitor<>
-    {
-    public:
-        //component_visitor() { }
-        component_bfs_visitor(DistMap dist_map, size_t& comp_size)
-            : _dist_map(dist_map), _comp_size(comp_size) { }
+// Top-k closeness
+// ---------------
+//
+// Only the k vertices with the largest closeness (or harmonic centrality) are
+// obtained, following [bergamini-computing-2016]. The vertices are processed in
+// decreasing order of an initial upper bound on their centrality (ub0 below),
+// computed from their out-neighbours alone, so that good candidates are found
+// early. A vertex is skipped if this bound is below the k-th largest value
+// found so far, and the search from it is abandoned as soon as the bound,
+// updated as the search proceeds, falls below that value.
+//
+// The searches settle the vertices in nondecreasing order of distance. When
+// the first vertex at distance D is reached, the n_s vertices closer than D
+// are known exactly, the remaining q discovered vertices are at distance at
+// least D, and the others at least D + g, where g = 1 for unweighted graphs,
+// and the smallest edge weight otherwise. For unweighted graphs, the q
+// discovered vertices are exactly those at distance D, and at most as many
+// vertices as the sum gamma of their out-degrees can lie at distance D + 1,
+// with the rest at least at D + 2. The number m of further reachable vertices
+// is bounded from above by the size of the weak component, and is exactly
+// that for undirected graphs, so that the centrality can be bounded from above
+// by evaluating it with all of them at these smallest possible distances.
+//
+// [bergamini-computing-2016] E. Bergamini, M. Borassi, P. Crescenzi, A.
+//                            Marino, H. Meyerhenke, "Computing top-k closeness
+//                            centrality faster in unweighted graphs",
+//                            Proceedings of ALENEX, 2016.
+//                            DOI: 10.1137/1.9781611974317.6
 
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
+template <class WeightMap, class Edge>
+auto get_edge_dist(WeightMap w, const Edge& e)
+{
+    return get(w, e);
+}
+
+template <class Edge>
+size_t get_edge_dist(no_weightS, const Edge&)
+{
+    return 1;
+}
+
+template <class Graph, class WeightMap>
+class closeness_search
+{
+public:
+    typedef typename get_val_type<WeightMap>::type val_type;
+
+    closeness_search(const Graph& g, WeightMap weights)
+        : _g(g), _weights(weights),
+          _dist(num_vertices(g), numeric_limits<val_type>::max()),
+          _heap_pos(num_vertices(g), size_t(-1)) {}
+
+    // Computes the centrality of s, unless the upper bound
+    // ub(n_s, S, H, q, gamma, D) (given the number of settled vertices, the
+    // sum of their distances, the sum of their inverse distances, the number
+    // of the other discovered vertices, the sum of their out-degrees, and the
+    // smallest distance among them) falls below threshold(). Returns false in
+    // this case.
+    template <class Bound, class Threshold>
+    bool run(size_t s, Bound&& ub, Threshold&& threshold, bool harmonic,
+             bool norm, size_t HN, double& c)
+    {
+        for (auto v : _touched)
         {
-            ++_comp_size;
+            _dist[v] = numeric_limits<val_type>::max();
+            _heap_pos[v] = size_t(-1);
         }
+        _touched.clear();
+
+        typedef boost::typed_identity_property_map<size_t> idx_t;
+        typedef boost::d_ary_heap_indirect
+            <size_t, 4,
+             boost::iterator_property_map<typename vector<size_t>::iterator,
+                                          idx_t>,
+             boost::iterator_property_map<typename vector<val_type>::iterator,
+                                          idx_t>,
+             std::less<val_type>> queue_t;
+        idx_t idx;
+        queue_t queue(boost::make_iterator_property_map(_dist.begin(), idx),
+                      boost::make_iterator_property_map(_heap_pos.begin(), idx));
+
+        constexpr bool unweighted = std::is_same<WeightMap, no_weightS>::value;
 
-        template <class Edge, class Graph>
-        void tree_edge(Edge e, const Graph& g)
+        _dist[s] = 0;
+        _touched.push_back(s);
+        if (!unweighted)
+            queue.push(s);
+
+        size_t head = 0, n_s = 0, deg_touched = out_degree(s, _g),
+            deg_settled = 0;
+        double S = 0, H = 0;
+        val_type D = 0;
+        while (unweighted ? head < _touched.size() : !queue.empty())
         {
-            _dist_map[target(e, g)] = _dist_map[source(e, g)] + 1;
+            size_t v;
+            if (unweighted)
+            {
+                v = _touched[head++];
+            }
+            else
+            {
+                v = queue.top();
+                queue.pop();
+            }
+
+            val_type d = _dist[v];
+            if (d > D)
+            {
+                D = d;
+                size_t q = _touched.size() - n_s;
+                size_t gamma = deg_touched - deg_settled;
+                if (ub(n_s, S, H, q, gamma, D) < threshold())
+                    return false;
+            }
+
+            ++n_s;
+            deg_settled += out_degree(v, _g);
+            if (v != s)
+            {
+                S += d;
+                H += 1. / d;
+            }
+
+            for (const auto& e : out_edges_range(v, _g))
+            {
+                auto u = target(e, _g);
+                val_type nd = d + get_edge_dist(_weights, e);
+                if (nd >= _dist[u])
+                    continue;
+                if (_dist[u] == numeric_limits<val_type>::max())
+                {
+                    _touched.push_back(u);
+                    deg_touched += out_degree(u, _g);
+                }
+                _dist[u] = nd;
+                if (!unweighted)
+                    queue.push_or_update(u);
+            }
         }
 
-    private:
-        DistMap _dist_map;
-        size_t& _comp_size;
-    };
+        c = harmonic ? H : S;
+        get_closeness::finish(c, harmonic, norm, n_s, HN);
+        return true;
+    }
 
+private:
+    const Graph& _g;
+    WeightMap _weights;
+    vector<val_type> _dist;
+    vector<size_t> _heap_pos;
+    vector<size_t> _touched;
+};
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+struct get_closeness_top_k
+{
+    template <class Graph, class WeightMap>
+    void operator()(const Graph& g, WeightMap weights, size_t k, bool harmonic,
+                    bool norm, vector<int64_t>& top_v, vector<double>& top_c,
+                    size_t& n_pruned) const
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS, size_t& comp_size) const
+        using namespace boost;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        top_v.clear();
+        top_c.clear();
+        n_pruned = 0;
+        if (k == 0)
+            return;
+
+        size_t N = num_vertices(g);
+        size_t HN = HardNumVertices()(g);
+
+        constexpr bool unweighted = std::is_same<WeightMap, no_weightS>::value;
+        bool undirected = !graph_tool::is_directed::apply<Graph>::type::value;
+
+        // sizes of the weak components, which bound the number of reachable
+        // vertices
+        vector<size_t> comp(N);
+        for (size_t v = 0; v < N; ++v)
+            comp[v] = v;
+        auto find = [&](size_t v)
+            {
+                while (comp[v] != v)
+                {
+                    comp[v] = comp[comp[v]];
+                    v = comp[v];
+                }
+                return v;
+            };
+        double g_min = 1;
+        bool first = true;
+        for (auto e : edges_range(g))
         {
-            using namespace boost;
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-            component_bfs_visitor<DistanceMap> vis(dist_map, comp_size);
-            breadth_first_visit(g, s, visitor(vis).
-                                color_map(color_map));
+            size_t u = find(source(e, g));
+            size_t v = find(target(e, g));
+            if (u != v)
+                comp[u] = v;
+            double w = get_edge_dist(weights, e);
+            g_min = first ? w : std::min(g_min, w);
+            first = false;
         }
-    };
+        vector<size_t> comp_size(N), reach(N);
+        for (auto v : vertices_range(g))
+            ++comp_size[find(v)];
+        for (auto v : vertices_range(g))
+            reach[v] = comp_size[find(v)];
+
+        // upper bound on the centrality of a vertex with r reachable vertices
+        // (including itself), given the state of the search (see above)
+        auto get_ub = [&](size_t r, size_t n_s, double S, double H, size_t q,
+                          size_t gamma, double D)
+            {
+                double m_max = r - n_s;
+                double m_min = undirected ? m_max : q;
+                double m_next = unweighted ?
+                    std::min(m_max, double(q + gamma)) : m_max;
+
+                // the m - q undiscovered vertices at their smallest possible
+                // distances
+                auto n_next = [&](double m) { return std::min(m, m_next) - q; };
+                auto n_rest = [&](double m) { return std::max(m - m_next, 0.); };
+
+                double c;
+                if (harmonic)
+                {
+                    c = H + q / D + n_next(m_max) / (D + g_min) +
+                        n_rest(m_max) / (D + 2 * g_min);
+                    if (norm)
+                        c /= HN - 1;
+                }
+                else
+                {
+                    auto F = [&](double m)
+                        {
+                            return S + D * q + (D + g_min) * n_next(m) +
+                                (D + 2 * g_min) * n_rest(m);
+                        };
+                    if (norm)
+                    {
+                        // piecewise linear-fractional in m, hence maximal at
+                        // the ends of the pieces
+                        c = 0;
+                        for (double m : {m_min, m_next, m_max})
+                        {
+                            if (m >= m_min && m <= m_max)
+                                c = std::max(c, (n_s - 1 + m) / F(m));
+                        }
+                    }
+                    else
+                    {
+                        c = 1. / F(m_min);
+                    }
+                }
+                return c;
+            };
+
+        // Initial bounds, from the out-neighbours alone. The vertices are
+        // processed in decreasing order of these, and skipped once they fall
+        // below the threshold.
+        vector<double> ub0(N);
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> mark(N, numeric_limits<size_t>::max());
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     size_t q = 0, gamma = 0;
+                     double D = numeric_limits<double>::infinity();
+                     for (const auto& e : out_edges_range(v, g))
+                     {
+                         auto u = target(e, g);
+                         D = std::min(D, double(get_edge_dist(weights, e)));
+                         if (u == v || mark[u] == v)
+                             continue;
+                         mark[u] = v;
+                         ++q;
+                         gamma += out_degree(u, g);
+                     }
+                     if (q == 0 || D <= 0)
+                         ub0[v] = numeric_limits<double>::infinity();
+                     else
+                         ub0[v] = get_ub(reach[v], 1, 0, 0, q, gamma, D);
+                 });
+        }
+
+        vector<vertex_t> vlist;
+        for (auto v : vertices_range(g))
+            vlist.push_back(v);
+        std::stable_sort(vlist.begin(), vlist.end(),
+                         [&](auto u, auto v) { return ub0[u] > ub0[v]; });
+
+        // current top-k, as a min-heap
+        vector<pair<double, int64_t>> top;
+        double threshold = -numeric_limits<double>::infinity();
+
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            closeness_search<Graph, WeightMap> search(g, weights);
+            size_t pruned = 0;
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < vlist.size(); ++i)
+            {
+                auto v = vlist[i];
+                size_t r = reach[v];
+
+                auto ub = [&](size_t n_s, double S, double H, size_t q,
+                              size_t gamma, double D)
+                    {
+                        return get_ub(r, n_s, S, H, q, gamma, D);
+                    };
+
+                auto get_threshold = [&]()
+                    {
+                        double t;
+                        #pragma omp atomic read
+                        t = threshold;
+                        return t;
+                    };
+
+                double c = 0;
+                if (ub0[v] < get_threshold() ||
+                    !search.run(v, ub, get_threshold, harmonic, norm, HN, c))
+                {
+                    ++pruned;
+                    continue;
+                }
+
+                // the normalized closeness is undefined for vertices that
+                // reach no other
+                if (std::isnan(c))
+                    continue;
+
+                #pragma omp critical (closeness_top_k)
+                {
+                    auto cmp = [](const auto& a, const auto& b)
+                        { return a.first > b.first; };
+                    if (top.size() < k)
+                    {
+                        top.emplace_back(c, v);
+                        std::push_heap(top.begin(), top.end(), cmp);
+                    }
+                    else if (c > top.front().first)
+                    {
+                        std::pop_heap(top.begin(), top.end(), cmp);
+                        top.back() = make_pair(c, int64_t(v));
+                        std::push_heap(top.begin(), top.end(), cmp);
+                    }
+                    if (top.size() == k)
+                    {
+                        #pragma omp atomic write
+                        threshold = top.front().first;
+                    }
+                }
+            }
+
+            #pragma omp atomic
+            n_pruned += pruned;
+        }
+
+        std::sort(top.begin(), top.end(),
+                  [](const auto& a, const auto& b)
+                  {
+                      if (a.first != b.first)
+                          return a.first > b.first;
+                      return a.second < b.second;
+                  });
+        for (auto& x : top)
+        {
+            top_v.push_back(x.second);
+            top_c.push_back(x.first);
+        }
+    }
 };
 
 } // boost namespace
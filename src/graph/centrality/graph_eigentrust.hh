@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_linear_operator.hh"
 
 namespace graph_tool
 {
@@ -31,91 +32,49 @@ struct get_eigentrust
     typedef void result_type;
     template <class Graph, class VertexIndex, class EdgeIndex, class TrustMap,
               class InferredTrustMap>
-    void operator()(Graph& g, VertexIndex vertex_index,
-                    EdgeIndex edge_index, TrustMap c, InferredTrustMap t,
-                    double epslon, size_t max_iter, size_t& iter) const
+    void operator()(Graph& g, VertexIndex, EdgeIndex, TrustMap c,
+                    InferredTrustMap t, double epslon, size_t max_iter,
+                    size_t& iter) const
     {
         using namespace boost;
         typedef typename property_traits<TrustMap>::value_type c_type;
         typedef typename property_traits<InferredTrustMap>::value_type t_type;
 
-        InferredTrustMap t_temp(vertex_index, num_vertices(g));
-
-        // Norm c values
-        InferredTrustMap c_sum(vertex_index);
-        if (is_directed::apply<Graph>::type::value)
-        {
-            TrustMap c_temp(edge_index, c.get_storage().size());
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     c_type sum = 0;
-                     for (const auto& e : out_edges_range(v, g))
-                         sum += get(c, e);
-                     if (sum > 0)
-                     {
-                         for (const auto& e : out_edges_range(v, g))
-                             put(c_temp, e, get(c, e) / sum);
-                     }
-                 });
-            c = c_temp;
-        }
-        else
-        {
-            c_sum.reserve(num_vertices(g));
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     c_sum[v] = 0;
-                     for (const auto& e : out_edges_range(v, g))
-                         c_sum[v] += c[e];
-                 });
-        }
+        // The trust values are normalized by the total trust of the source,
+        // which is done by scaling its entry of the vector before the product.
+        vector<t_type> c_norm(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 c_type sum = 0;
+                 for (const auto& e : out_edges_range(v, g))
+                     sum += get(c, e);
+                 if (is_directed::apply<Graph>::type::value)
+                     c_norm[v] = (sum > 0) ? 1. / sum : 0;
+                 else
+                     c_norm[v] = (sum != 0) ? 1. / abs(sum) : 0;
+             });
 
         // init inferred trust t
+        vector<t_type> x(num_vertices(g));
         auto V = HardNumVertices()(g);
-        parallel_vertex_loop(g, [&](auto v) { t[v] = 1.0/V; });
+        parallel_vertex_loop(g, [&](auto v) { x[v] = 1.0/V; });
 
-        t_type delta = epslon + 1;
+        auto C = make_adjacency_operator
+            (g, c, make_iterator_property_map(c_norm.begin(),
+                                              typed_identity_property_map<size_t>()));
         iter = 0;
-        while (delta >= epslon)
-        {
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     t_temp[v] = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (is_directed::apply<Graph>::type::value)
-                             s = source(e, g);
-                         else
-                             s = target(e, g);
-                         if (!is_directed::apply<Graph>::type::value)
-                             t_temp[v] += get(c, e) * t[s] / abs(c_sum[s]);
-                         else
-                             t_temp[v] += get(c, e) * t[s];
-                     }
-                     delta += abs(t_temp[v] - t[v]);
-                 });
-            swap(t_temp, t);
-
-            ++iter;
-            if (max_iter > 0 && iter== max_iter)
-                break;
-        }
+        anderson_fixed_point
+            ([&](auto& x, auto& y)
+             {
+                 #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+                 C.apply_no_spawn(x, [&](auto v, auto r) { y[v] = r; });
+             }, x, epslon, max_iter, iter);
 
-        if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) {t[v] = t_temp[v];});
+        parallel_vertex_loop(g, [&](auto v) { t[v] = x[v]; });
     }
 };
-
 }
 
 #endif
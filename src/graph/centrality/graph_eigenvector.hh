@@ -21,88 +21,68 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
-
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
+#include "graph_linear_operator.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The eigenvector with the largest eigenvalue of the adjacency matrix. For
+// undirected graphs the matrix is symmetric, and the Lanczos method is used;
+// otherwise, the power iteration is accelerated with Anderson mixing.
 struct get_eigenvector
 {
     template <class Graph, class VertexIndex, class WeightMap,
               class CentralityMap>
-    void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
-                    CentralityMap c, double epsilon, size_t max_iter,
-                    long double& eig) const
+    void operator()(Graph& g, VertexIndex, WeightMap w, CentralityMap c,
+                    double epsilon, size_t max_iter, long double& eig) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap c_temp(vertex_index, num_vertices(g));
+        vector<t_type> x(num_vertices(g));
+        parallel_vertex_loop(g, [&](auto v) { x[v] = c[v]; });
 
-        t_type norm = 0;
-        t_type delta = epsilon + 1;
-        t_type prev_delta = delta + 1;
+        auto A = make_adjacency_operator(g, w);
         size_t iter = 0;
-        while (delta >= epsilon)
+        if (!is_directed::apply<Graph>::type::value)
         {
-            prev_delta = delta;
-            norm = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:norm)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     c_temp[v] = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (is_directed::apply<Graph>::type::value)
-                             s = source(e, g);
-                         else
-                             s = target(e, g);
-                         c_temp[v] += get(w, e) * c[s];
-                     }
-                     norm += power(c_temp[v], 2);
-                 });
-
-            norm = sqrt(norm);
+            eig = lanczos_largest(A, x, epsilon, max_iter, iter);
+        }
+        else
+        {
+            if (detail::vec_dot(x, x) == 0)
+                parallel_vertex_loop(g, [&](auto v) { x[v] = 1; });
 
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
+            t_type lambda = 0;
+            anderson_fixed_point
+                ([&](auto& x, auto& y)
                  {
-                     c_temp[v] /= norm;
-                     delta += abs(c_temp[v] - c[v]);
-                 });
+                     t_type norm = 0, x_norm = 0;
+                     #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+                         reduction(+:norm, x_norm)
+                     A.apply_no_spawn(x,
+                                      [&](auto v, auto r)
+                                      {
+                                          y[v] = r;
+                                          norm += r * r;
+                                          x_norm += x[v] * x[v];
+                                      });
+                     norm = sqrt(norm);
+                     lambda = (x_norm > 0) ? norm / sqrt(x_norm) : 0;
+                     if (norm > 0)
+                         detail::vec_scale(1 / norm, y);
+                 }, x, epsilon, max_iter, iter);
+            eig = lambda;
 
-            swap(c_temp, c);
-
-            ++iter;
-            if (max_iter > 0 && iter == max_iter)
-                break;
-            if (max_iter == 0 && delta >= prev_delta && iter > 100)
-                break;
+            t_type sum = 0;
+            for (auto v : vertices_range(g))
+                sum += x[v];
+            if (sum < 0)
+                detail::vec_scale(t_type(-1), x);
         }
 
-        if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) { c[v] = c_temp[v]; });
-
-        eig = norm;
+        parallel_vertex_loop(g, [&](auto v) { c[v] = x[v]; });
     }
 };
 
@@ -15,123 +15,66 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_HITS_HH
+#define GRAPH_HITS_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
-
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
+#include "graph_linear_operator.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The authority centralities x are the eigenvector of the symmetric cocitation
+// matrix A^T A with the largest eigenvalue, obtained with the Lanczos method,
+// and the hub centralities are y = A x, normalized. The returned value is the
+// largest singular value of A.
 struct get_hits
 {
     template <class Graph, class VertexIndex, class WeightMap,
               class CentralityMap>
-    void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
-                    CentralityMap x, CentralityMap y, double epsilon,
-                    size_t max_iter, long double& eig) const
+    void operator()(Graph& g, VertexIndex, WeightMap w, CentralityMap x,
+                    CentralityMap y, double epsilon, size_t max_iter,
+                    long double& eig) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap x_temp(vertex_index, num_vertices(g));
-        CentralityMap y_temp(vertex_index, num_vertices(g));
-
-        // init centrality
+        // initial authorities
+        vector<t_type> a(num_vertices(g));
         auto V = HardNumVertices()(g);
+        parallel_vertex_loop(g, [&](auto v) { a[v] = 1.0 / V; });
+
+        auto A_in = make_adjacency_operator(g, w);
+        auto A_out = make_adjacency_operator<true>(g, w);
+        product_operator<decltype(A_in), decltype(A_out), t_type>
+            M(A_in, A_out);
+
+        size_t iter = 0;
+        t_type lambda = lanczos_largest(M, a, epsilon, max_iter, iter);
+        eig = sqrt(max(lambda, t_type(0)));
+
+        t_type y_norm = 0;
+        vector<t_type> h(num_vertices(g));
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            reduction(+:y_norm)
+        A_out.apply_no_spawn(a,
+                             [&](auto v, auto r)
+                             {
+                                 h[v] = r;
+                                 y_norm += r * r;
+                             });
+        y_norm = sqrt(y_norm);
+
         parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 x[v] = 1.0 / V;
-                 y[v] = 1.0 / V;
+                 x[v] = a[v];
+                 y[v] = (y_norm > 0) ? h[v] / y_norm : 0;
              });
-
-        t_type x_norm = 0, y_norm = 0;
-
-        t_type delta = epsilon + 1;
-        size_t iter = 0;
-        while (delta >= epsilon)
-        {
-            x_norm = 0, y_norm=0;
-
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) reduction(+:x_norm, y_norm)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     x_temp[v] = 0;
-                     for (const auto& ie : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (is_directed::apply<Graph>::type::value)
-                             s = source(ie, g);
-                         else
-                             s = target(ie, g);
-                         x_temp[v] += get(w, ie) * y[s];
-                     }
-                     x_norm += power(x_temp[v], 2);
-
-                     y_temp[v] = 0;
-
-                     for (const auto& e : out_edges_range(v, g))
-                     {
-                         auto s = target(e, g);
-                         y_temp[v] += get(w, e) * x[s];
-                     }
-                     y_norm += power(y_temp[v], 2);
-                 });
-
-            x_norm = sqrt(x_norm);
-            y_norm = sqrt(y_norm);
-
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     x_temp[v] /= x_norm;
-                     y_temp[v] /= y_norm;
-                     delta += abs(x_temp[v] - x[v]);
-                     delta += abs(y_temp[v] - y[v]);
-                 });
-
-            swap(x_temp, x);
-            swap(y_temp, y);
-
-            ++iter;
-            if (max_iter > 0 && iter== max_iter)
-                break;
-        }
-
-        if (iter % 2 != 0)
-        {
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     x[v] = x_temp[v];
-                     y[v] = y_temp[v];
-                 });
-        }
-
-        eig = x_norm;
     }
 };
 
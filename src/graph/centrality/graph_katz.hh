@@ -15,75 +15,48 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_KATZ_HH
+#define GRAPH_KATZ_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
-
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
+#include "graph_linear_operator.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// Solves x = alpha A x + beta with the Anderson-accelerated fixed-point
+// iteration.
 struct get_katz
 {
     template <class Graph, class VertexIndex, class WeightMap,
               class CentralityMap, class PersonalizationMap>
-    void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
-                    CentralityMap c, PersonalizationMap beta, long double alpha,
+    void operator()(Graph& g, VertexIndex, WeightMap w, CentralityMap c,
+                    PersonalizationMap beta, long double alpha,
                     long double epsilon, size_t max_iter) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
-        CentralityMap c_temp(vertex_index, num_vertices(g));
+        vector<t_type> x(num_vertices(g));
+        parallel_vertex_loop(g, [&](auto v) { x[v] = c[v]; });
 
-        t_type delta = epsilon + 1;
+        auto A = make_adjacency_operator(g, w);
         size_t iter = 0;
-        while (delta >= epsilon)
-        {
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     c_temp[v] = get(beta, v);
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (is_directed::apply<Graph>::type::value)
-                             s = source(e, g);
-                         else
-                             s = target(e, g);
-                         c_temp[v] += alpha * get(w, e) * c[s];
-                     }
-                     delta += abs(c_temp[v] - c[v]);
-                 });
-            swap(c_temp, c);
-
-            ++iter;
-            if (max_iter > 0 && iter == max_iter)
-                break;
-        }
+        anderson_fixed_point
+            ([&](auto& x, auto& y)
+             {
+                 #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+                 A.apply_no_spawn(x,
+                                  [&](auto v, auto r)
+                                  {
+                                      y[v] = get(beta, v) + alpha * r;
+                                  });
+             }, x, epsilon, max_iter, iter);
 
-        if (iter % 2 != 0)
-        {
-            parallel_vertex_loop(g, [&](auto v) {c_temp[v] = c[v];});
-        }
+        parallel_vertex_loop(g, [&](auto v) { c[v] = x[v]; });
     }
 };
 
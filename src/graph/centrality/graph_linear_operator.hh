@@ -0,0 +1,568 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_LINEAR_OPERATOR_HH
+#define GRAPH_LINEAR_OPERATOR_HH
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Linear operators over the graph
+// -------------------------------
+//
+// The spectral centralities (eigenvector, Katz, HITS and eigentrust) all
+// amount to repeated products of a vector with the (weighted) adjacency
+// matrix. The product is implemented here only once, as a single fused kernel
+// which hands each entry of the result to a callback, so that normalizations
+// and convergence checks are accumulated in the same pass. On top of it, two
+// solvers are provided:
+//
+// - lanczos_largest(): the largest eigenvalue of a symmetric operator, and its
+//   eigenvector, with the Lanczos method, restarted from the Ritz vector after
+//   a fixed number of steps [saad-numerical-2011]. The convergence depends on
+//   the square root of the spectral gap, instead of the gap itself as for the
+//   power method.
+//
+// - anderson_fixed_point(): the solution of x = G(x), with Anderson
+//   acceleration of the fixed-point iteration [walker-anderson-2011]. If G is
+//   linear, this is equivalent to GMRES, and the solution is the same limit
+//   reached by the plain iteration, if it converges at all.
+//
+// All vectors are indexed by the vertex index, and the entries of filtered
+// vertices are always zero.
+//
+// [saad-numerical-2011] Y. Saad, "Numerical Methods for Large Eigenvalue
+//                       Problems", 2nd ed., SIAM, 2011.
+// [walker-anderson-2011] H. F. Walker, P. Ni, "Anderson Acceleration for
+//                        Fixed-Point Iterations", SIAM J. Numer. Anal. 49(4),
+//                        1715-1735, 2011.
+
+// The product y = A x, with A_{vu} = w_e d_u for every edge e = (u, v), where d
+// is a per-vertex scale applied to the source. If Transpose == true, the edges
+// are followed in the opposite direction, i.e. A_{uv} = w_e d_v. For undirected
+// graphs both are the same symmetric operator.
+template <class Graph, class Weight, class Scale, bool Transpose = false>
+class adjacency_operator
+{
+public:
+    adjacency_operator(const Graph& g, Weight w, Scale d)
+        : _g(g), _w(w), _d(d) {}
+
+    const Graph& graph() const { return _g; }
+
+    // Calls f(v, y_v) for every vertex, with y = A x. Must be called by all the
+    // threads of the enclosing parallel region.
+    template <class T, class F>
+    void apply_no_spawn(const std::vector<T>& x, F&& f)
+    {
+        parallel_vertex_loop_no_spawn
+            (_g,
+             [&](auto v)
+             {
+                 T y = 0;
+                 if (Transpose)
+                 {
+                     for (const auto& e : out_edges_range(v, _g))
+                     {
+                         auto u = target(e, _g);
+                         y += get(_w, e) * get(_d, u) * x[u];
+                     }
+                 }
+                 else
+                 {
+                     for (const auto& e : in_or_out_edges_range(v, _g))
+                     {
+                         auto u = (is_directed::apply<Graph>::type::value) ?
+                             source(e, _g) : target(e, _g);
+                         y += get(_w, e) * get(_d, u) * x[u];
+                     }
+                 }
+                 f(v, y);
+             });
+    }
+
+private:
+    const Graph& _g;
+    Weight _w;
+    Scale _d;
+};
+
+template <bool Transpose = false, class Graph, class Weight, class Scale>
+adjacency_operator<Graph, Weight, Scale, Transpose>
+make_adjacency_operator(const Graph& g, Weight w, Scale d)
+{
+    return adjacency_operator<Graph, Weight, Scale, Transpose>(g, w, d);
+}
+
+template <bool Transpose = false, class Graph, class Weight>
+auto make_adjacency_operator(const Graph& g, Weight w)
+{
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    return make_adjacency_operator<Transpose>(g, w,
+                                              UnityPropertyMap<int, vertex_t>());
+}
+
+// The product y = A (B x), through an intermediate vector, which holds B x
+// afterwards.
+template <class OpA, class OpB, class T>
+class product_operator
+{
+public:
+    product_operator(OpA& a, OpB& b)
+        : _a(a), _b(b), _tmp(num_vertices(a.graph())) {}
+
+    const auto& graph() const { return _a.graph(); }
+
+    template <class F>
+    void apply_no_spawn(const std::vector<T>& x, F&& f)
+    {
+        _b.apply_no_spawn(x, [&](auto v, auto y) { _tmp[v] = y; });
+        _a.apply_no_spawn(_tmp, f);
+    }
+
+    const std::vector<T>& intermediate() const { return _tmp; }
+
+private:
+    OpA& _a;
+    OpB& _b;
+    std::vector<T> _tmp;
+};
+
+namespace detail
+{
+
+template <class T>
+T vec_dot(const std::vector<T>& x, const std::vector<T>& y)
+{
+    T r = 0;
+    size_t N = x.size();
+    #pragma omp parallel for default(shared) schedule(static) \
+        if (N > OPENMP_MIN_THRESH) reduction(+:r)
+    for (size_t i = 0; i < N; ++i)
+        r += x[i] * y[i];
+    return r;
+}
+
+template <class T>
+T vec_norm1(const std::vector<T>& x)
+{
+    T r = 0;
+    size_t N = x.size();
+    #pragma omp parallel for default(shared) schedule(static) \
+        if (N > OPENMP_MIN_THRESH) reduction(+:r)
+    for (size_t i = 0; i < N; ++i)
+        r += std::abs(x[i]);
+    return r;
+}
+
+// y += a * x
+template <class T>
+void vec_axpy(T a, const std::vector<T>& x, std::vector<T>& y)
+{
+    size_t N = x.size();
+    #pragma omp parallel for default(shared) schedule(static) \
+        if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+        y[i] += a * x[i];
+}
+
+template <class T>
+void vec_scale(T a, std::vector<T>& x)
+{
+    size_t N = x.size();
+    #pragma omp parallel for default(shared) schedule(static) \
+        if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+        x[i] *= a;
+}
+
+// Largest eigenvalue of the symmetric k x k matrix a (in row-major order), and
+// its eigenvector s, with cyclic Jacobi rotations.
+template <class T>
+T dense_symmetric_largest(std::vector<T> a, size_t k, std::vector<T>& s)
+{
+    std::vector<T> q(k * k, 0);
+    for (size_t i = 0; i < k; ++i)
+        q[i * k + i] = 1;
+
+    for (size_t sweep = 0; sweep < 64; ++sweep)
+    {
+        T off = 0, norm = 0;
+        for (size_t i = 0; i < k; ++i)
+        {
+            norm += a[i * k + i] * a[i * k + i];
+            for (size_t j = i + 1; j < k; ++j)
+                off += 2 * a[i * k + j] * a[i * k + j];
+        }
+        auto eps = std::numeric_limits<T>::epsilon();
+        if (off <= eps * eps * (norm + off))
+            break;
+
+        for (size_t p = 0; p < k; ++p)
+        {
+            for (size_t r = p + 1; r < k; ++r)
+            {
+                T apr = a[p * k + r];
+                if (apr == 0)
+                    continue;
+                T theta = (a[r * k + r] - a[p * k + p]) / (2 * apr);
+                T t = 1 / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                if (theta < 0)
+                    t = -t;
+                T c = 1 / std::sqrt(t * t + 1);
+                T sn = t * c;
+                for (size_t i = 0; i < k; ++i)
+                {
+                    T aip = a[i * k + p], air = a[i * k + r];
+                    a[i * k + p] = c * aip - sn * air;
+                    a[i * k + r] = sn * aip + c * air;
+                }
+                for (size_t i = 0; i < k; ++i)
+                {
+                    T api = a[p * k + i], ari = a[r * k + i];
+                    a[p * k + i] = c * api - sn * ari;
+                    a[r * k + i] = sn * api + c * ari;
+                }
+                for (size_t i = 0; i < k; ++i)
+                {
+                    T qip = q[i * k + p], qir = q[i * k + r];
+                    q[i * k + p] = c * qip - sn * qir;
+                    q[i * k + r] = sn * qip + c * qir;
+                }
+            }
+        }
+    }
+
+    size_t j = 0;
+    for (size_t i = 1; i < k; ++i)
+    {
+        if (a[i * k + i] > a[j * k + j])
+            j = i;
+    }
+    s.resize(k);
+    for (size_t i = 0; i < k; ++i)
+        s[i] = q[i * k + j];
+    return a[j * k + j];
+}
+
+// Solves the k x k system (H + lambda I) x = b, with lambda a small multiple of
+// the largest diagonal entry, by Gaussian elimination with partial pivoting.
+template <class T>
+void dense_regularized_solve(std::vector<T> H, std::vector<T> b, size_t k,
+                             std::vector<T>& x)
+{
+    T hmax = 0;
+    for (size_t i = 0; i < k; ++i)
+        hmax = std::max(hmax, H[i * k + i]);
+    for (size_t i = 0; i < k; ++i)
+        H[i * k + i] += hmax * 1e-12;
+
+    for (size_t c = 0; c < k; ++c)
+    {
+        size_t p = c;
+        for (size_t i = c + 1; i < k; ++i)
+        {
+            if (std::abs(H[i * k + c]) > std::abs(H[p * k + c]))
+                p = i;
+        }
+        if (p != c)
+        {
+            for (size_t j = 0; j < k; ++j)
+                std::swap(H[c * k + j], H[p * k + j]);
+            std::swap(b[c], b[p]);
+        }
+        if (H[c * k + c] == 0)
+            continue;
+        for (size_t i = c + 1; i < k; ++i)
+        {
+            T f = H[i * k + c] / H[c * k + c];
+            for (size_t j = c; j < k; ++j)
+                H[i * k + j] -= f * H[c * k + j];
+            b[i] -= f * b[c];
+        }
+    }
+
+    x.resize(k);
+    for (size_t i = k; i-- > 0;)
+    {
+        T r = b[i];
+        for (size_t j = i + 1; j < k; ++j)
+            r -= H[i * k + j] * x[j];
+        x[i] = (H[i * k + i] != 0) ? r / H[i * k + i] : 0;
+    }
+}
+
+} // namespace detail
+
+// Computes the largest (algebraic) eigenvalue of the symmetric operator "op",
+// which is returned, and its eigenvector x, normalized to unit L2 norm and
+// non-negative sum. Upon entry, x must hold the initial vector (if it is zero,
+// the uniform vector is used instead). The iteration stops when the residual
+// |Ax - theta x|_1 falls below epsilon * |theta|, or after max_iter products
+// (if max_iter > 0), whose total is added to iter. Without an iteration limit,
+// it also stops if the residual stagnates for several restarts.
+template <class Op, class T>
+T lanczos_largest(Op& op, std::vector<T>& x, double epsilon, size_t max_iter,
+                  size_t& iter, size_t m = 15)
+{
+    const auto& g = op.graph();
+    size_t N = x.size();
+
+    T norm = std::sqrt(detail::vec_dot(x, x));
+    if (norm == 0)
+    {
+        parallel_vertex_loop(g, [&](auto v) { x[v] = 1; });
+        norm = std::sqrt(detail::vec_dot(x, x));
+    }
+    if (norm == 0)
+        return 0;
+    detail::vec_scale(1 / norm, x);
+
+    std::vector<std::vector<T>> V;
+    std::vector<T> h, s, T_k;
+    size_t n_iter = 0;
+    T theta = 0;
+    T best = std::numeric_limits<T>::infinity();
+    size_t stall = 0;
+    while (max_iter == 0 || n_iter < max_iter)
+    {
+        size_t k = m;
+        if (max_iter > 0)
+            k = std::min(k, max_iter - n_iter);
+
+        if (V.empty())
+            V.emplace_back(N);
+        V[0].swap(x);
+
+        std::vector<T> alpha, beta;
+        bool invariant = false;
+        for (size_t j = 0; j < k; ++j)
+        {
+            if (V.size() < j + 2)
+                V.emplace_back(N);
+            auto& vj = V[j];
+            auto& w = V[j + 1];
+
+            T a = 0;
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH) reduction(+:a)
+            op.apply_no_spawn(vj,
+                              [&](auto v, auto y)
+                              {
+                                  w[v] = y;
+                                  a += y * vj[v];
+                              });
+            ++n_iter;
+            alpha.push_back(a);
+
+            // full reorthogonalization (classical Gram-Schmidt) against the
+            // whole basis, which subsumes the three-term recurrence
+            h.resize(j + 1);
+            for (size_t i = 0; i <= j; ++i)
+                h[i] = detail::vec_dot(w, V[i]);
+            #pragma omp parallel for default(shared) schedule(static) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t l = 0; l < N; ++l)
+            {
+                T r = w[l];
+                for (size_t i = 0; i <= j; ++i)
+                    r -= h[i] * V[i][l];
+                w[l] = r;
+            }
+
+            T b = std::sqrt(detail::vec_dot(w, w));
+            beta.push_back(b);
+            if (b <= std::numeric_limits<T>::epsilon() * std::abs(a) || b == 0)
+            {
+                invariant = true;
+                break;
+            }
+            detail::vec_scale(1 / b, w);
+        }
+
+        size_t n = alpha.size();
+        T_k.assign(n * n, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            T_k[i * n + i] = alpha[i];
+            if (i + 1 < n)
+                T_k[i * n + i + 1] = T_k[(i + 1) * n + i] = beta[i];
+        }
+        theta = detail::dense_symmetric_largest(T_k, n, s);
+
+        // Ritz vector
+        x.resize(N);
+        #pragma omp parallel for default(shared) schedule(static) \
+            if (N > OPENMP_MIN_THRESH)
+        for (size_t l = 0; l < N; ++l)
+        {
+            T r = 0;
+            for (size_t i = 0; i < n; ++i)
+                r += s[i] * V[i][l];
+            x[l] = r;
+        }
+        detail::vec_scale(1 / std::sqrt(detail::vec_dot(x, x)), x);
+
+        // A x - theta x = beta_n s_n v_{n+1}
+        T res = 0;
+        if (!invariant)
+            res = std::abs(beta[n - 1] * s[n - 1]) * detail::vec_norm1(V[n]);
+        if (res <= epsilon * std::abs(theta))
+            break;
+
+        if (max_iter == 0)
+        {
+            if (res < best)
+            {
+                best = res;
+                stall = 0;
+            }
+            else if (++stall >= 10)
+            {
+                break;
+            }
+        }
+    }
+    iter += n_iter;
+
+    T sum = 0;
+    for (size_t l = 0; l < N; ++l)
+        sum += x[l];
+    if (sum < 0)
+        detail::vec_scale(T(-1), x);
+    return theta;
+}
+
+// Solves x = G(x), where "G(x, y)" puts G(x) in y, and is called outside of
+// parallel regions. Upon entry, x must hold the initial vector, and on return
+// it holds the last value of G(x). The iteration stops when |G(x) - x|_1 falls
+// below epsilon, or after max_iter evaluations of G (if max_iter > 0), whose
+// total is added to iter. Without an iteration limit, it also stops if the
+// residual does not improve for 100 consecutive iterations. The history of the
+// last m steps is used for the extrapolation, and is discarded whenever the
+// residual increases, so that the next step is a plain iteration.
+template <class G, class T>
+void anderson_fixed_point(G&& G_map, std::vector<T>& x, double epsilon,
+                          size_t max_iter, size_t& iter, size_t m = 5)
+{
+    size_t N = x.size();
+    std::vector<T> gx(N), f(N), g_prev(N), f_prev(N);
+    std::vector<std::vector<T>> dF, dG;
+    std::vector<T> H(m * m), b, gamma;
+
+    auto get_residual = [&]()
+        {
+            T res = 0;
+            #pragma omp parallel for default(shared) schedule(static) \
+                if (N > OPENMP_MIN_THRESH) reduction(+:res)
+            for (size_t i = 0; i < N; ++i)
+            {
+                f[i] = gx[i] - x[i];
+                res += std::abs(f[i]);
+            }
+            return res;
+        };
+
+    size_t n_iter = 1;
+    G_map(x, gx);
+    T res = get_residual();
+    T best = res;
+    size_t stall = 0;
+
+    size_t k = 0;   // current history length
+    size_t pos = 0; // position of the next history entry
+    while (res >= epsilon && (max_iter == 0 || n_iter < max_iter))
+    {
+        // x = G(x) - dG gamma, with gamma = argmin |f - dF gamma|_2
+        x.swap(gx);
+        if (k > 0)
+        {
+            b.resize(k);
+            std::vector<T> Hk(k * k);
+            for (size_t i = 0; i < k; ++i)
+            {
+                b[i] = detail::vec_dot(dF[i], f);
+                for (size_t j = 0; j < k; ++j)
+                    Hk[i * k + j] = H[i * m + j];
+            }
+            detail::dense_regularized_solve(Hk, b, k, gamma);
+            for (size_t i = 0; i < k; ++i)
+                detail::vec_axpy(-gamma[i], dG[i], x);
+        }
+
+        g_prev.swap(gx);
+        f_prev.swap(f);
+
+        G_map(x, gx);
+        ++n_iter;
+        T nres = get_residual();
+
+        if (!std::isfinite(nres) || nres > res)
+        {
+            k = 0;
+            pos = 0;
+        }
+        else
+        {
+            if (dF.size() < m)
+            {
+                dF.emplace_back(N);
+                dG.emplace_back(N);
+            }
+            auto& df = dF[pos];
+            auto& dg = dG[pos];
+            #pragma omp parallel for default(shared) schedule(static) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                df[i] = f[i] - f_prev[i];
+                dg[i] = gx[i] - g_prev[i];
+            }
+            k = std::min(k + 1, m);
+            for (size_t i = 0; i < k; ++i)
+                H[i * m + pos] = H[pos * m + i] = detail::vec_dot(dF[i], df);
+            pos = (pos + 1) % m;
+        }
+        res = nres;
+
+        if (max_iter == 0)
+        {
+            if (res < best)
+            {
+                best = res;
+                stall = 0;
+            }
+            else if (++stall >= 100)
+            {
+                break;
+            }
+        }
+    }
+    x.swap(gx);
+    iter += n_iter;
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_LINEAR_OPERATOR_HH
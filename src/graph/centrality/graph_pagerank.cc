@@ -29,7 +29,8 @@ using namespace boost;
 using namespace graph_tool;
 
 size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
-                boost::any weight, double d, double epsilon, size_t max_iter)
+                boost::any weight, double d, double epsilon, size_t max_iter,
+                bool push)
 {
     if (!belongs<vertex_floating_properties>()(rank))
         throw ValueException("rank vertex property must have a floating-point value type");
@@ -55,19 +56,95 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
         weight = weight_map_t();
 
     size_t iter;
-    run_action<>()
-        (g, std::bind(get_pagerank(),
-                      std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
-                      std::placeholders::_3, std::placeholders::_4, d,
-                      epsilon, max_iter, std::ref(iter)),
-         vertex_floating_properties(),
-         pers_props_t(), weight_props_t())(rank, pers, weight);
+    if (push)
+        run_frozen_action<>()
+            (g, std::bind(get_pagerank_push(),
+                          std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
+                          std::placeholders::_3, std::placeholders::_4, d,
+                          epsilon, max_iter, std::ref(iter)),
+             vertex_floating_properties(),
+             pers_props_t(), weight_props_t())(rank, pers, weight);
+    else
+        run_frozen_action<>()
+            (g, std::bind(get_pagerank(),
+                          std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
+                          std::placeholders::_3, std::placeholders::_4, d,
+                          epsilon, max_iter, std::ref(iter)),
+             vertex_floating_properties(),
+             pers_props_t(), weight_props_t())(rank, pers, weight);
     return iter;
 }
 
+python::tuple pagerank_multi(GraphInterface& g, python::object opers,
+                             boost::any weight, double d, double epsilon,
+                             size_t max_iter)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    auto pers = get_array<double,2>(opers);
+    if (pers.shape()[0] != g.get_num_vertices(false))
+        throw ValueException("the personalization array must have one row"
+                             " per vertex");
+
+    multi_array<double,2> rank;
+    vector<size_t> iters;
+    run_frozen_action<>()
+        (g, std::bind(get_pagerank_multi(), std::placeholders::_1,
+                      std::placeholders::_2, std::ref(pers), std::ref(rank),
+                      d, epsilon, max_iter, std::ref(iters)),
+         weight_props_t())(weight);
+    return python::make_tuple(wrap_multi_array_owned<double,2>(rank),
+                              wrap_vector_owned(iters));
+}
+
+python::tuple pagerank_multi_push(GraphInterface& g, python::object optr,
+                                  python::object oidx, python::object oval,
+                                  boost::any weight, double d, double epsilon,
+                                  size_t max_iter)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    auto ptr = get_array<int64_t,1>(optr);
+    auto idx = get_array<int64_t,1>(oidx);
+    auto val = get_array<double,1>(oval);
+    if (ptr.size() == 0 || idx.size() != val.size() ||
+        size_t(ptr[ptr.size() - 1]) != idx.size())
+        throw ValueException("invalid compressed personalization vectors");
+
+    vector<int64_t> rptr, ridx;
+    vector<double> rval;
+    vector<size_t> iters;
+    run_frozen_action<>()
+        (g, std::bind(get_pagerank_multi_push(), std::placeholders::_1,
+                      std::placeholders::_2, std::ref(ptr), std::ref(idx),
+                      std::ref(val), d, epsilon, max_iter, std::ref(rptr),
+                      std::ref(ridx), std::ref(rval), std::ref(iters)),
+         weight_props_t())(weight);
+    return python::make_tuple(wrap_vector_owned(rptr), wrap_vector_owned(ridx),
+                              wrap_vector_owned(rval),
+                              wrap_vector_owned(iters));
+}
 
 void export_pagerank()
 {
     using namespace boost::python;
     def("get_pagerank", &pagerank);
+    def("get_pagerank_multi", &pagerank_multi);
+    def("get_pagerank_multi_push", &pagerank_multi_push);
 }
@@ -21,6 +21,9 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include <deque>
 
 namespace graph_tool
 {
@@ -93,5 +96,422 @@ struct get_pagerank
     }
 };
 
+// Residual-push (Gauss-Southwell) variant. The rank vector x is the solution
+// of (I - d A) x = (1 - d) p, where A_uv = w_vu / k_v. Starting from the values
+// in the rank map (which may be the result of a previous run, before the graph
+// was modified), the residual r = (1 - d) p - (I - d A) x is computed once,
+// and then "pushed" from the vertices v with |r_v| > epsilon / N: r_v is added
+// to x_v, and d r_v w_vu / k_v to the residual of each out-neighbour u. Only
+// the vertices in the work queue are touched, and the queue is processed in
+// rounds, in parallel. At the end the total residual is at most epsilon, and
+// hence the L1 distance to the exact solution is at most epsilon / (1 - d).
+
+struct get_pagerank_push
+{
+    template <class Graph, class VertexIndex, class RankMap, class PerMap,
+              class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
+                    PerMap pers, Weight weight, double damping, double epsilon,
+                    size_t max_iter, size_t& iter) const
+    {
+        typedef typename property_traits<RankMap>::value_type rank_type;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        RankMap res(vertex_index, num_vertices(g));
+        RankMap deg(vertex_index, num_vertices(g));
+
+        // init degs
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 put(deg, v, out_degreeS()(v, g, weight));
+             });
+
+        rank_type d = damping;
+
+        // initial residual
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 rank_type r = 0;
+                 for (const auto& e : in_or_out_edges_range(v, g))
+                 {
+                     vertex_t s;
+                     if (is_directed::apply<Graph>::type::value)
+                         s = source(e, g);
+                     else
+                         s = target(e, g);
+                     r += (get(rank, s) * get(weight, e)) / get(deg, s);
+                 }
+                 put(res, v, (1.0 - d) * get(pers, v) - get(rank, v) + d * r);
+             });
+
+        rank_type tau = epsilon / HardNumVertices()(g);
+
+        vector<vertex_t> queue, next;
+        vector<uint8_t> queued(num_vertices(g), false);
+        for (auto v : vertices_range(g))
+        {
+            if (abs(res[v]) > tau)
+            {
+                queue.push_back(v);
+                queued[v] = true;
+            }
+        }
+
+        iter = 0;
+        while (!queue.empty())
+        {
+            next.clear();
+            #pragma omp parallel if (queue.size() > OPENMP_MIN_THRESH)
+            {
+                vector<vertex_t> lnext;
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < queue.size(); ++i)
+                {
+                    auto v = queue[i];
+
+                    // the flag is cleared before the residual is taken, so
+                    // that later pushes into v enqueue it again
+                    #pragma omp atomic write
+                    queued[v] = false;
+
+                    rank_type rv;
+                    #pragma omp atomic capture
+                    {
+                        rv = res[v];
+                        res[v] = 0;
+                    }
+
+                    rank[v] += rv;
+
+                    if (deg[v] == 0)
+                        continue;
+
+                    for (const auto& e : out_edges_range(v, g))
+                    {
+                        auto u = target(e, g);
+                        rank_type x = (d * rv * get(weight, e)) / deg[v];
+                        rank_type ru;
+                        #pragma omp atomic capture
+                        {
+                            res[u] += x;
+                            ru = res[u];
+                        }
+                        if (abs(ru) <= tau)
+                            continue;
+                        uint8_t was_queued;
+                        #pragma omp atomic capture
+                        {
+                            was_queued = queued[u];
+                            queued[u] = true;
+                        }
+                        if (!was_queued)
+                            lnext.push_back(u);
+                    }
+                }
+
+                #pragma omp critical
+                next.insert(next.end(), lnext.begin(), lnext.end());
+            }
+            queue.swap(next);
+            ++iter;
+            if (max_iter > 0 && iter == max_iter)
+                break;
+        }
+    }
+};
+
+// Personalized PageRank for many personalization vectors at once. The rank
+// vectors are kept as a dense V x k block, with the k values of each vertex
+// contiguous in memory, so that each edge is read only once per sweep for all
+// of them, and the inner loops over the columns are vectorized. Each column
+// stops being iterated when its own total delta falls below epsilon (or after
+// max_iter sweeps); its values are then written to the output, and the block
+// is periodically compacted to contain only the active columns.
+
+struct get_pagerank_multi
+{
+    template <class Graph, class Weight>
+    void operator()(Graph& g, Weight weight, multi_array_ref<double,2>& pers,
+                    multi_array<double,2>& rank_out, double damping,
+                    double epsilon, size_t max_iter,
+                    vector<size_t>& iters) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g);
+        size_t K = pers.shape()[1];
+
+        vector<double> deg(N);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 deg[v] = out_degreeS()(v, g, weight);
+             });
+
+        rank_out.resize(extents[N][K]);
+        iters.clear();
+        iters.resize(K, 0);
+
+        // active columns, and the block of their values
+        vector<size_t> cols(K);
+        for (size_t j = 0; j < K; ++j)
+            cols[j] = j;
+        size_t k = K;
+        vector<double> p(N * k), rank(N * k), r_temp(N * k);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 for (size_t j = 0; j < k; ++j)
+                     p[v * k + j] = rank[v * k + j] = pers[v][j];
+             });
+
+        vector<uint8_t> done(k, false);
+        size_t n_done = 0;
+        double d = damping;
+        size_t iter = 0;
+        while (n_done < k)
+        {
+            vector<double> delta(k, 0);
+
+            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+            {
+                vector<double> ldelta(k, 0), r(k);
+                parallel_vertex_loop_no_spawn
+                    (g,
+                     [&](auto v)
+                     {
+                         std::fill(r.begin(), r.end(), 0);
+                         for (const auto& e : in_or_out_edges_range(v, g))
+                         {
+                             vertex_t s;
+                             if (is_directed::apply<Graph>::type::value)
+                                 s = source(e, g);
+                             else
+                                 s = target(e, g);
+                             double c = get(weight, e) / deg[s];
+                             const double* rs = &rank[s * k];
+                             for (size_t j = 0; j < k; ++j)
+                                 r[j] += c * rs[j];
+                         }
+
+                         double* rt = &r_temp[v * k];
+                         const double* pv = &p[v * k];
+                         const double* rv = &rank[v * k];
+                         for (size_t j = 0; j < k; ++j)
+                         {
+                             rt[j] = (1 - d) * pv[j] + d * r[j];
+                             ldelta[j] += abs(rt[j] - rv[j]);
+                         }
+                     });
+
+                #pragma omp critical
+                for (size_t j = 0; j < k; ++j)
+                    delta[j] += ldelta[j];
+            }
+            swap(rank, r_temp);
+            ++iter;
+
+            // retire the converged columns
+            for (size_t j = 0; j < k; ++j)
+            {
+                if (done[j])
+                    continue;
+                if (delta[j] >= epsilon && (max_iter == 0 || iter < max_iter))
+                    continue;
+                parallel_vertex_loop
+                    (g,
+                     [&](auto v)
+                     {
+                         rank_out[v][cols[j]] = rank[v * k + j];
+                     });
+                iters[cols[j]] = iter;
+                done[j] = true;
+                ++n_done;
+            }
+
+            // compact the block once a quarter of it is inactive
+            if (n_done == k || n_done < (k + 3) / 4)
+                continue;
+
+            vector<size_t> keep;
+            for (size_t j = 0; j < k; ++j)
+            {
+                if (!done[j])
+                    keep.push_back(j);
+            }
+            size_t nk = keep.size();
+            vector<double> np(N * nk), nrank(N * nk);
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     for (size_t j = 0; j < nk; ++j)
+                     {
+                         np[v * nk + j] = p[v * k + keep[j]];
+                         nrank[v * nk + j] = rank[v * k + keep[j]];
+                     }
+                 });
+            for (size_t j = 0; j < nk; ++j)
+                keep[j] = cols[keep[j]];
+            cols.swap(keep);
+            p.swap(np);
+            rank.swap(nrank);
+            r_temp.resize(N * nk);
+            k = nk;
+            done.assign(k, false);
+            n_done = 0;
+        }
+    }
+};
+
+// Local forward-push approximation of personalized PageRank, for sparse
+// personalization vectors [andersen-local-2006]. Each column is computed
+// independently by a single thread, with the same pushes as get_pagerank_push
+// above, starting from zero and stopping when every residual is at most
+// epsilon. Only the vertices reached by the pushes are touched, so the work
+// does not depend on the size of the graph. The personalization vectors are
+// given in compressed sparse column form (ptr, idx, val), and so is the
+// result.
+
+struct get_pagerank_multi_push
+{
+    template <class Graph, class Weight>
+    void operator()(Graph& g, Weight weight, multi_array_ref<int64_t,1>& ptr,
+                    multi_array_ref<int64_t,1>& idx,
+                    multi_array_ref<double,1>& val, double damping,
+                    double epsilon, size_t max_iter, vector<int64_t>& optr,
+                    vector<int64_t>& oidx, vector<double>& oval,
+                    vector<size_t>& iters) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g);
+        size_t K = ptr.size() - 1;
+
+        for (auto v : idx)
+        {
+            if (v < 0 || size_t(v) >= N || !is_valid_vertex(vertex(v, g), g))
+                throw ValueException("invalid vertex: " +
+                                     lexical_cast<string>(v));
+        }
+
+        vector<double> deg(N);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 deg[v] = out_degreeS()(v, g, weight);
+             });
+
+        vector<vector<pair<int64_t, double>>> cols(K);
+        iters.clear();
+        iters.resize(K, 0);
+        double d = damping;
+
+        #pragma omp parallel if (K > 1)
+        {
+            vector<double> x(N), r(N);
+            vector<uint8_t> touched(N, false), queued(N, false);
+            vector<vertex_t> tlist;
+            std::deque<vertex_t> queue;
+
+            auto touch = [&](auto v)
+                {
+                    if (!touched[v])
+                    {
+                        touched[v] = true;
+                        tlist.push_back(v);
+                    }
+                };
+
+            #pragma omp for schedule(runtime)
+            for (size_t j = 0; j < K; ++j)
+            {
+                for (int64_t i = ptr[j]; i < ptr[j + 1]; ++i)
+                {
+                    vertex_t v = vertex(idx[i], g);
+                    r[v] += (1 - d) * val[i];
+                    touch(v);
+                }
+
+                for (auto v : tlist)
+                {
+                    if (abs(r[v]) > epsilon)
+                    {
+                        queue.push_back(v);
+                        queued[v] = true;
+                    }
+                }
+
+                size_t& n_push = iters[j];
+                while (!queue.empty())
+                {
+                    if (max_iter > 0 && n_push == max_iter)
+                        break;
+
+                    auto v = queue.front();
+                    queue.pop_front();
+                    queued[v] = false;
+
+                    double rv = r[v];
+                    r[v] = 0;
+                    x[v] += rv;
+                    ++n_push;
+
+                    if (deg[v] == 0)
+                        continue;
+
+                    for (const auto& e : out_edges_range(v, g))
+                    {
+                        auto u = target(e, g);
+                        r[u] += (d * rv * get(weight, e)) / deg[v];
+                        touch(u);
+                        if (abs(r[u]) > epsilon && !queued[u])
+                        {
+                            queue.push_back(u);
+                            queued[u] = true;
+                        }
+                    }
+                }
+
+                std::sort(tlist.begin(), tlist.end());
+                for (auto v : tlist)
+                {
+                    if (x[v] != 0)
+                        cols[j].emplace_back(v, x[v]);
+                    x[v] = r[v] = 0;
+                    touched[v] = queued[v] = false;
+                }
+                tlist.clear();
+                queue.clear();
+            }
+        }
+
+        optr.resize(K + 1);
+        optr[0] = 0;
+        for (size_t j = 0; j < K; ++j)
+            optr[j + 1] = optr[j] + cols[j].size();
+        oidx.resize(optr[K]);
+        oval.resize(optr[K]);
+        for (size_t j = 0; j < K; ++j)
+        {
+            size_t pos = optr[j];
+            for (auto& xv : cols[j])
+            {
+                oidx[pos] = xv.first;
+                oval[pos] = xv.second;
+                ++pos;
+            }
+        }
+    }
+};
+
 }
 #endif // GRAPH_PAGERANK_HH
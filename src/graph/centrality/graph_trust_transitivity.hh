@@ -23,74 +23,138 @@
 #include "graph_util.hh"
 
 #include <algorithm>
+#include <vector>
 
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
-#include <iostream>
+#include <boost/graph/detail/d_ary_heap.hpp>
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
-
-struct stop_search {}; // exception to be thrown to stop search
-
-template <class SourceMap, class WeightMap>
-class source_counter:
-    public boost::dijkstra_visitor<null_visitor>
+// Search for the paths with maximum weight, i.e. Dijkstra's algorithm with the
+// path weights combined by multiplication and compared in reverse, which is
+// valid since all trust values lie in [0, 1]. A single vertex can be excluded
+// from the graph. The buffers are kept between searches, and only the entries
+// touched by the previous one are reset, so that each search costs only as much
+// as the part of the graph it reaches.
+template <class Graph, class TrustMap, class Type>
+class trust_search
 {
 public:
-    source_counter(SourceMap source_map, WeightMap weight_map, size_t n_sources)
-        : _source_map(source_map), _weight_map(weight_map),
-          _n_sources(n_sources) {}
+    trust_search(const Graph& g, TrustMap c)
+        : _g(g), _c(c), _dist(num_vertices(g), 0),
+          _done(num_vertices(g), false),
+          _heap_pos(num_vertices(g), size_t(-1)) {}
 
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
-                        Graph&)
+    // Searches from s, without going through "skip". If Reversed == true, the
+    // edges are followed backwards, so that the weights are those of the paths
+    // from every vertex to s. The function f(v) is called for every vertex in
+    // the order in which they are settled, and the search stops if it returns
+    // true.
+    template <bool Reversed, class F>
+    void run(size_t s, size_t skip, F&& f)
     {
-        // stop if all sources are found
-        if (_source_map[u])
+        clear();
+        queue_t queue(make_iterator_property_map(_dist.begin(), _idx),
+                      make_iterator_property_map(_heap_pos.begin(), _idx));
+        _dist[s] = 1;
+        _touched.push_back(s);
+        queue.push(s);
+        while (!queue.empty())
         {
-            _n_sources--;
-            if (_n_sources == 0)
-                throw stop_search();
+            size_t v = queue.top();
+            queue.pop();
+            Type d = _dist[v];
+            _done[v] = true;
+
+            if (f(v))
+                break;
+
+            if (Reversed)
+            {
+                for (const auto& e : in_or_out_edges_range(v, _g))
+                {
+                    auto u = (is_directed::apply<Graph>::type::value) ?
+                        source(e, _g) : target(e, _g);
+                    relax(queue, u, skip, d * get(_c, e));
+                }
+            }
+            else
+            {
+                for (const auto& e : out_edges_range(v, _g))
+                    relax(queue, target(e, _g), skip, d * get(_c, e));
+            }
         }
     }
 
+    // Weight of the best path found in the last search, or zero if the vertex
+    // was not reached.
+    Type operator[](size_t v) const { return _dist[v]; }
+
+    // Vertices reached in the last search.
+    const vector<size_t>& touched() const { return _touched; }
+
 private:
-    SourceMap _source_map;
-    WeightMap _weight_map;
-    size_t _n_sources;
-};
+    typedef typed_identity_property_map<size_t> idx_t;
+    typedef d_ary_heap_indirect
+        <size_t, 4,
+         iterator_property_map<typename vector<size_t>::iterator, idx_t>,
+         iterator_property_map<typename vector<Type>::iterator, idx_t>,
+         std::greater<Type>> queue_t;
 
-struct dist_compare
-{
-    template <class Type1, class Type2>
-    bool operator()(const Type1& d1, const Type2& d2) const
+    void relax(queue_t& queue, size_t u, size_t skip, Type d)
     {
-        return d1 > d2; // we want trust paths with _maximum_ "distance"
+        if (u == skip || _done[u] || d <= _dist[u])
+            return;
+        if (_dist[u] == 0)
+            _touched.push_back(u);
+        _dist[u] = d;
+        queue.push_or_update(u);
     }
-};
 
-struct dist_combine
-{
-    template <class DistType, class WeightType>
-    DistType operator()(const DistType& d, const WeightType& w) const
+    void clear()
     {
-        return DistType(d * w);
+        for (auto v : _touched)
+        {
+            _dist[v] = 0;
+            _done[v] = false;
+            _heap_pos[v] = size_t(-1);
+        }
+        _touched.clear();
     }
+
+    const Graph& _g;
+    TrustMap _c;
+    vector<Type> _dist;
+    vector<uint8_t> _done;
+    vector<size_t> _heap_pos;
+    vector<size_t> _touched;
+    idx_t _idx;
 };
 
-// predicate to filter a single vertex from the graph
-struct filter_vertex_pred
+// The trust of all sources in the target "tgt", through its in-edge e from m,
+// is accumulated into the sums sum_w and avg. This requires a search from m
+// backwards, in the graph without the target.
+template <class Graph, class Search, class Edge, class TrustMap, class Type>
+void accumulate_trust_sources(const Graph& g, Search& search, size_t tgt,
+                              const Edge& e, TrustMap c, vector<Type>& sum_w,
+                              vector<Type>& avg)
 {
-    filter_vertex_pred() {}
-    filter_vertex_pred(size_t v): _v(v) {}
-    template <class Vertex>
-    bool operator()(const Vertex& v) const { return v != _v; }
-    size_t _v;
-};
+    auto m = source(e, g);
+    if (m == tgt)
+        return;
+
+    search.template run<true>(m, tgt, [](auto) { return false; });
+
+    Type c_e = get(c, e);
+    for (auto src : search.touched())
+    {
+        Type weight = search[src];
+        sum_w[src] += weight;
+        avg[src] += c_e * weight * weight;
+    }
+}
 
 struct get_trust_transitivity
 {
@@ -99,11 +163,11 @@ struct get_trust_transitivity
     void operator()(Graph& g, VertexIndex vertex_index, int64_t source,
                     int64_t target, TrustMap c, InferredTrustMap t) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typedef typename
             property_traits<InferredTrustMap>::value_type::value_type t_type;
+        typedef trust_search<Graph, TrustMap, t_type> search_t;
 
-        size_t N = (target == -1) ? num_vertices(g) : target + 1;
+        size_t N = num_vertices(g);
 
         parallel_vertex_loop
             (g,
@@ -112,117 +176,133 @@ struct get_trust_transitivity
                  t[v].resize((source == -1 && target == -1) ? N : 1);
              });
 
-        #pragma omp parallel for if (num_vertices(g) > OPENMP_MIN_THRESH)
-        for (size_t i = (target == -1) ? 0 : target; i < N; ++i)
+        if (source != -1)
         {
-            vertex_t tgt = vertex(i, g);
-            if (!is_valid_vertex(tgt, g))
-                continue;
-
-            // mark the sources
-            typedef unchecked_vector_property_map<uint8_t, VertexIndex>
-                source_map_t;
-            source_map_t source_map(vertex_index, num_vertices(g));
-
-            typename in_edge_iteratorS<Graph>::type e, e_end;
-            for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                 e != e_end; ++e)
-                source_map[boost::source(*e,g)] = true;
-
-            // filter vertex w out of the graph
-            typedef filtered_graph<Graph, boost::keep_all, filter_vertex_pred>
-                fg_t;
-            fg_t fg(g, boost::keep_all(), filter_vertex_pred(tgt));
-
-            // distance map (target weight map)
-            typedef unchecked_vector_property_map<t_type, VertexIndex>
-                dist_map_t;
-            dist_map_t dist_map(vertex_index, num_vertices(g));
-
-            // color map
-            typedef unchecked_vector_property_map<default_color_type, VertexIndex>
-                color_map_t;
-            color_map_t color_map(vertex_index, num_vertices(g));
-
-            if (source != -1)
-            {
-                vertex_t src = vertex(source, g);
+            // A single search from the source per target, which stops as soon
+            // as all the in-neighbours of the target are reached.
+            size_t src = vertex(source, g);
 
-                // compute the targets weights
-                try
+            auto get_trust = [&](search_t& search, vector<size_t>& mark,
+                                 size_t tgt)
                 {
-                    size_t k = in_degreeS()(tgt, g);
-                    source_counter<source_map_t,dist_map_t>
-                        visitor(source_map, dist_map, k);
-                    dijkstra_shortest_paths(fg, src, weight_map(c).
-                                            vertex_index_map(vertex_index).
-                                            color_map(color_map).
-                                            distance_map(dist_map).
-                                            distance_compare(dist_compare()).
-                                            distance_combine(dist_combine()).
-                                            distance_inf(t_type(0)).
-                                            distance_zero(t_type(1)).
-                                            visitor(visitor));
-                }
-                catch (const stop_search&) {}
+                    // mark the in-neighbours of the target
+                    size_t k = 0;
+                    for (auto e : in_edges_range(tgt, g))
+                    {
+                        auto m = boost::source(e, g);
+                        if (m != tgt && mark[m]++ == 0)
+                            ++k;
+                    }
 
-                // compute the target's trust
-                t_type sum_w = 0, avg = 0;
-                for (auto e : in_edges_range(tgt, g))
-                {
-                    t_type weight = dist_map[boost::source(e, g)];
-                    sum_w += weight;
-                    avg += c[e]*weight*weight;
-                }
-                if (sum_w > 0)
-                    t[tgt][0] = avg/sum_w;
-                if (tgt == src)
-                    t[tgt][0] = 1.0;
-            }
-            else
+                    if (k > 0 && src != tgt)
+                    {
+                        search.template run<false>
+                            (src, tgt,
+                             [&](auto v) { return mark[v] > 0 && --k == 0; });
+                    }
+
+                    t_type sum_w = 0, avg = 0;
+                    for (auto e : in_edges_range(tgt, g))
+                    {
+                        auto m = boost::source(e, g);
+                        if (m == tgt)
+                            continue;
+                        mark[m] = 0;
+                        if (src == tgt)
+                            continue;
+                        t_type weight = search[m];
+                        sum_w += weight;
+                        avg += get(c, e) * weight * weight;
+                    }
+                    if (sum_w > 0)
+                        t[tgt][0] = avg / sum_w;
+                    if (tgt == src)
+                        t[tgt][0] = 1.0;
+                };
+
+            if (target != -1)
             {
-                typedef typename
-                    mpl::if_<typename is_directed::apply<Graph>::type,
-                             reverse_graph<fg_t>,
-                             fg_t>::type rg_t;
-                rg_t rg(fg);
-                dist_map_t sum_w(vertex_index, num_vertices(g));
-                for (auto e : in_edges_range(tgt, g))
-                {
-                    // compute the weights to all sources
-                    dijkstra_shortest_paths
-                        (rg, boost::source(e, g), weight_map(c).
-                         vertex_index_map(vertex_index).
-                         color_map(color_map).
-                         distance_map(dist_map).
-                         distance_compare(dist_compare()).
-                         distance_combine(dist_combine()).
-                         distance_inf(t_type(0)).
-                         distance_zero(t_type(1)));
-
-                    parallel_vertex_loop
-                        (g,
-                         [&](auto src)
-                         {
-                             t_type weight = dist_map[src];
-                             sum_w[src] += weight;
-                             size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                             t[src][tidx] += c[e]*weight*weight;
-                         });
-                }
+                search_t search(g, c);
+                vector<size_t> mark(N);
+                get_trust(search, mark, vertex(target, g));
+                return;
+            }
 
-                parallel_vertex_loop
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                search_t search(g, c);
+                vector<size_t> mark(N);
+                parallel_vertex_loop_no_spawn
+                    (g, [&](auto tgt) { get_trust(search, mark, tgt); });
+            }
+        }
+        else if (target == -1)
+        {
+            // The complete trust matrix, with the targets distributed among
+            // the threads. The results are written directly into the column of
+            // the target, which is owned by a single thread.
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                search_t search(g, c);
+                vector<t_type> sum_w(N), avg(N);
+                parallel_vertex_loop_no_spawn
                     (g,
-                     [&](auto src)
+                     [&](auto tgt)
                      {
-                         size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                         if (sum_w[src] > 0)
-                             t[src][tidx] /= sum_w[src];
-                         if (src == tgt)
-                             t[src][tidx] = 1.0;
+                         size_t tidx = vertex_index[tgt];
+                         for (auto e : in_edges_range(tgt, g))
+                             accumulate_trust_sources(g, search, tgt, e, c,
+                                                      sum_w, avg);
+                         for (auto src : vertices_range(g))
+                         {
+                             if (sum_w[src] > 0)
+                                 t[src][tidx] = avg[src] / sum_w[src];
+                             if (src == tgt)
+                                 t[src][tidx] = 1.0;
+                             sum_w[src] = avg[src] = 0;
+                         }
                      });
             }
         }
+        else
+        {
+            // A single target, with its in-edges distributed among the
+            // threads, and the partial sums reduced at the end.
+            size_t tgt = vertex(target, g);
+            typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+            vector<edge_t> in_es;
+            for (auto e : in_edges_range(tgt, g))
+                in_es.push_back(e);
+            vector<t_type> sum_w(N), avg(N);
+
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                search_t search(g, c);
+                vector<t_type> lsum_w(N), lavg(N);
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < in_es.size(); ++i)
+                    accumulate_trust_sources(g, search, tgt, in_es[i], c,
+                                             lsum_w, lavg);
+
+                #pragma omp critical
+                for (size_t v = 0; v < N; ++v)
+                {
+                    sum_w[v] += lsum_w[v];
+                    avg[v] += lavg[v];
+                }
+            }
+
+            parallel_vertex_loop
+                (g,
+                 [&](auto src)
+                 {
+                     if (sum_w[src] > 0)
+                         t[src][0] = avg[src] / sum_w[src];
+                     if (src == tgt)
+                         t[src][0] = 1.0;
+                 });
+        }
     }
 };
 
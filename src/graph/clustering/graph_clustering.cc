@@ -34,7 +34,7 @@ using namespace graph_tool;
 boost::python::tuple global_clustering(GraphInterface& g)
 {
     double c, c_err;
-    run_action<graph_tool::detail::never_directed>()
+    run_frozen_action<graph_tool::detail::never_directed>()
         (g, std::bind(get_global_clustering(), std::placeholders::_1,
                       std::ref(c), std::ref(c_err)))();
     return boost::python::make_tuple(c, c_err);
@@ -42,7 +42,7 @@ boost::python::tuple global_clustering(GraphInterface& g)
 
 void local_clustering(GraphInterface& g, boost::any prop)
 {
-    run_action<>()
+    run_frozen_action<>()
         (g, std::bind(set_clustering_to_property(),
                       std::placeholders::_1,
                       std::placeholders::_2),
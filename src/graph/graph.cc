@@ -35,6 +35,10 @@ GraphInterface::GraphInterface()
      _edge_index(get(edge_index_t(), *_mg)),
      _reversed(false),
      _directed(true),
+     _fg(std::make_shared<frozen_graph_t>()),
+     _cfg(std::make_shared<compact_frozen_graph_t>()),
+     _frozen(false),
+     _frozen_compact(true),
      _graph_index(0),
      _vertex_filter_map(_vertex_index),
      _vertex_filter_invert(false),
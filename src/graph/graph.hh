@@ -26,6 +26,7 @@
 #include <deque>
 
 #include "graph_adjacency.hh"
+#include "graph_csr.hh"
 
 #include <boost/graph/graph_traits.hpp>
 
@@ -85,6 +86,8 @@ public:
     bool get_reversed() {return _reversed;}
     void set_keep_epos(bool keep) {_mg->set_keep_epos(keep);}
     bool get_keep_epos() {return _mg->get_keep_epos();}
+    void set_frozen(bool frozen, bool compact);
+    bool get_frozen() {return _frozen;}
 
 
     // graph filtering
@@ -94,7 +97,7 @@ public:
     bool is_edge_filter_active() const;
 
     // graph modification
-    void re_index_edges();
+    boost::python::object re_index_edges();
     void purge_vertices(boost::any old_index); // removes filtered vertices
     void purge_edges();    // removes filtered edges
     void clear();
@@ -102,6 +105,8 @@ public:
     void shift_vertex_property(boost::any map, boost::python::object oindex) const;
     void move_vertex_property(boost::any map, boost::python::object oindex) const;
     void re_index_vertex_property(boost::any map, boost::any old_index) const;
+    void re_index_edge_property(boost::any map,
+                                boost::python::object old_index) const;
     void copy_vertex_property(const GraphInterface& src, boost::any prop_src,
                               boost::any prop_tgt);
     void copy_edge_property(const GraphInterface& src, boost::any prop_src,
@@ -119,7 +124,8 @@ public:
 
     // I/O
     void write_to_file(std::string s, boost::python::object pf, std::string format,
-                       boost::python::list properties);
+                       boost::python::list properties, bool aligned,
+                       bool block_compress);
     boost::python::tuple read_from_file(std::string s, boost::python::object pf,
                                         std::string format,
                                         boost::python::list ignore_vp,
@@ -138,6 +144,12 @@ public:
     typedef boost::property_map<multigraph_t, boost::edge_index_t>::type edge_index_map_t;
     typedef ConstantPropertyMap<size_t,boost::graph_property_tag> graph_index_map_t;
 
+    // immutable CSR snapshot of the main graph, used for read-only algorithms,
+    // with either 64 or 32-bit storage (the latter for graphs with less than
+    // 2^32 vertices and edges)
+    typedef boost::csr_adj_list<size_t> frozen_graph_t;
+    typedef boost::csr_adj_list<size_t, uint32_t> compact_frozen_graph_t;
+
     // internal access
 
     multigraph_t&      get_graph() {return *_mg;}
@@ -152,6 +164,11 @@ public:
     boost::any get_graph_view() const;
     std::vector<boost::any>& get_graph_views() {return _graph_views;}
 
+    // Gets the encapsulated view of the frozen CSR snapshot, which is rebuilt
+    // if the graph was modified in the meantime. If the graph is not frozen,
+    // or filtering is active, an empty value is returned.
+    boost::any get_frozen_graph_view() const;
+
 private:
 
     // Generic graph_action functor. See graph_filtering.hh for details.
@@ -174,6 +191,13 @@ private:
     bool _reversed;
     bool _directed;
 
+    // CSR snapshots of the main graph, if frozen; only one of them is
+    // non-empty at any given time
+    std::shared_ptr<frozen_graph_t> _fg;
+    std::shared_ptr<compact_frozen_graph_t> _cfg;
+    bool _frozen;
+    bool _frozen_compact;
+
     // graph index map
     graph_index_map_t _graph_index;
 
@@ -218,6 +242,34 @@ struct gprop_map_t
         type;
 };
 
+// Releases the Python GIL for the lifetime of the object, so that other Python
+// threads can run while the algorithm executes. It must not be used when Python
+// objects are accessed.
+
+class GILRelease
+{
+public:
+    GILRelease(bool release = true)
+    {
+        if (release && PyGILState_Check())
+            _state = PyEval_SaveThread();
+    }
+
+    ~GILRelease()
+    {
+        restore();
+    }
+
+    void restore()
+    {
+        if (_state != nullptr)
+            PyEval_RestoreThread(_state);
+        _state = nullptr;
+    }
+
+private:
+    PyThreadState* _state = nullptr;
+};
 
 } //namespace graph_tool
 
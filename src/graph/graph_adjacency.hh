@@ -20,11 +20,19 @@
 
 #include <vector>
 #include <deque>
+#include <array>
+#include <algorithm>
 #include <utility>
 #include <numeric>
 #include <iostream>
 #include <tuple>
 #include <functional>
+#include <atomic>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 #include <boost/iterator.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/range/irange.hpp>
@@ -112,6 +120,9 @@ void remove_vertex(Vertex v, adj_list<Vertex>& g);
 template <class Vertex>
 void remove_vertex_fast(Vertex v, adj_list<Vertex>& g);
 
+template <class Vertex, class Pred>
+void remove_vertices(Pred&& deleted, adj_list<Vertex>& g);
+
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
 add_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
@@ -123,6 +134,13 @@ template <class Vertex>
 void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
                  adj_list<Vertex>& g);
 
+template <class Vertex, class EdgeRange>
+size_t remove_edges(EdgeRange&& es, adj_list<Vertex>& g);
+
+template <class Vertex, class Source, class Target>
+std::vector<Vertex> add_edges(size_t M, Source&& get_source,
+                              Target&& get_target, adj_list<Vertex>& g);
+
 // ========================================================================
 // adj_list<Vertex>
 // ========================================================================
@@ -170,6 +188,34 @@ struct adj_edge_descriptor
     Vertex s, t, idx;
     bool inv;
 };
+
+// Identifier which is unique to each adj_list instance during the lifetime of
+// the program. A new one is drawn whenever the graph is copied or assigned to,
+// so that, together with the modification counter, it identifies the state of
+// the graph even if it is replaced by another one (whose counter could
+// otherwise reach the same value).
+class adj_list_uid
+{
+public:
+    adj_list_uid() : _uid(next()) {}
+    adj_list_uid(const adj_list_uid&) : _uid(next()) {}
+    adj_list_uid& operator=(const adj_list_uid&)
+    {
+        _uid = next();
+        return *this;
+    }
+
+    operator size_t() const { return _uid; }
+
+private:
+    static size_t next()
+    {
+        static std::atomic<size_t> count(0);
+        return count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    size_t _uid;
+};
 } // namespace detail
 
 template <class Vertex = size_t>
@@ -185,7 +231,8 @@ public:
     typedef std::vector<edge_list_t> vertex_list_t;
     typedef typename integer_range<Vertex>::iterator vertex_iterator;
 
-    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false) {}
+    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(true),
+                _version(0) {}
 
     struct get_vertex
     {
@@ -313,25 +360,150 @@ public:
         typename edge_list_t::const_iterator _ei;
     };
 
-    void reindex_edges()
+    // reset the edge indexes to the range [0, E - 1], following the order of
+    // the out-edge lists; if given, old_index[i] will contain the previous
+    // index of the edge with the new index i
+    void reindex_edges(std::vector<size_t>* old_index = nullptr)
     {
+        _version++;
         _free_indexes.clear();
-        _edge_index_range = 0;
-        _in_edges.clear();
-        _in_edges.resize(_out_edges.size());
-        for (size_t i = 0; i < _out_edges.size(); ++i)
+
+        size_t N = _out_edges.size();
+        std::vector<size_t> pos(N + 1, 0);
+        for (size_t v = 0; v < N; ++v)
+            pos[v + 1] = pos[v] + _out_edges[v].size();
+
+        std::vector<size_t> new_index(_edge_index_range);
+        if (old_index != nullptr)
+            old_index->resize(pos[N]);
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
         {
-            auto& oes = _out_edges[i];
+            auto& oes = _out_edges[v];
             for (size_t j = 0; j < oes.size(); ++j)
             {
                 auto& oe = oes[j];
-                Vertex v = oe.first;
-                oe.second = _edge_index_range;
-                _in_edges[v].emplace_back(i, _edge_index_range);
-                _edge_index_range++;
+                size_t idx = pos[v] + j;
+                new_index[oe.second] = idx;
+                if (old_index != nullptr)
+                    (*old_index)[idx] = oe.second;
+                oe.second = idx;
             }
         }
 
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            for (auto& ie : _in_edges[v])
+                ie.second = new_index[ie.second];
+        }
+
+        _edge_index_range = pos[N];
+
+        if (_keep_epos)
+            rebuild_epos();
+    }
+
+    // replace the whole graph by N vertices and the edges given in compressed
+    // sparse row form: the out-neighbours of vertex v are target(i) for i in
+    // [pos(v), pos(v + 1)), and the edges receive the indexes 0, ...,
+    // pos(N) - 1 in this order. The input is assumed to be consistent.
+    template <class Pos, class Target>
+    void assign_csr(size_t N, Pos&& pos, Target&& target)
+    {
+        _version++;
+        _free_indexes.clear();
+        _out_edges.clear();
+        _in_edges.clear();
+        _out_edges.resize(N);
+        _in_edges.resize(N);
+        _n_edges = _edge_index_range = (N > 0) ? pos(N) : 0;
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto& oes = _out_edges[v];
+            size_t begin = pos(v);
+            size_t end = pos(v + 1);
+            oes.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i)
+                oes.emplace_back(target(i), i);
+        }
+
+        // the in-edges are scattered by contiguous blocks of sources with
+        // about the same number of edges, one per thread. Each block counts
+        // its in-degrees, and a prefix sum over the blocks gives the position
+        // of its edges in every in-edge list, which therefore have the same
+        // order as with a serial scatter. The counts take O(N) memory per
+        // block, so there are at most E / N blocks. A single block simply
+        // appends to the reserved lists.
+        size_t nblocks = 1;
+#ifdef USING_OPENMP
+        if (N > 100)
+            nblocks = std::min(size_t(omp_get_max_threads()),
+                               std::max(_n_edges / N, size_t(1)));
+#endif
+        std::vector<size_t> bpos(nblocks + 1, N);
+        for (size_t j = 0; j < nblocks; ++j)
+        {
+            // first source whose edges start at or after E * j / nblocks
+            size_t e = (_n_edges * j) / nblocks;
+            size_t lo = (j > 0) ? bpos[j - 1] : 0, hi = N;
+            while (lo < hi)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                if (pos(mid) < e)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            bpos[j] = lo;
+        }
+
+        std::vector<std::vector<size_t>> counts(nblocks);
+
+        #pragma omp parallel for schedule(static, 1) if (nblocks > 1)
+        for (size_t j = 0; j < nblocks; ++j)
+        {
+            auto& c = counts[j];
+            c.resize(N);
+            for (size_t v = bpos[j]; v < bpos[j + 1]; ++v)
+                for (auto& oe : _out_edges[v])
+                    c[oe.first]++;
+        }
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t u = 0; u < N; ++u)
+        {
+            size_t d = 0;
+            for (auto& c : counts)
+            {
+                size_t k = c[u];
+                c[u] = d;
+                d += k;
+            }
+            if (nblocks > 1)
+                _in_edges[u].resize(d);
+            else
+                _in_edges[u].reserve(d);
+        }
+
+        #pragma omp parallel for schedule(static, 1) if (nblocks > 1)
+        for (size_t j = 0; j < nblocks; ++j)
+        {
+            auto& c = counts[j];
+            for (size_t v = bpos[j]; v < bpos[j + 1]; ++v)
+                for (auto& oe : _out_edges[v])
+                {
+                    auto& ies = _in_edges[oe.first];
+                    if (nblocks > 1)
+                        ies[c[oe.first]++] = {vertex_t(v), oe.second};
+                    else
+                        ies.emplace_back(v, oe.second);
+                }
+        }
+
         if (_keep_epos)
             rebuild_epos();
     }
@@ -357,10 +529,39 @@ public:
 
     size_t get_edge_index_range() const { return _edge_index_range; }
 
+    // returns true if the edge descriptor corresponds to an existing edge;
+    // this is O(1) if the edge positions are kept, or O(k_s) otherwise
+    bool is_valid_edge(const edge_descriptor& e) const
+    {
+        if (e.s >= _out_edges.size() || e.t >= _out_edges.size())
+            return false;
+        auto& oes = _out_edges[e.s];
+        if (_keep_epos)
+        {
+            if (e.idx >= _epos.size())
+                return false;
+            size_t pos = _epos[e.idx].first;
+            return (pos < oes.size() && oes[pos].first == e.t &&
+                    oes[pos].second == e.idx);
+        }
+        return std::find(oes.begin(), oes.end(),
+                         std::make_pair(e.t, e.idx)) != oes.end();
+    }
+
+    // modification counter, incremented whenever the topology or the edge
+    // indexes change; used to detect stale snapshots of the graph
+    size_t get_version() const { return _version; }
+
+    // unique identifier of this instance, which changes whenever the graph is
+    // replaced via assignment; snapshots must compare it together with
+    // get_version(), since the counter restarts for a new graph
+    size_t get_uid() const { return _uid; }
+
     static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
 
     void shrink_to_fit()
     {
+        _version++;
         _in_edges.shrink_to_fit();
         _out_edges.shrink_to_fit();
         std::for_each(_in_edges.begin(), _in_edges.end(),
@@ -395,13 +596,22 @@ private:
                                       // for new edges to avoid very large
                                       // indexes, and unnecessary property map
                                       // memory use
+    // positions of each edge in the out- and in-edge lists of its source and
+    // target, respectively, indexed by the edge index. This is kept up to date
+    // by all manipulation functions (unless disabled via set_keep_epos()), so
+    // that edges can be removed in O(1) time by swapping with the last entry
+    // of the lists.
     bool _keep_epos;
-    std::vector<std::pair<int32_t, int32_t>> _epos;
+    std::vector<std::pair<uint32_t, uint32_t>> _epos;
+    size_t _version;
+    detail::adj_list_uid _uid;
 
     void rebuild_epos()
     {
         _epos.resize(_edge_index_range);
-        for (size_t i = 0; i < _out_edges.size(); ++i)
+        size_t N = _out_edges.size();
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t i = 0; i < N; ++i)
         {
             auto& oes = _out_edges[i];
             for (size_t j = 0; j < oes.size(); ++j)
@@ -461,12 +671,22 @@ private:
 
     friend void remove_vertex_fast<>(Vertex v, adj_list<Vertex>& g);
 
+    template <class V, class Pred>
+    friend void remove_vertices(Pred&& deleted, adj_list<V>& g);
+
     friend std::pair<edge_descriptor, bool>
     add_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
     friend void remove_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
     friend void remove_edge<>(const edge_descriptor& e, adj_list<Vertex>& g);
+
+    template <class V, class EdgeRange>
+    friend size_t remove_edges(EdgeRange&& es, adj_list<V>& g);
+
+    template <class V, class Source, class Target>
+    friend std::vector<V> add_edges(size_t M, Source&& get_source,
+                                    Target&& get_target, adj_list<V>& g);
 };
 
 //========================================================================
@@ -698,6 +918,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 Vertex add_vertex(adj_list<Vertex>& g)
 {
+    g._version++;
     g._out_edges.emplace_back();
     g._in_edges.emplace_back();
     return g._out_edges.size() - 1;
@@ -706,6 +927,7 @@ Vertex add_vertex(adj_list<Vertex>& g)
 template <class Vertex, class Pred>
 void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
 {
+    g._version++;
     if (!g._keep_epos)
     {
         auto remove_es = [&] (auto& out_edges, auto& in_edges,
@@ -753,7 +975,8 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
     else
     {
         auto remove_es = [&] (auto& out_edges, auto& in_edges,
-                              auto&& get_pos, auto&& mk_out_edge)
+                              auto&& get_pos, auto&& get_opos,
+                              auto&& mk_out_edge)
         {
             auto& oes = out_edges[v];
             for (const auto& ei : oes)
@@ -782,12 +1005,21 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
                                });
             oes.erase(iter, oes.end());
             g._n_edges -= noes - oes.size();
+
+            // the remaining edges may have been moved
+            if (oes.size() < noes)
+            {
+                for (size_t j = 0; j < oes.size(); ++j)
+                    get_opos(oes[j].second) = j;
+            }
         };
         remove_es(g._out_edges, g._in_edges,
                   [&](size_t idx) -> auto& {return g._epos[idx].second;},
+                  [&](size_t idx) -> auto& {return g._epos[idx].first;},
                   typename adj_list<Vertex>::make_out_edge());
         remove_es(g._in_edges, g._out_edges,
                   [&](size_t idx) -> auto& {return g._epos[idx].first;},
+                  [&](size_t idx) -> auto& {return g._epos[idx].second;},
                   typename adj_list<Vertex>::make_in_edge());
     }
 }
@@ -830,6 +1062,7 @@ template <class Vertex>
 void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
 {
     Vertex back = g._out_edges.size() - 1;
+    g._version++;
 
     if (v < back)
     {
@@ -882,6 +1115,76 @@ void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
     }
 }
 
+// Remove all vertices for which deleted(v) is true, together with their edges,
+// in a single O(V + E) pass. The remaining vertices keep their relative order,
+// and are reindexed contiguously.
+template <class Vertex, class Pred>
+void remove_vertices(Pred&& deleted, adj_list<Vertex>& g)
+{
+    size_t N = g._out_edges.size();
+    std::vector<Vertex> new_index(N);
+    size_t n = 0;
+    for (size_t v = 0; v < N; ++v)
+        new_index[v] = deleted(Vertex(v)) ? g.null_vertex() : n++;
+    if (n == N)
+        return;
+
+    g._version++;
+
+    // each removed edge is accounted for once, either in the out-edge list of
+    // its (deleted) source, or in the in-edge list of its (deleted) target
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (new_index[v] != g.null_vertex())
+            continue;
+        for (auto& oe : g._out_edges[v])
+            g._free_indexes.push_back(oe.second);
+        g._n_edges -= g._out_edges[v].size();
+        for (auto& ie : g._in_edges[v])
+        {
+            if (new_index[ie.first] == g.null_vertex())
+                continue;
+            g._free_indexes.push_back(ie.second);
+            g._n_edges--;
+        }
+    }
+
+    auto relabel = [&](auto& es)
+        {
+            auto iter = std::remove_if(es.begin(), es.end(),
+                                       [&](const auto& e)
+                                       {
+                                           return (new_index[e.first] ==
+                                                   g.null_vertex());
+                                       });
+            es.erase(iter, es.end());
+            for (auto& e : es)
+                e.first = new_index[e.first];
+        };
+
+    #pragma omp parallel for schedule(runtime) if (N > 100)
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (new_index[v] == g.null_vertex())
+            continue;
+        relabel(g._out_edges[v]);
+        relabel(g._in_edges[v]);
+    }
+
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (new_index[v] == g.null_vertex() || new_index[v] == v)
+            continue;
+        g._out_edges[new_index[v]].swap(g._out_edges[v]);
+        g._in_edges[new_index[v]].swap(g._in_edges[v]);
+    }
+    g._out_edges.resize(n);
+    g._in_edges.resize(n);
+
+    if (g._keep_epos)
+        g.rebuild_epos();
+}
+
 template <class Vertex>
 typename std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
 add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
@@ -900,6 +1203,7 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     auto& oes = g._out_edges[s];
     auto& ies = g._in_edges[t];
     oes.emplace_back(t, idx);
+    g._version++;
     ies.emplace_back(s, idx);
     g._n_edges++;
 
@@ -916,6 +1220,75 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     return {edge_descriptor(s, t, idx, false), true};
 }
 
+// Insert a batch of M edges, with endpoints get_source(i) and get_target(i)
+// (which must be existing vertices), and return their indexes. The new edges
+// are grouped by vertex, so that each adjacency list is extended only once,
+// and the lists of different vertices are modified in parallel.
+template <class Vertex, class Source, class Target>
+std::vector<Vertex> add_edges(size_t M, Source&& get_source,
+                              Target&& get_target, adj_list<Vertex>& g)
+{
+    std::vector<Vertex> idxs(M);
+    if (M == 0)
+        return idxs;
+
+    for (size_t i = 0; i < M; ++i)
+    {
+        if (g._free_indexes.empty())
+        {
+            idxs[i] = g._edge_index_range++;
+        }
+        else
+        {
+            idxs[i] = g._free_indexes.front();
+            g._free_indexes.pop_front();
+        }
+    }
+    g._n_edges += M;
+    g._version++;
+
+    if (g._keep_epos && g._edge_index_range > g._epos.size())
+        g._epos.resize(g._edge_index_range);
+
+    auto append = [&](auto& lists, auto&& key, auto&& other, auto&& get_pos)
+        {
+            std::vector<size_t> order(M);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t i, size_t j)
+                             { return key(i) < key(j); });
+
+            std::vector<size_t> groups;
+            for (size_t i = 0; i < M; ++i)
+            {
+                if (i == 0 || key(order[i]) != key(order[i - 1]))
+                    groups.push_back(i);
+            }
+            groups.push_back(M);
+
+            size_t NG = groups.size() - 1;
+            #pragma omp parallel for schedule(runtime) if (NG > 100)
+            for (size_t j = 0; j < NG; ++j)
+            {
+                auto& es = lists[key(order[groups[j]])];
+                es.reserve(es.size() + groups[j + 1] - groups[j]);
+                for (size_t k = groups[j]; k < groups[j + 1]; ++k)
+                {
+                    size_t i = order[k];
+                    if (g._keep_epos)
+                        get_pos(idxs[i]) = es.size();
+                    es.emplace_back(other(i), idxs[i]);
+                }
+            }
+        };
+
+    append(g._out_edges, get_source, get_target,
+           [&](size_t idx) -> auto& { return g._epos[idx].first; });
+    append(g._in_edges, get_target, get_source,
+           [&](size_t idx) -> auto& { return g._epos[idx].second; });
+    return idxs;
+}
+
 template <class Vertex>
 void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
 {
@@ -930,6 +1303,7 @@ void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
             g._free_indexes.push_back(iter_o->second);
             oes.erase(iter_o);
             g._n_edges--;
+            g._version++;
         }
 
         auto& ies = g._in_edges[t];
@@ -977,7 +1351,7 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
     }
     else // O(1)
     {
-        if (idx < g._epos.size())
+        if (g.is_valid_edge(e))
         {
             auto remove_e = [&] (auto& elist, const auto& get_pos)
             {
@@ -999,7 +1373,106 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
     {
         g._free_indexes.push_back(idx);
         g._n_edges--;
+        g._version++;
+    }
+}
+
+// Remove a batch of edges, given as a range of edge descriptors, and return
+// the number of edges actually removed (invalid descriptors are ignored). If
+// the edge positions are kept, each removal is O(1). Otherwise, the removals
+// are grouped by vertex, so that each affected edge list is traversed only
+// once, and the lists of different vertices are modified in parallel. In this
+// case the complexity is O(M log M + sum_v k_v), where M is the number of
+// removed edges, and the sum runs over the affected vertices.
+template <class Vertex, class EdgeRange>
+size_t remove_edges(EdgeRange&& es, adj_list<Vertex>& g)
+{
+    if (g._keep_epos)
+    {
+        size_t n = 0;
+        for (const auto& e : es)
+        {
+            if (!g.is_valid_edge(e))
+                continue;
+            remove_edge(e, g);
+            ++n;
+        }
+        return n;
+    }
+
+    // (vertex, edge index, other endpoint)
+    typedef std::array<Vertex, 3> item_t;
+    std::vector<item_t> items;
+    for (const auto& e : es)
+        items.push_back({e.s, e.idx, e.t});
+
+    auto group_sort = [](auto& items)
+        {
+            std::sort(items.begin(), items.end());
+            items.erase(std::unique(items.begin(), items.end()), items.end());
+            std::vector<size_t> groups;
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                if (i == 0 || items[i][0] != items[i - 1][0])
+                    groups.push_back(i);
+            }
+            groups.push_back(items.size());
+            return groups;
+        };
+
+    // removes the items [begin, end) from the edge list of a single vertex
+    auto remove_es = [&](auto& elist, size_t begin, size_t end,
+                         std::vector<uint8_t>* found)
+        {
+            auto ibegin = items.begin() + begin;
+            auto iend = items.begin() + end;
+            auto iter =
+                std::remove_if(elist.begin(), elist.end(),
+                               [&](const auto& ei)
+                               {
+                                   item_t key = {items[begin][0], ei.second,
+                                                 ei.first};
+                                   auto pos = std::lower_bound(ibegin, iend,
+                                                               key);
+                                   if (pos == iend || *pos != key)
+                                       return false;
+                                   if (found != nullptr)
+                                       (*found)[pos - items.begin()] = true;
+                                   return true;
+                               });
+            elist.erase(iter, elist.end());
+        };
+
+    // out-edge lists
+    auto groups = group_sort(items);
+    std::vector<uint8_t> found(items.size(), false);
+    size_t NG = groups.size() - 1;
+    #pragma omp parallel for schedule(runtime) if (NG > 100)
+    for (size_t j = 0; j < NG; ++j)
+        remove_es(g._out_edges[items[groups[j]][0]], groups[j], groups[j + 1],
+                  &found);
+
+    // in-edge lists, only for the edges that were found
+    std::vector<item_t> ritems;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (found[i])
+            ritems.push_back({items[i][2], items[i][1], items[i][0]});
     }
+    items.swap(ritems);
+    groups = group_sort(items);
+    NG = groups.size() - 1;
+    #pragma omp parallel for schedule(runtime) if (NG > 100)
+    for (size_t j = 0; j < NG; ++j)
+        remove_es(g._in_edges[items[groups[j]][0]], groups[j], groups[j + 1],
+                  nullptr);
+
+    for (auto& item : items)
+        g._free_indexes.push_back(item[1]);
+    g._n_edges -= items.size();
+    if (!items.empty())
+        g._version++;
+    return items.size();
 }
 
 
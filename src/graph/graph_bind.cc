@@ -404,6 +404,27 @@ size_t get_ptr(std::shared_ptr<GraphInterface::multigraph_t>& p)
 };
 
 
+// the state of the random number generator is pickled in the standard textual
+// representation, so that it can be checkpointed and restored exactly
+struct rng_pickle_suite : boost::python::pickle_suite
+{
+    static boost::python::tuple getstate(const rng_t& rng)
+    {
+        std::ostringstream s;
+        s << rng;
+        return boost::python::make_tuple(s.str());
+    }
+
+    static void setstate(rng_t& rng, boost::python::tuple state)
+    {
+        string buf = boost::python::extract<string>(state[0]);
+        std::istringstream s(buf);
+        s >> rng;
+        if (s.fail())
+            throw ValueException("invalid random number generator state");
+    }
+};
+
 // numpy array interface weirdness
 void* do_import_array()
 {
@@ -449,7 +470,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
     export_python_interface();
 
     // random numbers
-    class_<rng_t>("rng_t");
+    class_<rng_t>("rng_t")
+        .def_pickle(rng_pickle_suite());
     def("get_rng", get_rng);
 
     register_exception_translator<GraphException>
@@ -488,6 +510,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("get_reversed", &GraphInterface::get_reversed)
         .def("set_keep_epos", &GraphInterface::set_keep_epos)
         .def("get_keep_epos", &GraphInterface::get_keep_epos)
+        .def("set_frozen", &GraphInterface::set_frozen)
+        .def("get_frozen", &GraphInterface::get_frozen)
         .def("set_vertex_filter_property",
              &GraphInterface::set_vertex_filter_property)
         .def("is_vertex_filter_active", &GraphInterface::is_vertex_filter_active)
@@ -499,6 +523,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("shift_vertex_property",  &GraphInterface::shift_vertex_property)
         .def("move_vertex_property",  &GraphInterface::move_vertex_property)
         .def("re_index_vertex_property",  &GraphInterface::re_index_vertex_property)
+        .def("re_index_edge_property",  &GraphInterface::re_index_edge_property)
         .def("write_to_file", &GraphInterface::write_to_file)
         .def("read_from_file",&GraphInterface::read_from_file)
         .def("degree_map", &GraphInterface::degree_map)
@@ -238,6 +238,10 @@ GraphInterface::GraphInterface(const GraphInterface& gi, bool keep_ref,
      _edge_index(get(edge_index_t(), *_mg)),
      _reversed(gi._reversed),
      _directed(gi._directed),
+     _fg(keep_ref ? gi._fg : std::make_shared<frozen_graph_t>()),
+     _cfg(keep_ref ? gi._cfg : std::make_shared<compact_frozen_graph_t>()),
+     _frozen(keep_ref && gi._frozen),
+     _frozen_compact(gi._frozen_compact),
      _vertex_filter_map(_vertex_index),
      _vertex_filter_invert(false),
      _vertex_filter_active(false),
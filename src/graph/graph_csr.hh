@@ -0,0 +1,566 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CSR_HH
+#define GRAPH_CSR_HH
+
+#include <vector>
+#include <utility>
+#include <numeric>
+
+#include "graph_adjacency.hh"
+
+namespace boost
+{
+
+// ========================================================================
+// csr_adj_list<Vertex, Index>
+// ========================================================================
+//
+// csr_adj_list is an immutable, compressed sparse row (CSR) snapshot of an
+// adj_list. The in- and out-edge lists of all vertices are packed contiguously
+// in two arrays of (neighbour, edge index) pairs, with an additional array of
+// offsets per vertex. This avoids one heap indirection per vertex during
+// traversal, which makes a significant difference for memory-bound algorithms
+// on large graphs.
+//
+// The edge descriptors and edge indexes are the same as in the original
+// adj_list, so that the same vertex and edge property maps can be used with
+// both. The graph cannot be modified; it should be rebuilt from the original
+// graph whenever it changes (see adj_list::get_version() and
+// adj_list::get_uid()).
+//
+// The integer type used for storage is given by the Index template parameter,
+// which can be smaller than Vertex. With Index = uint32_t, which is enough for
+// graphs with less than 2^32 vertices and edges, the memory requirement is half
+// of that with 64-bit integers, while the descriptors are kept unchanged.
+
+template <class Vertex = size_t, class Index = Vertex>
+class csr_adj_list
+{
+public:
+    struct graph_tag {};
+    typedef Vertex vertex_t;
+    typedef Index index_t;
+
+    typedef detail::adj_edge_descriptor<Vertex> edge_descriptor;
+
+    typedef std::pair<index_t, index_t> edge_entry_t; // (neighbour, index)
+    typedef std::vector<edge_entry_t> edge_list_t;
+    typedef std::vector<index_t> pos_list_t;
+    typedef typename integer_range<Vertex>::iterator vertex_iterator;
+
+    csr_adj_list()
+        : _out_pos(1, 0), _in_pos(1, 0), _edge_index_range(0),
+          _version(std::numeric_limits<size_t>::max()),
+          _uid(std::numeric_limits<size_t>::max()) {}
+
+    explicit csr_adj_list(const adj_list<Vertex>& g)
+        : csr_adj_list()
+    {
+        build(g);
+    }
+
+    // (Re-)builds the snapshot from the given graph, in parallel. The object
+    // itself is kept, so that any references to it remain valid.
+    void build(const adj_list<Vertex>& g)
+    {
+        size_t N = num_vertices(g);
+
+        _out_pos.resize(N + 1);
+        _in_pos.resize(N + 1);
+        _out_pos[0] = _in_pos[0] = 0;
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            _out_pos[v + 1] = out_degree(Vertex(v), g);
+            _in_pos[v + 1] = in_degree(Vertex(v), g);
+        }
+
+        std::partial_sum(_out_pos.begin(), _out_pos.end(), _out_pos.begin());
+        std::partial_sum(_in_pos.begin(), _in_pos.end(), _in_pos.begin());
+
+        _out_edges.clear();
+        _in_edges.clear();
+        _out_edges.resize(_out_pos[N]);
+        _in_edges.resize(_in_pos[N]);
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            size_t pos = _out_pos[v];
+            auto oes = out_edges(Vertex(v), g);
+            for (auto ei = oes.first; ei != oes.second; ++ei)
+                _out_edges[pos++] = edge_entry_t(ei->t, ei->idx);
+
+            pos = _in_pos[v];
+            auto ies = in_edges(Vertex(v), g);
+            for (auto ei = ies.first; ei != ies.second; ++ei)
+                _in_edges[pos++] = edge_entry_t(ei->s, ei->idx);
+        }
+
+        _edge_index_range = g.get_edge_index_range();
+        _version = g.get_version();
+        _uid = g.get_uid();
+    }
+
+    // returns true if the snapshot reflects the current state of the graph
+    bool is_current(const adj_list<Vertex>& g) const
+    {
+        return _version == g.get_version() && _uid == g.get_uid();
+    }
+
+    // the modification counter and identifier of the graph at the time the
+    // snapshot was built (see adj_list::get_version() and adj_list::get_uid())
+    size_t get_version() const { return _version; }
+    size_t get_uid() const { return _uid; }
+
+    // returns true if the given graph can be represented with the Index type
+    static bool fits(const adj_list<Vertex>& g)
+    {
+        size_t max_idx = std::numeric_limits<index_t>::max();
+        return (num_vertices(g) < max_idx && num_edges(g) < max_idx &&
+                g.get_edge_index_range() < max_idx);
+    }
+
+    size_t get_edge_index_range() const { return _edge_index_range; }
+
+    static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
+
+    struct get_vertex
+    {
+        get_vertex() {}
+        typedef Vertex result_type;
+        __attribute__((always_inline))
+        Vertex operator()(const edge_entry_t& v) const
+        { return v.first; }
+    };
+
+    typedef transform_random_access_iterator<get_vertex, const edge_entry_t*>
+        adjacency_iterator;
+
+    typedef adjacency_iterator in_adjacency_iterator;
+
+    template <class Deference>
+    struct base_edge_iterator:
+        public boost::iterator_facade<base_edge_iterator<Deference>,
+                                      edge_descriptor,
+                                      std::random_access_iterator_tag,
+                                      edge_descriptor>
+    {
+        base_edge_iterator() {}
+        base_edge_iterator(vertex_t v, const edge_entry_t* iter)
+            : _v(v), _iter(iter) {}
+
+    private:
+        friend class boost::iterator_core_access;
+        void increment() { ++_iter; }
+        void decrement() { --_iter; }
+        template <class Distance>
+        void advance(Distance n) { _iter += n; }
+        auto distance_to(base_edge_iterator const& other) const
+        {
+            return other._iter - _iter;
+        }
+
+        bool equal(base_edge_iterator const& other) const
+        {
+            return _iter == other._iter;
+        }
+
+        edge_descriptor dereference() const
+        {
+            return Deference::def(_v, *_iter);
+        }
+
+        vertex_t _v;
+        const edge_entry_t* _iter;
+    };
+
+    struct make_out_edge
+    {
+        static edge_descriptor def(vertex_t src, const edge_entry_t& v)
+        { return edge_descriptor(src, v.first, v.second, false); }
+    };
+
+    struct make_in_edge
+    {
+        static edge_descriptor def(vertex_t tgt, const edge_entry_t& v)
+        { return edge_descriptor(v.first, tgt, v.second, false); }
+    };
+
+    typedef base_edge_iterator<make_out_edge> out_edge_iterator;
+    typedef base_edge_iterator<make_in_edge> in_edge_iterator;
+
+    // Since the out-edges are stored contiguously, the edge iterator simply
+    // walks through the packed array, keeping track of the current source
+    // vertex.
+    class edge_iterator:
+        public boost::iterator_facade<edge_iterator,
+                                      edge_descriptor,
+                                      boost::forward_traversal_tag,
+                                      edge_descriptor>
+    {
+    public:
+        edge_iterator() {}
+        explicit edge_iterator(const csr_adj_list* g, vertex_t v, size_t pos)
+            : _g(g), _v(v), _pos(pos)
+        {
+            skip();
+        }
+
+    private:
+        friend class boost::iterator_core_access;
+
+        void skip()
+        {
+            //skip empty vertices
+            size_t N = _g->_out_pos.size() - 1;
+            while (_v < N && _pos == _g->_out_pos[_v + 1])
+                ++_v;
+        }
+
+        void increment()
+        {
+            ++_pos;
+            skip();
+        }
+
+        bool equal(edge_iterator const& other) const
+        {
+            return _pos == other._pos;
+        }
+
+        edge_descriptor dereference() const
+        {
+            const auto& e = _g->_out_edges[_pos];
+            return edge_descriptor(_v, e.first, e.second, false);
+        }
+
+        const csr_adj_list* _g;
+        vertex_t _v;
+        size_t _pos;
+    };
+
+private:
+    pos_list_t _out_pos;
+    pos_list_t _in_pos;
+    edge_list_t _out_edges;
+    edge_list_t _in_edges;
+    size_t _edge_index_range;
+    size_t _version;
+    size_t _uid;
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::edge_iterator,
+                     typename csr_adj_list<V, I>::edge_iterator>
+    edges(const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::edge_descriptor, bool>
+    edge(V s, V t, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend size_t out_degree(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend size_t in_degree(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::out_edge_iterator,
+                     typename csr_adj_list<V, I>::out_edge_iterator>
+    out_edges(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::in_edge_iterator,
+                     typename csr_adj_list<V, I>::in_edge_iterator>
+    in_edges(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::adjacency_iterator,
+                     typename csr_adj_list<V, I>::adjacency_iterator>
+    out_neighbours(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend std::pair<typename csr_adj_list<V, I>::adjacency_iterator,
+                     typename csr_adj_list<V, I>::adjacency_iterator>
+    in_neighbours(V v, const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend size_t num_vertices(const csr_adj_list<V, I>& g);
+
+    template <class V, class I>
+    friend size_t num_edges(const csr_adj_list<V, I>& g);
+};
+
+//========================================================================
+// Graph traits and BGL scaffolding
+//========================================================================
+
+template <class Vertex, class Index>
+struct graph_traits<csr_adj_list<Vertex, Index> >
+{
+    typedef Vertex vertex_descriptor;
+    typedef typename csr_adj_list<Vertex, Index>::edge_descriptor edge_descriptor;
+    typedef typename csr_adj_list<Vertex, Index>::edge_iterator edge_iterator;
+    typedef typename csr_adj_list<Vertex, Index>::adjacency_iterator adjacency_iterator;
+
+    typedef typename csr_adj_list<Vertex, Index>::out_edge_iterator out_edge_iterator;
+    typedef typename csr_adj_list<Vertex, Index>::in_edge_iterator in_edge_iterator;
+
+    typedef typename csr_adj_list<Vertex, Index>::vertex_iterator vertex_iterator;
+
+    typedef bidirectional_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef adj_list_traversal_tag traversal_category;
+
+    typedef Vertex vertices_size_type;
+    typedef Vertex edges_size_type;
+    typedef size_t degree_size_type;
+
+    static Vertex null_vertex()
+    {
+        return csr_adj_list<Vertex, Index>::null_vertex();
+    }
+};
+
+template <class Vertex, class Index>
+struct graph_traits<const csr_adj_list<Vertex, Index> >
+    : public graph_traits<csr_adj_list<Vertex, Index> >
+{
+};
+
+template <class Vertex, class Index>
+struct edge_property_type<csr_adj_list<Vertex, Index> >
+{
+    typedef void type;
+};
+
+template <class Vertex, class Index>
+struct vertex_property_type<csr_adj_list<Vertex, Index> >
+{
+    typedef void type;
+};
+
+template <class Vertex, class Index>
+struct graph_property_type<csr_adj_list<Vertex, Index> >
+{
+    typedef void type;
+};
+
+//========================================================================
+// Graph access functions
+//========================================================================
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::vertex_iterator,
+          typename csr_adj_list<Vertex, Index>::vertex_iterator>
+vertices(const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::vertex_iterator vi_t;
+    return {vi_t(0), vi_t(num_vertices(g))};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::edge_iterator,
+          typename csr_adj_list<Vertex, Index>::edge_iterator>
+edges(const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::edge_iterator ei_t;
+    return {ei_t(&g, 0, 0),
+            ei_t(&g, num_vertices(g), g._out_edges.size())};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+Vertex vertex(size_t i, const csr_adj_list<Vertex, Index>&)
+{
+    return i;
+}
+
+template <class Vertex, class Index>
+inline
+std::pair<typename csr_adj_list<Vertex, Index>::edge_descriptor, bool>
+edge(Vertex s, Vertex t, const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::edge_descriptor edge_descriptor;
+    auto begin = g._out_edges.begin() + g._out_pos[s];
+    auto end = g._out_edges.begin() + g._out_pos[s + 1];
+    auto iter = std::find_if(begin, end,
+                             [&](const auto& e) -> bool {return e.first == t;});
+    if (iter != end)
+        return {edge_descriptor(s, t, iter->second, false), true};
+    Vertex v = graph_traits<csr_adj_list<Vertex, Index> >::null_vertex();
+    return {edge_descriptor(v, v, v, false), false};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+size_t out_degree(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    return g._out_pos[v + 1] - g._out_pos[v];
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+size_t in_degree(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    return g._in_pos[v + 1] - g._in_pos[v];
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+size_t degree(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    return in_degree(v, g) + out_degree(v, g);
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::out_edge_iterator,
+          typename csr_adj_list<Vertex, Index>::out_edge_iterator>
+out_edges(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::out_edge_iterator ei_t;
+    auto base = g._out_edges.data();
+    return {ei_t(v, base + g._out_pos[v]), ei_t(v, base + g._out_pos[v + 1])};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::in_edge_iterator,
+          typename csr_adj_list<Vertex, Index>::in_edge_iterator>
+in_edges(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::in_edge_iterator ei_t;
+    auto base = g._in_edges.data();
+    return {ei_t(v, base + g._in_pos[v]), ei_t(v, base + g._in_pos[v + 1])};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::adjacency_iterator,
+          typename csr_adj_list<Vertex, Index>::adjacency_iterator>
+out_neighbours(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::adjacency_iterator ai_t;
+    auto base = g._out_edges.data();
+    return {ai_t(base + g._out_pos[v]), ai_t(base + g._out_pos[v + 1])};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::adjacency_iterator,
+          typename csr_adj_list<Vertex, Index>::adjacency_iterator>
+in_neighbours(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    typedef typename csr_adj_list<Vertex, Index>::adjacency_iterator ai_t;
+    auto base = g._in_edges.data();
+    return {ai_t(base + g._in_pos[v]), ai_t(base + g._in_pos[v + 1])};
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex, Index>::adjacency_iterator,
+          typename csr_adj_list<Vertex, Index>::adjacency_iterator>
+adjacent_vertices(Vertex v, const csr_adj_list<Vertex, Index>& g)
+{
+    return out_neighbours(v, g);
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+size_t num_vertices(const csr_adj_list<Vertex, Index>& g)
+{
+    return g._out_pos.size() - 1;
+}
+
+template <class Vertex, class Index>
+inline __attribute__((always_inline))
+size_t num_edges(const csr_adj_list<Vertex, Index>& g)
+{
+    return g._out_edges.size();
+}
+
+template <class Vertex, class Index>
+inline
+Vertex source(const typename csr_adj_list<Vertex, Index>::edge_descriptor& e,
+              const csr_adj_list<Vertex, Index>&)
+{
+    return e.s;
+}
+
+template <class Vertex, class Index>
+inline
+Vertex target(const typename csr_adj_list<Vertex, Index>::edge_descriptor& e,
+              const csr_adj_list<Vertex, Index>&)
+{
+    return e.t;
+}
+
+//========================================================================
+// Vertex and edge index property maps
+//========================================================================
+
+template <class Vertex, class Index>
+struct property_map<csr_adj_list<Vertex, Index>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex, class Index>
+struct property_map<const csr_adj_list<Vertex, Index>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex, class Index>
+inline identity_property_map
+get(vertex_index_t, csr_adj_list<Vertex, Index>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex, class Index>
+inline identity_property_map
+get(vertex_index_t, const csr_adj_list<Vertex, Index>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex, class Index>
+struct property_map<csr_adj_list<Vertex, Index>, edge_index_t>
+{
+    typedef adj_edge_index_property_map<Vertex> type;
+    typedef type const_type;
+};
+
+template <class Vertex, class Index>
+inline adj_edge_index_property_map<Vertex>
+get(edge_index_t, const csr_adj_list<Vertex, Index>&)
+{
+    return adj_edge_index_property_map<Vertex>();
+}
+
+} // namespace boost
+
+#endif //GRAPH_CSR_HH
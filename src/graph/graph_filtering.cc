@@ -140,6 +140,48 @@ boost::any GraphInterface::get_graph_view() const
     return graph;
 }
 
+// gets the view of the frozen CSR snapshot at run time, rebuilding it if
+// necessary
+boost::any GraphInterface::get_frozen_graph_view() const
+{
+    if (!_frozen || _vertex_filter_active || _edge_filter_active)
+        return boost::any();
+
+    auto& gi = const_cast<GraphInterface&>(*this);
+    if (_frozen_compact && compact_frozen_graph_t::fits(*_mg))
+    {
+        if (!_cfg->is_current(*_mg))
+        {
+            *_fg = frozen_graph_t();
+            _cfg->build(*_mg);
+        }
+        return check_directed(*_cfg, _reversed, _directed, gi);
+    }
+
+    if (!_fg->is_current(*_mg))
+    {
+        *_cfg = compact_frozen_graph_t();
+        _fg->build(*_mg);
+    }
+    return check_directed(*_fg, _reversed, _directed, gi);
+}
+
+// if frozen, an immutable CSR snapshot of the graph is kept and used by
+// read-only algorithms; it is rebuilt lazily after the graph is modified. If
+// compact is true, 32-bit storage is used whenever the graph is small enough.
+// The snapshot objects themselves are never replaced, since the cached graph
+// views refer to them.
+void GraphInterface::set_frozen(bool frozen, bool compact)
+{
+    if (!frozen || compact != _frozen_compact)
+    {
+        *_fg = frozen_graph_t();
+        *_cfg = compact_frozen_graph_t();
+    }
+    _frozen = frozen;
+    _frozen_compact = compact;
+}
+
 // these test whether or not the vertex and edge filters are active
 bool GraphInterface::is_vertex_filter_active() const
 { return _vertex_filter_active; }
@@ -150,11 +192,6 @@ bool GraphInterface::is_edge_filter_active() const
 
 // this function will reindex all the edges, in the order in which they are
 // found
-void GraphInterface::re_index_edges()
-{
-    _mg->reindex_edges();
-}
-
 // this will definitively remove all the edges from the graph, which are being
 // currently filtered out. This will also disable the edge filter
 void GraphInterface::purge_edges()
@@ -183,39 +220,26 @@ void GraphInterface::purge_vertices(boost::any aold_index)
     if (!is_vertex_filter_active())
         return;
 
-    typedef vprop_map_t<int32_t>::type index_prop_t;
+    typedef vprop_map_t<int64_t>::type index_prop_t;
     index_prop_t old_index = any_cast<index_prop_t>(aold_index);
 
     MaskFilter<vertex_filter_t> filter(_vertex_filter_map,
                                        _vertex_filter_invert);
     size_t N = num_vertices(*_mg);
     vector<bool> deleted(N, false);
+    vector<int64_t> old_indexes;
     for (size_t i = 0; i < N; ++i)
-        deleted[i] = !filter(vertex(i, *_mg));
-    vector<int> old_indexes;
-
-    vector<graph_traits<multigraph_t>::edge_descriptor> edges;
-
-    //remove vertices
-    for (int i = N-1; i >= 0; --i)
     {
-        if (deleted[i])
-        {
-            graph_traits<multigraph_t>::vertex_descriptor v =
-                vertex(i, *_mg);
-            remove_vertex(v, *_mg);
-        }
-        else
-        {
+        deleted[i] = !filter(vertex(i, *_mg));
+        if (!deleted[i])
             old_indexes.push_back(i);
-        }
     }
 
-    N = old_indexes.size();
-    for (int i = N-1; i >= 0; --i)
-    {
-        old_index[vertex((N - 1) - i, *_mg)] = old_indexes[i];
-    }
+    // remove all vertices in a single pass
+    remove_vertices([&](auto v) { return deleted[v]; }, *_mg);
+
+    for (size_t i = 0; i < old_indexes.size(); ++i)
+        old_index[vertex(i, *_mg)] = old_indexes[i];
 }
 
 void GraphInterface::set_vertex_filter_property(boost::any property, bool invert)
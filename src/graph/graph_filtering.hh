@@ -41,6 +41,8 @@
 #include <boost/mpl/greater_equal.hpp>
 #include <boost/mpl/comparison.hpp>
 #include <boost/mpl/transform_view.hpp>
+#include <boost/mpl/transform.hpp>
+#include <boost/mpl/remove.hpp>
 #include <boost/mpl/quote.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/print.hpp>
@@ -356,6 +358,81 @@ struct never_filtered_never_reversed:
                                boost::mpl::bool_<false>,boost::mpl::bool_<false>,
                                boost::mpl::bool_<true>,boost::mpl::bool_<true> >::type {};
 
+// Frozen graph views
+// ------------------
+//
+// If the graph is frozen (see GraphInterface::set_frozen()), read-only
+// algorithms can be dispatched over views of the CSR snapshot instead. Since
+// the snapshot is never filtered, there is a frozen counterpart only for the
+// unfiltered graph views.
+
+// metafunction to get the frozen counterpart of a graph view, or void if it
+// does not exist
+template <class Graph, class FrozenGraph>
+struct freeze_graph_view
+{
+    typedef void type;
+};
+
+template <class FrozenGraph>
+struct freeze_graph_view<GraphInterface::multigraph_t, FrozenGraph>
+{
+    typedef FrozenGraph type;
+};
+
+template <class FrozenGraph>
+struct freeze_graph_view<boost::reverse_graph<GraphInterface::multigraph_t>,
+                         FrozenGraph>
+{
+    typedef boost::reverse_graph<FrozenGraph> type;
+};
+
+template <class FrozenGraph>
+struct freeze_graph_view<boost::UndirectedAdaptor<GraphInterface::multigraph_t>,
+                         FrozenGraph>
+{
+    typedef boost::UndirectedAdaptor<FrozenGraph> type;
+};
+
+template <class FrozenGraph>
+struct graph_freeze
+{
+    template <class Graph>
+    struct apply
+    {
+        typedef typename freeze_graph_view<Graph, FrozenGraph>::type type;
+    };
+};
+
+// this metafunction returns the frozen graph views corresponding to a sequence
+// of graph views, for both 64 and 32-bit snapshots
+struct get_frozen_graph_views
+{
+    template <class GraphViews>
+    struct apply
+    {
+        typedef typename boost::mpl::remove<
+            typename boost::mpl::transform<
+                GraphViews,
+                graph_freeze<GraphInterface::frozen_graph_t>>::type,
+            void>::type full_views;
+
+        typedef typename boost::mpl::remove<
+            typename boost::mpl::transform<
+                GraphViews,
+                graph_freeze<GraphInterface::compact_frozen_graph_t>>::type,
+            void>::type compact_views;
+
+        typedef typename boost::mpl::insert_range<
+            full_views,
+            typename boost::mpl::end<full_views>::type,
+            compact_views>::type type;
+    };
+};
+
+struct frozen_graph_views:
+    get_frozen_graph_views::apply<all_graph_views>::type {};
+
 // sanity check
 typedef boost::mpl::size<all_graph_views>::type n_views;
 #ifndef NO_GRAPH_FILTERING
@@ -473,6 +550,31 @@ struct run_action
     }
 };
 
+// Same as run_action, but if the graph is frozen and no filtering is active,
+// "Action" is dispatched across the corresponding views of the CSR snapshot
+// instead. The action must therefore not modify the graph.
+template <class GraphViews = detail::all_graph_views, class Wrap = boost::mpl::false_>
+struct run_frozen_action
+{
+    template <class Action, class... TRS>
+    auto operator()(GraphInterface& gi, Action a, TRS...)
+    {
+        typedef typename detail::get_frozen_graph_views::apply<GraphViews>::type
+            frozen_views;
+        auto dispatch = detail::action_dispatch<Action,Wrap,GraphViews,TRS...>(a);
+        auto fdispatch = detail::action_dispatch<Action,Wrap,frozen_views,TRS...>(a);
+        auto wrap = [dispatch, fdispatch, &gi](auto&&... args)
+            {
+                boost::any fview = gi.get_frozen_graph_view();
+                if (fview.empty())
+                    dispatch(gi.get_graph_view(), args...);
+                else
+                    fdispatch(fview, args...);
+            };
+        return wrap;
+    }
+};
+
 template <class Wrap = boost::mpl::false_>
 struct gt_dispatch
 {
@@ -491,6 +593,7 @@ typedef detail::never_reversed never_reversed;
 typedef detail::always_directed_never_reversed always_directed_never_reversed;
 typedef detail::never_filtered never_filtered;
 typedef detail::never_filtered_never_reversed never_filtered_never_reversed;
+typedef detail::frozen_graph_views frozen_graph_views;
 
 // returns true if graph filtering was enabled at compile time
 bool graph_filtering_enabled();
@@ -508,6 +611,21 @@ std::shared_ptr<Graph> get_graph_ptr(GraphInterface&, GraphInit& g, std::false_t
     return std::make_shared<Graph>(g);
 }
 
+// position of a graph view in the list stored by GraphInterface; the frozen
+// views are stored after the regular ones
+template <class Graph>
+size_t get_graph_view_index(std::true_type)
+{
+    return boost::mpl::find<detail::all_graph_views,Graph>::type::pos::value;
+}
+
+template <class Graph>
+size_t get_graph_view_index(std::false_type)
+{
+    return (detail::n_views::value +
+            boost::mpl::find<detail::frozen_graph_views,Graph>::type::pos::value);
+}
+
 // this function retrieves a graph view stored in graph_views, or stores one if
 // non-existent
 template <class Graph>
@@ -515,7 +633,11 @@ typename std::shared_ptr<Graph>
 retrieve_graph_view(GraphInterface& gi, Graph& init)
 {
     typedef typename std::remove_const<Graph>::type g_t;
-    size_t index = boost::mpl::find<detail::all_graph_views,g_t>::type::pos::value;
+    typedef typename boost::mpl::find<detail::all_graph_views,g_t>::type iter_t;
+    typedef typename boost::mpl::end<detail::all_graph_views>::type end_t;
+    size_t index =
+        get_graph_view_index<g_t>
+            (std::integral_constant<bool, !std::is_same<iter_t, end_t>::value>());
     auto& graph_views = gi.get_graph_views();
     if (index >= graph_views.size())
         graph_views.resize(index + 1);
@@ -24,6 +24,7 @@
 #include <boost/iostreams/filter/bzip2.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/graph/graphml.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/xpressive/xpressive.hpp>
@@ -405,9 +406,41 @@ boost::python::tuple GraphInterface::read_from_file(string file,
         if (format == "gt")
         {
             vector<pair<string, boost::any>> agprops, avprops, aeprops;
-            stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
-            _directed = read_graph(stream, *_mg, agprops, avprops, aeprops, igp,
-                                   ivp, iep);
+
+            // uncompressed files in the aligned variant of the format are
+            // read directly from a (read-only) memory map
+            bool mapped = false;
+            if (file != "-" && pfile == boost::python::object() &&
+                !boost::ends_with(file, ".gz") &&
+                !boost::ends_with(file, ".bz2"))
+            {
+                boost::iostreams::mapped_file_source mfile;
+                try
+                {
+                    mfile.open(file);
+                }
+                catch (ios_base::failure&)
+                {
+                    // e.g. empty files or special devices; fall back to the
+                    // stream below
+                }
+                if (mfile.is_open() &&
+                    is_aligned_graph(mfile.data(), mfile.size()))
+                {
+                    _directed = read_aligned_graph(mfile.data(), mfile.size(),
+                                                   *_mg, agprops, avprops,
+                                                   aeprops, igp, ivp, iep);
+                    mapped = true;
+                }
+            }
+
+            if (!mapped)
+            {
+                stream.exceptions(ios_base::badbit | ios_base::failbit |
+                                  ios_base::eofbit);
+                _directed = read_graph(stream, *_mg, agprops, avprops, aeprops,
+                                       igp, ivp, iep);
+            }
             for (auto& p : agprops)
                 gprops[p.first] = find_property_map(p.second, _graph_index);
             for (auto& p : avprops)
@@ -506,9 +539,11 @@ struct do_write_to_binary_file
     void operator()(ostream& stream, Graph& g, IndexMap index_map, size_t N,
                     bool directed, vector<pair<string, boost::any >> & gprops,
                     vector<pair<string, boost::any >> & vprops,
-                    vector<pair<string, boost::any >> & eprops) const
+                    vector<pair<string, boost::any >> & eprops,
+                    bool aligned, bool block_compress) const
     {
-        write_graph(g, index_map, N, directed, gprops, vprops, eprops, stream);
+        write_graph(g, index_map, N, directed, gprops, vprops, eprops, aligned,
+                    block_compress, stream);
     }
 };
 
@@ -525,11 +560,17 @@ struct generate_index
 };
 
 void GraphInterface::write_to_file(string file, boost::python::object pfile,
-                                   string format, boost::python::list props)
+                                   string format, boost::python::list props,
+                                   bool aligned, bool block_compress)
 {
     if (format != "gt" && format != "xml" && format != "dot" && format != "gml")
         throw ValueException("error writing to file '" + file +
                              "': requested invalid format '" + format + "'");
+    if (block_compress && (format != "gt" || boost::ends_with(file, ".gz") ||
+                           boost::ends_with(file, ".bz2")))
+        throw ValueException("error writing to file '" + file +
+                             "': block compression is only supported for "
+                             "uncompressed files in the 'gt' format");
     try
     {
         boost::iostreams::filtering_stream<boost::iostreams::output> stream;
@@ -594,7 +635,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                aligned, block_compress))();
             }
             else
             {
@@ -606,7 +648,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                aligned, block_compress))();
             }
 
             _directed = directed;
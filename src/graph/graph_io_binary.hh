@@ -19,9 +19,12 @@
 #define GRAPH_IO_BINARY_HH
 
 #include <iostream>
+#include <iterator>
+#include <cstring>
 #include "graph.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_io_block.hh"
 #include <unordered_set>
 
 namespace graph_tool
@@ -30,6 +33,8 @@ namespace graph_tool
 const char* _magic = u8"⛾ gt";
 size_t _magic_length = 6;
 const uint8_t _version = 1;
+const uint8_t _aligned_version = 2;
+const uint8_t _block_version = 0x80; // block-compressed container
 
 // deal with endianness
 
@@ -49,6 +54,74 @@ void byte_swap(T& p)
 }
 
 
+// Stream buffer which forwards the output to another one, while counting the
+// number of bytes written. This is used to insert the padding required by the
+// aligned variant of the format, since the underlying streams (e.g. when
+// compressing) are not necessarily able to report their position.
+
+class counting_streambuf: public std::streambuf
+{
+public:
+    counting_streambuf(std::streambuf* sb): _sb(sb), _count(0) {}
+
+    size_t count() const { return _count; }
+
+protected:
+    int_type overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        int_type r = _sb->sputc(traits_type::to_char_type(c));
+        if (!traits_type::eq_int_type(r, traits_type::eof()))
+            _count++;
+        return r;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        std::streamsize r = _sb->sputn(s, n);
+        _count += r;
+        return r;
+    }
+
+    int sync() { return _sb->pubsync(); }
+
+private:
+    std::streambuf* _sb;
+    size_t _count;
+};
+
+// Stream buffer over a contiguous region of memory (e.g. a memory-mapped
+// file), which allows the arrays of the aligned variant of the format to be
+// copied in bulk, while the remaining values are read with the usual stream
+// functions.
+
+class memory_streambuf: public std::streambuf
+{
+public:
+    memory_streambuf(const char* data, size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    size_t pos() const { return gptr() - eback(); }
+    size_t available() const { return egptr() - gptr(); }
+    const char* data() const { return gptr(); }
+
+    void advance(size_t n)
+    {
+        if (n > available())
+            throw IOException("Error reading graph: unexpected end of file");
+        setg(eback(), gptr() + n, egptr());
+    }
+
+    void align(size_t a)
+    {
+        advance((a - pos() % a) % a);
+    }
+};
+
 template <typename T>
 void write(std::ostream& s, T v)
 {
@@ -241,6 +314,140 @@ bool read_adjacency(Graph& g, std::istream& s)
     return directed;
 }
 
+// Aligned variant: the adjacency is stored in compressed sparse row form, with
+// all arrays aligned in the file, so that they can be read from a memory map
+// with bulk copies
+
+void write_padding(std::ostream& s, const counting_streambuf& buf, size_t a)
+{
+    static const char zeros[16] = {};
+    size_t pad = (a - buf.count() % a) % a;
+    s.write(zeros, pad);
+}
+
+template <bool BE, typename T>
+T read_element(const char* data, size_t i)
+{
+    T v;
+    memcpy(&v, data + i * sizeof(T), sizeof(T));
+    byte_swap<BE>(v);
+    return v;
+}
+
+template <class Vint, class Graph, class VProp>
+void write_aligned_adjacency_dispatch(Graph& g, const VProp& vindex,
+                                      std::ostream& s,
+                                      const counting_streambuf& buf)
+{
+    uint64_t pos = 0;
+    write(s, pos);
+    for (auto v : vertices_range(g))
+    {
+        pos += out_degree(v, g);
+        write(s, pos);
+    }
+
+    std::vector<Vint> us;
+    for (auto v : vertices_range(g))
+    {
+        us.clear();
+        for (auto e : out_edges_range(v, g))
+            us.push_back(vindex[target(e, g)]);
+        s.write(reinterpret_cast<const char*>(us.data()),
+                sizeof(Vint) * us.size());
+    }
+    write_padding(s, buf, 16);
+}
+
+template <class Graph, class VProp>
+void write_aligned_adjacency(Graph& g, const VProp& vindex, uint64_t N,
+                             bool is_directed, std::ostream& s,
+                             const counting_streambuf& buf)
+{
+    uint8_t directed = is_directed;
+    write(s, directed);
+    write_padding(s, buf, 8);
+    write(s, N);
+    uint64_t E = num_edges(g);
+    write(s, E);
+
+    if (N <= numeric_limits<uint8_t>::max())
+        write_aligned_adjacency_dispatch<uint8_t>(g, vindex, s, buf);
+    else if (N <= numeric_limits<uint16_t>::max())
+        write_aligned_adjacency_dispatch<uint16_t>(g, vindex, s, buf);
+    else if (N <= numeric_limits<uint32_t>::max())
+        write_aligned_adjacency_dispatch<uint32_t>(g, vindex, s, buf);
+    else
+        write_aligned_adjacency_dispatch<uint64_t>(g, vindex, s, buf);
+}
+
+template <bool BE, class Vint, class Graph>
+void read_aligned_adjacency_dispatch(Graph& g, size_t N, size_t E,
+                                     memory_streambuf& buf)
+{
+    if (N >= buf.available() / sizeof(uint64_t))
+        throw IOException("Error reading graph: unexpected end of file");
+    const char* pos = buf.data();
+    buf.advance((N + 1) * sizeof(uint64_t));
+    if (E > buf.available() / sizeof(Vint))
+        throw IOException("Error reading graph: unexpected end of file");
+    const char* targets = buf.data();
+    buf.advance(E * sizeof(Vint));
+    buf.align(16);
+
+    auto get_pos = [&](size_t v) { return read_element<BE, uint64_t>(pos, v); };
+    auto get_target = [&](size_t i) { return read_element<BE, Vint>(targets, i); };
+
+    if (get_pos(0) != 0 || get_pos(N) != E)
+        throw IOException("error reading graph: inconsistent edge offsets");
+
+    bool valid = true;
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH) \
+        reduction(&&:valid)
+    for (size_t v = 0; v < N; ++v)
+    {
+        size_t begin = get_pos(v);
+        size_t end = get_pos(v + 1);
+        if (begin > end || end > E)
+        {
+            valid = false;
+            continue;
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (size_t(get_target(i)) >= N)
+                valid = false;
+        }
+    }
+    if (!valid)
+        throw IOException("error reading graph: vertex index not in range");
+
+    g.assign_csr(N, get_pos, get_target);
+}
+
+template <bool BE, class Graph>
+bool read_aligned_adjacency(Graph& g, memory_streambuf& buf, std::istream& s)
+{
+    uint8_t directed = false;
+    read<BE>(s, directed);
+    buf.align(8);
+
+    uint64_t N = 0, E = 0;
+    read<BE>(s, N);
+    read<BE>(s, E);
+
+    if (N <= numeric_limits<uint8_t>::max())
+        read_aligned_adjacency_dispatch<BE, uint8_t>(g, N, E, buf);
+    else if (N <= numeric_limits<uint16_t>::max())
+        read_aligned_adjacency_dispatch<BE, uint16_t>(g, N, E, buf);
+    else if (N <= numeric_limits<uint32_t>::max())
+        read_aligned_adjacency_dispatch<BE, uint32_t>(g, N, E, buf);
+    else
+        read_aligned_adjacency_dispatch<BE, uint64_t>(g, N, E, buf);
+
+    return directed;
+}
+
 // Property maps
 
 enum class property_type : uint8_t
@@ -271,6 +478,9 @@ struct graph_range_traits
     template <class Graph>
     static graph_range get_range(Graph&) { return graph_range(); }
 
+    template <class Graph>
+    static size_t get_size(Graph&) { return 1; }
+
     static property_type get_property_id() { return property_type::Graph; }
 };
 
@@ -285,6 +495,9 @@ struct vertex_range_traits
     IterRange<typename boost::graph_traits<Graph>::vertex_iterator>
     static get_range(Graph& g) { return vertices_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_vertices(g); }
+
     static property_type get_property_id() { return property_type::Vertex; }
 };
 
@@ -299,6 +512,9 @@ struct edge_range_traits
     IterRange<typename boost::graph_traits<Graph>::edge_iterator>
     static get_range(Graph& g) { return edges_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_edges(g); }
+
     static property_type get_property_id() { return property_type::Edge; }
 };
 
@@ -306,9 +522,9 @@ struct edge_range_traits
 template <class RangeTraits>
 struct write_property_dispatch
 {
-    template <class T, class Graph>
+    template <class T, class Graph, class Pad>
     void operator()(T, Graph& g, boost::any& aprop, bool& found,
-                    std::ostream& s) const
+                    const Pad& pad, std::ostream& s) const
     {
         try
         {
@@ -317,6 +533,7 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, T>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
+            pad();
             for (auto x : RangeTraits::get_range(g))
                 write(s, prop[x]);
             found = true;
@@ -325,9 +542,9 @@ struct write_property_dispatch
     }
 
 
-    template <class Graph>
+    template <class Graph, class Pad>
     void operator()(size_t, Graph& g, boost::any& aprop, bool& found,
-                    std::ostream& s) const
+                    const Pad& pad, std::ostream& s) const
     {
         try
         {
@@ -336,6 +553,7 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, int64_t>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
+            pad();
             int64_t y;
             for (auto x : vertices_range(g))
             {
@@ -353,6 +571,7 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, int64_t>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
+            pad();
             int64_t y;
             for (auto x : edges_range(g))
             {
@@ -367,8 +586,16 @@ struct write_property_dispatch
 };
 
 
-template <class RangeTraits, class Graph>
-void write_property(Graph& g, std::string& name, boost::any& prop, std::ostream& s)
+// padding inserted before the property values; only used by the aligned
+// variant of the format
+struct no_padding
+{
+    void operator()() const {}
+};
+
+template <class RangeTraits, class Graph, class Pad = no_padding>
+void write_property(Graph& g, std::string& name, boost::any& prop,
+                    std::ostream& s, const Pad& pad = Pad())
 {
     property_type pt = RangeTraits::get_property_id();
     write(s, pt);
@@ -377,7 +604,7 @@ void write_property(Graph& g, std::string& name, boost::any& prop, std::ostream&
     mpl::for_each<val_types>(std::bind(write_property_dispatch<RangeTraits>(),
                                        std::placeholders::_1, std::ref(g),
                                        std::ref(prop), std::ref(found),
-                                       std::ref(s)));
+                                       std::cref(pad), std::ref(s)));
     if (!found)
         throw GraphException("Error writing graph: unknown property map type (this is a bug)");
 }
@@ -438,14 +665,102 @@ read_property(Graph& g, const std::unordered_set<std::string>& ignore,
 }
 
 
-template <class Graph, class VProp>
-void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
-                 std::vector<std::pair<std::string, boost::any>>& gprops,
-                 std::vector<std::pair<std::string, boost::any>>& vprops,
-                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s)
+// In the aligned variant, the values of scalar properties are stored as
+// contiguous arrays, which are copied as a whole
+
+template <bool BE, class RangeTraits>
+struct read_aligned_property_dispatch
+{
+    template <class T, class Graph>
+    void operator()(T, Graph& g, boost::any& aprop, uint8_t val, bool ignore,
+                    bool& found, memory_streambuf& buf, std::istream& s) const
+    {
+        typedef typename mpl::find<val_types, T>::type pos;
+        if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value == val)
+        {
+            buf.align(16);
+            dispatch(T(), g, aprop, ignore, buf, s,
+                     typename std::is_scalar<T>::type());
+            found = true;
+        }
+    }
+
+    template <class T, class Graph>
+    void dispatch(T, Graph& g, boost::any& aprop, bool ignore,
+                  memory_streambuf& buf, std::istream&, std::true_type) const
+    {
+        size_t n = RangeTraits::get_size(g);
+        if (n > buf.available() / sizeof(T))
+            throw IOException("Error reading graph: unexpected end of file");
+        const char* data = buf.data();
+        buf.advance(n * sizeof(T));
+        if (ignore)
+            return;
+
+        typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+        pmap_t prop(RangeTraits::get_index_map(g));
+        auto& vals = prop.get_storage();
+        vals.resize(n);
+        memcpy(vals.data(), data, n * sizeof(T));
+        for (auto& x : vals)
+            byte_swap<BE>(x);
+        aprop = prop;
+    }
+
+    template <class T, class Graph>
+    void dispatch(T, Graph& g, boost::any& aprop, bool ignore,
+                  memory_streambuf&, std::istream& s, std::false_type) const
+    {
+        typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+        pmap_t prop(RangeTraits::get_index_map(g));
+        if (!ignore)
+        {
+            for (auto x : RangeTraits::get_range(g))
+                read<BE>(s, prop[x]);
+            aprop = prop;
+        }
+        else
+        {
+            T y;
+            for (auto x : RangeTraits::get_range(g))
+            {
+                (void)x;
+                skip<BE>(s, y);
+            }
+        }
+    }
+};
+
+template <bool BE, class RangeTraits, class Graph>
+std::pair<std::string, boost::any>
+read_aligned_property(Graph& g, const std::unordered_set<std::string>& ignore,
+                      memory_streambuf& buf, std::istream& s)
+{
+    boost::any prop;
+    bool found = false;
+    std::string name;
+    read<BE>(s, name);
+    bool skip = ignore.find(name) != ignore.end();
+    uint8_t val = 0;
+    read<BE>(s, val);
+    mpl::for_each<val_types>(std::bind(read_aligned_property_dispatch<BE, RangeTraits>(),
+                                       std::placeholders::_1, std::ref(g),
+                                       std::ref(prop), val, skip, std::ref(found),
+                                       std::ref(buf), std::ref(s)));
+    if (!found)
+        throw IOException("Error reading graph: invalid property value type index "
+                          + boost::lexical_cast<std::string>(val));
+    return make_pair(name, prop);
+}
+
+
+template <class Graph>
+void write_header(Graph& g, size_t N, bool directed, uint8_t version,
+                  size_t n_gprops, size_t n_vprops, size_t n_eprops,
+                  std::ostream& s)
 {
     s.write(_magic, _magic_length);
-    write(s, _version);
+    write(s, version);
     uint8_t big_end = is_bigendian();
     write(s, big_end);
     string comment = "graph-tool binary file (http:://graph-tool.skewed.de)"
@@ -453,10 +768,70 @@ void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
     comment += " stats: " + lexical_cast<std::string>(N) + " vertices, " +
         lexical_cast<std::string>(num_edges(g)) + " edges, " +
         std::string((directed) ? "directed, " : "undirected, ") +
-        lexical_cast<std::string>(gprops.size()) + " graph props, " +
-        lexical_cast<std::string>(vprops.size()) + " vertex props, " +
-        lexical_cast<std::string>(eprops.size()) + " edge props";
+        lexical_cast<std::string>(n_gprops) + " graph props, " +
+        lexical_cast<std::string>(n_vprops) + " vertex props, " +
+        lexical_cast<std::string>(n_eprops) + " edge props";
     write(s, comment);
+}
+
+template <class Graph, class VProp>
+void write_aligned_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
+                         std::vector<std::pair<std::string, boost::any>>& gprops,
+                         std::vector<std::pair<std::string, boost::any>>& vprops,
+                         std::vector<std::pair<std::string, boost::any>>& eprops,
+                         std::ostream& os)
+{
+    counting_streambuf buf(os.rdbuf());
+    std::ostream s(&buf);
+    s.exceptions(os.exceptions());
+
+    write_header(g, N, directed, _aligned_version, gprops.size(),
+                 vprops.size(), eprops.size(), s);
+    write_padding(s, buf, 8);
+
+    write_aligned_adjacency(g, vindex, N, directed, s, buf);
+    uint64_t nprops = gprops.size() + vprops.size() + eprops.size();
+    write(s, nprops);
+    auto pad = [&]() { write_padding(s, buf, 16); };
+    for (auto& p : gprops)
+        write_property<graph_range_traits>(g, p.first, p.second, s, pad);
+    for (auto& p : vprops)
+        write_property<vertex_range_traits>(g, p.first, p.second, s, pad);
+    for (auto& p : eprops)
+        write_property<edge_range_traits>(g, p.first, p.second, s, pad);
+    s.flush();
+}
+
+template <class Graph, class VProp>
+void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
+                 std::vector<std::pair<std::string, boost::any>>& gprops,
+                 std::vector<std::pair<std::string, boost::any>>& vprops,
+                 std::vector<std::pair<std::string, boost::any>>& eprops,
+                 bool aligned, bool block, std::ostream& s)
+{
+    if (block)
+    {
+        // the whole output is wrapped in a block-compressed container
+        s.write(_magic, _magic_length);
+        write(s, _block_version);
+        block_compress_streambuf buf(s.rdbuf());
+        std::ostream bs(&buf);
+        bs.exceptions(s.exceptions());
+        write_graph(g, vindex, N, directed, gprops, vprops, eprops, aligned,
+                    false, bs);
+        bs.flush();
+        buf.close();
+        return;
+    }
+
+    if (aligned)
+    {
+        write_aligned_graph(g, vindex, N, directed, gprops, vprops, eprops, s);
+        return;
+    }
+
+    write_header(g, N, directed, _version, gprops.size(), vprops.size(),
+                 eprops.size(), s);
 
     write_adjacency(g, vindex, N, directed, s);
     uint64_t nprops = gprops.size() + vprops.size() + eprops.size();
@@ -477,9 +852,19 @@ bool read_graph_dispatch(Graph& g,
                          const std::unordered_set<std::string>& ignore_gp,
                          const std::unordered_set<std::string>& ignore_vp,
                          const std::unordered_set<std::string>& ignore_ep,
-                         std::istream& s)
+                         std::istream& s, memory_streambuf* buf = nullptr)
 {
-    bool directed = read_adjacency<BE>(g, s);
+    // the aligned variant is read from memory, through buf
+    auto read_prop = [&](auto traits, auto& ignore)
+        {
+            typedef decltype(traits) traits_t;
+            if (buf == nullptr)
+                return read_property<BE, traits_t>(g, ignore, s);
+            return read_aligned_property<BE, traits_t>(g, ignore, *buf, s);
+        };
+
+    bool directed = (buf == nullptr) ? read_adjacency<BE>(g, s) :
+        read_aligned_adjacency<BE>(g, *buf, s);
     uint64_t nprops;
     read<BE>(s, nprops);
     for (size_t i = 0; i < nprops; ++i)
@@ -490,17 +875,17 @@ bool read_graph_dispatch(Graph& g,
         switch (pt)
         {
         case property_type::Graph:
-            p = read_property<BE, graph_range_traits>(g, ignore_gp, s);
+            p = read_prop(graph_range_traits(), ignore_gp);
             if (!p.second.empty())
                 gprops.push_back(p);
             break;
         case property_type::Vertex:
-            p = read_property<BE, vertex_range_traits>(g, ignore_vp, s);
+            p = read_prop(vertex_range_traits(), ignore_vp);
             if (!p.second.empty())
                 vprops.push_back(p);
             break;
         case property_type::Edge:
-            p = read_property<BE, edge_range_traits>(g, ignore_ep, s);
+            p = read_prop(edge_range_traits(), ignore_ep);
             if (!p.second.empty())
                 eprops.push_back(p);
             break;
@@ -512,6 +897,43 @@ bool read_graph_dispatch(Graph& g,
     return directed;
 }
 
+inline bool is_aligned_graph(const char* data, size_t size)
+{
+    return (size > _magic_length &&
+            strncmp(data, _magic, _magic_length) == 0 &&
+            uint8_t(data[_magic_length]) == _aligned_version);
+}
+
+template <class Graph>
+bool read_aligned_graph(const char* data, size_t size, Graph& g,
+                        std::vector<std::pair<std::string, boost::any>>& gprops,
+                        std::vector<std::pair<std::string, boost::any>>& vprops,
+                        std::vector<std::pair<std::string, boost::any>>& eprops,
+                        const std::unordered_set<std::string>& ignore_gp,
+                        const std::unordered_set<std::string>& ignore_vp,
+                        const std::unordered_set<std::string>& ignore_ep)
+{
+    if (!is_aligned_graph(data, size))
+        throw IOException("Error reading graph: Invalid magic number or format version");
+
+    memory_streambuf buf(data, size);
+    std::istream s(&buf);
+    s.exceptions(std::ios_base::badbit | std::ios_base::failbit |
+                 std::ios_base::eofbit);
+    buf.advance(_magic_length + 1);
+    uint8_t big_end = 0;
+    read<false>(s, big_end);
+    string comment;
+    read<false>(s, comment);
+    buf.align(8);
+
+    if (big_end)
+        return read_graph_dispatch<true>(g, gprops, vprops, eprops, ignore_gp,
+                                         ignore_vp, ignore_ep, s, &buf);
+    else
+        return read_graph_dispatch<false>(g, gprops, vprops, eprops, ignore_gp,
+                                          ignore_vp, ignore_ep, s, &buf);
+}
 
 template <class Graph>
 bool read_graph(std::istream& s, Graph& g,
@@ -528,6 +950,25 @@ bool read_graph(std::istream& s, Graph& g,
         throw IOException("Error reading graph: Invalid magic number");
     uint8_t version = 0;
     read<false>(s, version);
+    if (version == _block_version)
+    {
+        block_decompress_streambuf buf(s.rdbuf());
+        std::istream bs(&buf);
+        bs.exceptions(s.exceptions());
+        return read_graph(bs, g, gprops, vprops, eprops, ignore_gp, ignore_vp,
+                          ignore_ep);
+    }
+    if (version == _aligned_version)
+    {
+        // the aligned variant is parsed from memory; if it was not possible to
+        // map the file directly, the whole stream needs to be buffered first
+        std::string data(magic, _magic_length);
+        data.push_back(version);
+        data.append(std::istreambuf_iterator<char>(s),
+                    std::istreambuf_iterator<char>());
+        return read_aligned_graph(data.data(), data.size(), g, gprops, vprops,
+                                  eprops, ignore_gp, ignore_vp, ignore_ep);
+    }
     if (version != _version)
         throw IOException("Error reading graph: Invalid format version " +
                           boost::lexical_cast<std::string>(version));
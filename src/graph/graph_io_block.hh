@@ -0,0 +1,328 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_BLOCK_HH
+#define GRAPH_IO_BLOCK_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Block-compressed container
+// ==========================
+//
+// The byte stream is split into blocks of fixed size, which are compressed
+// independently, so that a whole batch of them can be compressed or
+// decompressed in parallel. Each block is stored as a codec byte, followed by
+// the uncompressed and compressed sizes (uint64_t, little-endian) and the
+// compressed payload. The stream is terminated by an empty block.
+
+enum class block_codec : uint8_t
+{
+    None,
+    Zlib,
+    Zstd
+};
+
+const size_t _block_size = 1 << 22;
+
+inline size_t get_block_batch()
+{
+#ifdef USING_OPENMP
+    return 2 * size_t(omp_get_max_threads());
+#else
+    return 1;
+#endif
+}
+
+template <class T>
+void write_le(std::streambuf& sb, T v)
+{
+    char buf[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i)
+        buf[i] = char((uint64_t(v) >> (8 * i)) & 0xff);
+    if (sb.sputn(buf, sizeof(T)) != sizeof(T))
+        throw IOException("error writing block: output error");
+}
+
+template <class T>
+bool read_le(std::streambuf& sb, T& v)
+{
+    unsigned char buf[sizeof(T)];
+    if (sb.sgetn(reinterpret_cast<char*>(buf), sizeof(T)) != sizeof(T))
+        return false;
+    uint64_t x = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        x |= uint64_t(buf[i]) << (8 * i);
+    v = T(x);
+    return true;
+}
+
+inline block_codec compress_block(const char* data, size_t size,
+                                  std::string& out)
+{
+    out.clear();
+#ifdef HAVE_ZSTD
+    out.resize(ZSTD_compressBound(size));
+    size_t r = ZSTD_compress(&out[0], out.size(), data, size, 3);
+    if (ZSTD_isError(r))
+        throw IOException(std::string("error compressing block: ") +
+                          ZSTD_getErrorName(r));
+    out.resize(r);
+    block_codec codec = block_codec::Zstd;
+#else
+    boost::iostreams::filtering_ostream os;
+    os.push(boost::iostreams::zlib_compressor());
+    os.push(boost::iostreams::back_inserter(out));
+    os.write(data, size);
+    os.reset();
+    block_codec codec = block_codec::Zlib;
+#endif
+    if (out.size() >= size)
+    {
+        out.assign(data, size);
+        codec = block_codec::None;
+    }
+    return codec;
+}
+
+inline void decompress_block(block_codec codec, const std::string& in,
+                             char* out, size_t size)
+{
+    switch (codec)
+    {
+    case block_codec::None:
+        if (in.size() != size)
+            throw IOException("error decompressing block: invalid size");
+        std::copy(in.begin(), in.end(), out);
+        break;
+    case block_codec::Zlib:
+        {
+            boost::iostreams::filtering_istream is;
+            is.push(boost::iostreams::zlib_decompressor());
+            is.push(boost::iostreams::array_source(in.data(), in.size()));
+            is.read(out, size);
+            if (size_t(is.gcount()) != size)
+                throw IOException("error decompressing block: invalid size");
+        }
+        break;
+    case block_codec::Zstd:
+#ifdef HAVE_ZSTD
+        {
+            size_t r = ZSTD_decompress(out, size, in.data(), in.size());
+            if (ZSTD_isError(r))
+                throw IOException(std::string("error decompressing block: ") +
+                                  ZSTD_getErrorName(r));
+            if (r != size)
+                throw IOException("error decompressing block: invalid size");
+        }
+        break;
+#else
+        throw IOException("error decompressing block: zstd support was not "
+                          "enabled during compilation");
+#endif
+    default:
+        throw IOException("error decompressing block: invalid codec " +
+                          std::to_string(int(codec)));
+    }
+}
+
+// Output stream buffer which accumulates a batch of blocks, compresses them in
+// parallel, and writes them to the underlying stream buffer. The stream must
+// be terminated with close().
+
+class block_compress_streambuf: public std::streambuf
+{
+public:
+    block_compress_streambuf(std::streambuf* sb)
+        : _sb(sb), _buf(_block_size * get_block_batch())
+    {
+        setp(_buf.data(), _buf.data() + _buf.size());
+    }
+
+    void close()
+    {
+        flush_batch();
+        write_le(*_sb, uint8_t(block_codec::None));
+        write_le(*_sb, uint64_t(0));
+        write_le(*_sb, uint64_t(0));
+        _sb->pubsync();
+    }
+
+protected:
+    int_type overflow(int_type c)
+    {
+        flush_batch();
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    void flush_batch()
+    {
+        size_t n = pptr() - pbase();
+        size_t nblocks = (n + _block_size - 1) / _block_size;
+        std::vector<std::string> out(nblocks);
+        std::vector<block_codec> codecs(nblocks);
+        std::string err;
+
+        #pragma omp parallel for schedule(dynamic, 1) if (nblocks > 1)
+        for (size_t i = 0; i < nblocks; ++i)
+        {
+            try
+            {
+                size_t pos = i * _block_size;
+                codecs[i] = compress_block(pbase() + pos,
+                                           std::min(_block_size, n - pos),
+                                           out[i]);
+            }
+            catch (std::exception& e)
+            {
+                #pragma omp critical (block_compress)
+                err = e.what();
+            }
+        }
+
+        if (!err.empty())
+            throw IOException(err);
+
+        for (size_t i = 0; i < nblocks; ++i)
+        {
+            size_t pos = i * _block_size;
+            write_le(*_sb, uint8_t(codecs[i]));
+            write_le(*_sb, uint64_t(std::min(_block_size, n - pos)));
+            write_le(*_sb, uint64_t(out[i].size()));
+            if (_sb->sputn(out[i].data(), out[i].size()) !=
+                std::streamsize(out[i].size()))
+                throw IOException("error writing block: output error");
+        }
+
+        setp(_buf.data(), _buf.data() + _buf.size());
+    }
+
+    std::streambuf* _sb;
+    std::vector<char> _buf;
+};
+
+// Input stream buffer which reads a batch of blocks from the underlying stream
+// buffer and decompresses them in parallel.
+
+class block_decompress_streambuf: public std::streambuf
+{
+public:
+    block_decompress_streambuf(std::streambuf* sb)
+        : _sb(sb), _done(false)
+    {
+        setg(nullptr, nullptr, nullptr);
+    }
+
+protected:
+    int_type underflow()
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        if (_done || !read_batch())
+            return traits_type::eof();
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    bool read_batch()
+    {
+        size_t nbatch = get_block_batch();
+        std::vector<std::string> in;
+        std::vector<block_codec> codecs;
+        std::vector<size_t> pos = {0};
+        while (in.size() < nbatch)
+        {
+            uint8_t codec;
+            uint64_t size, csize;
+            if (!read_le(*_sb, codec) || !read_le(*_sb, size) ||
+                !read_le(*_sb, csize))
+                throw IOException("error reading block: unexpected end of file");
+            if (size == 0)
+            {
+                _done = true;
+                break;
+            }
+            if (size > _block_size || csize > 2 * _block_size)
+                throw IOException("error reading block: invalid block size");
+            in.emplace_back(csize, '\0');
+            if (csize > 0 &&
+                _sb->sgetn(&in.back()[0], csize) != std::streamsize(csize))
+                throw IOException("error reading block: unexpected end of file");
+            codecs.push_back(block_codec(codec));
+            pos.push_back(pos.back() + size);
+        }
+
+        size_t nblocks = in.size();
+        _buf.resize(pos.back());
+        std::string err;
+
+        #pragma omp parallel for schedule(dynamic, 1) if (nblocks > 1)
+        for (size_t i = 0; i < nblocks; ++i)
+        {
+            try
+            {
+                decompress_block(codecs[i], in[i], _buf.data() + pos[i],
+                                 pos[i + 1] - pos[i]);
+            }
+            catch (std::exception& e)
+            {
+                #pragma omp critical (block_decompress)
+                err = e.what();
+            }
+        }
+
+        if (!err.empty())
+            throw IOException(err);
+
+        setg(_buf.data(), _buf.data(), _buf.data() + _buf.size());
+        return !_buf.empty();
+    }
+
+    std::streambuf* _sb;
+    std::vector<char> _buf;
+    bool _done;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_BLOCK_HH
@@ -0,0 +1,584 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_util.hh"
+#include "graph_python_interface.hh"
+#include "hash_map_wrap.hh"
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <fstream>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+namespace graph_tool
+{
+
+// Native reader of delimited edge lists (e.g. CSV or TSV files, optionally
+// compressed). The input is read in large chunks, which are split at line
+// boundaries and parsed in parallel. Hashed vertex names are resolved in a
+// table which is sharded by the hash value, where each shard is updated by a
+// single thread, so that no locking is necessary. New names receive vertex
+// indexes in the order in which they first appear in the file, exactly as with
+// Graph.add_edge_list().
+
+struct edge_list_format
+{
+    char delim;          // '\0' means runs of spaces or tabs
+    char quote;          // '\0' disables quoting
+    char comment;        // '\0' disables comments
+    size_t scol;
+    size_t tcol;
+    size_t ncols;         // number of columns in every row
+    vector<size_t> pcols; // columns of the edge properties
+
+    bool is_delim(char c) const
+    {
+        if (delim == '\0')
+            return c == ' ' || c == '\t';
+        return c == delim;
+    }
+
+    // lines with only whitespace are skipped, as in the python peek at the
+    // first row
+    static bool is_blank(const char* b, const char* e)
+    {
+        return std::all_of(b, e, [](char c)
+                                 { return c == ' ' || c == '\t' ||
+                                          c == '\r'; });
+    }
+};
+
+// split the line [b, e) into fields, following the same quoting conventions as
+// python's csv module (quoted fields may contain delimiters, and quotes are
+// escaped by doubling them), except that quoted fields may not span several
+// lines
+void split_line(const char* b, const char* e, const edge_list_format& fmt,
+                vector<string>& fields)
+{
+    fields.clear();
+    if (e > b && e[-1] == '\r')
+        --e;
+    const char* p = b;
+    if (fmt.delim == '\0')
+    {
+        while (p < e && fmt.is_delim(*p))
+            ++p;
+    }
+    while (true)
+    {
+        fields.emplace_back();
+        auto& f = fields.back();
+        if (fmt.quote != '\0' && p < e && *p == fmt.quote)
+        {
+            ++p;
+            while (p < e)
+            {
+                if (*p == fmt.quote)
+                {
+                    if (p + 1 < e && p[1] == fmt.quote)
+                    {
+                        f.push_back(fmt.quote);
+                        p += 2;
+                        continue;
+                    }
+                    ++p;
+                    break;
+                }
+                f.push_back(*p++);
+            }
+        }
+        while (p < e && !fmt.is_delim(*p))
+            f.push_back(*p++);
+        if (p >= e)
+            break;
+        ++p;
+        if (fmt.delim == '\0')
+        {
+            while (p < e && fmt.is_delim(*p))
+                ++p;
+            if (p >= e)
+                break;
+        }
+    }
+}
+
+bool parse_index(const string& val, size_t& idx)
+{
+    auto b = val.begin();
+    auto e = val.end();
+    while (b != e && (*b == ' ' || *b == '\t'))
+        ++b;
+    while (b != e && (e[-1] == ' ' || e[-1] == '\t'))
+        --e;
+    if (b == e)
+        return false;
+    idx = 0;
+    for (; b != e; ++b)
+    {
+        if (*b < '0' || *b > '9')
+            return false;
+        idx = idx * 10 + (*b - '0');
+    }
+    return true;
+}
+
+// the rows of a chunk, as parsed by a single thread
+struct edge_list_rows
+{
+    vector<string> names;    // source and target names (if hashed)
+    vector<size_t> idxs;     // source and target indexes (if not hashed)
+    vector<string> vals;     // property values
+    vector<size_t> nvals;    // number of property values present in each row
+    string error;
+};
+
+class edge_list_reader
+{
+public:
+    edge_list_reader(const edge_list_format& fmt, bool hashed)
+        : _fmt(fmt), _hashed(hashed)
+    {
+#ifdef USING_OPENMP
+        _nthreads = omp_get_max_threads();
+#else
+        _nthreads = 1;
+#endif
+        if (_hashed)
+            _shards.resize(4 * _nthreads);
+    }
+
+    template <class Graph>
+    void operator()(Graph& g, std::istream& s, bool skip_first,
+                    boost::any& avnames, python::object& oeprops)
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        vector<DynamicPropertyMapWrap<string, edge_t>> eprops;
+        python::stl_input_iterator<boost::any> piter(oeprops), pend;
+        for (; piter != pend; ++piter)
+        {
+            typedef eprop_map_t<python::object>::type obj_map_t;
+            if (piter->type() == typeid(obj_map_t))
+                throw ValueException("Edge property maps of type 'object' are "
+                                     "not supported by the native reader");
+            eprops.emplace_back(*piter, writable_edge_properties());
+        }
+        if (eprops.size() > _fmt.pcols.size())
+            throw ValueException("Too many edge property maps given");
+
+        DynamicPropertyMapWrap<string, vertex_t> vnames;
+        if (_hashed)
+            vnames = DynamicPropertyMapWrap<string, vertex_t>
+                (avnames, writable_vertex_properties());
+
+        size_t chunk_size = 1 << 24;
+        string buf, rest;
+        bool first = true;
+        while (true)
+        {
+            buf.swap(rest);
+            size_t old = buf.size();
+            buf.resize(old + chunk_size);
+            s.read(&buf[old], chunk_size);
+            size_t n = s.gcount();
+            buf.resize(old + n);
+            bool eof = n < chunk_size;
+
+            size_t end = buf.size();
+            if (!eof)
+            {
+                end = buf.rfind('\n');
+                if (end == string::npos)
+                {
+                    // line longer than the chunk; keep reading
+                    rest.swap(buf);
+                    continue;
+                }
+                end++;
+            }
+            rest.assign(buf, end, string::npos);
+
+            const char* b = buf.data();
+            const char* e = buf.data() + end;
+            if (first && skip_first)
+            {
+                b = std::find(b, e, '\n');
+                if (b < e)
+                    ++b;
+            }
+            first = false;
+
+            parse_chunk(b, e, eprops.size());
+            add_chunk(g, vnames, eprops);
+
+            if (eof)
+                break;
+        }
+    }
+
+private:
+    void parse_chunk(const char* b, const char* e, size_t nprops)
+    {
+        size_t nparts = _nthreads;
+        vector<const char*> bounds(nparts + 1, e);
+        bounds[0] = b;
+        for (size_t i = 1; i < nparts; ++i)
+        {
+            const char* p = b + (e - b) * i / nparts;
+            p = std::max(p, bounds[i - 1]);
+            p = std::find(p, e, '\n');
+            bounds[i] = (p < e) ? p + 1 : e;
+        }
+
+        _parts.clear();
+        _parts.resize(nparts);
+
+        #pragma omp parallel for schedule(static, 1) if (nparts > 1)
+        for (size_t i = 0; i < nparts; ++i)
+            parse_part(bounds[i], bounds[i + 1], nprops, _parts[i]);
+
+        for (auto& part : _parts)
+        {
+            if (!part.error.empty())
+                throw ValueException(part.error);
+        }
+    }
+
+    void parse_part(const char* b, const char* e, size_t nprops,
+                    edge_list_rows& rows)
+    {
+        vector<string> fields;
+        size_t mcol = std::max(_fmt.scol, _fmt.tcol);
+        while (b < e)
+        {
+            const char* le = std::find(b, e, '\n');
+            const char* lb = b;
+            b = (le < e) ? le + 1 : e;
+
+            if (edge_list_format::is_blank(lb, le))
+                continue;
+            if (_fmt.comment != '\0' && *lb == _fmt.comment)
+                continue;
+
+            split_line(lb, le, _fmt, fields);
+            if (fields.size() <= mcol)
+            {
+                rows.error = "Invalid line in edge list (not enough columns): " +
+                    string(lb, le);
+                return;
+            }
+            if (fields.size() != _fmt.ncols)
+            {
+                rows.error = "Invalid line in edge list (expected " +
+                    lexical_cast<string>(_fmt.ncols) + " columns, found " +
+                    lexical_cast<string>(fields.size()) + "): " +
+                    string(lb, le);
+                return;
+            }
+
+            for (auto col : {_fmt.scol, _fmt.tcol})
+            {
+                if (_hashed)
+                {
+                    rows.names.push_back(std::move(fields[col]));
+                }
+                else
+                {
+                    size_t idx;
+                    if (!parse_index(fields[col], idx))
+                    {
+                        rows.error = "Invalid vertex index in edge list: " +
+                            fields[col];
+                        return;
+                    }
+                    rows.idxs.push_back(idx);
+                }
+            }
+
+            size_t k = 0;
+            for (size_t i = 0; i < nprops; ++i)
+            {
+                size_t col = _fmt.pcols[i];
+                if (col < fields.size())
+                {
+                    rows.vals.push_back(std::move(fields[col]));
+                    k++;
+                }
+                else
+                {
+                    rows.vals.emplace_back();
+                }
+            }
+            rows.nvals.push_back(k);
+        }
+    }
+
+    // map the names of this chunk to vertex indexes, adding the new vertices
+    template <class Graph, class VNames>
+    void resolve_names(Graph& g, VNames& vnames, vector<size_t>& vs)
+    {
+        const size_t new_flag = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+        vector<string*> names;
+        for (auto& part : _parts)
+            for (auto& name : part.names)
+                names.push_back(&name);
+
+        size_t M = names.size();
+        size_t S = _shards.size();
+        vector<size_t> shard(M);
+
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+            shard[i] = boost::hash_range(names[i]->begin(),
+                                         names[i]->end()) % S;
+
+        // stable counting sort of the positions by shard
+        vector<size_t> sbegin(S + 1, 0);
+        for (size_t i = 0; i < M; ++i)
+            sbegin[shard[i] + 1]++;
+        for (size_t j = 0; j < S; ++j)
+            sbegin[j + 1] += sbegin[j];
+        vector<size_t> order(M);
+        {
+            vector<size_t> spos(sbegin.begin(), sbegin.end() - 1);
+            for (size_t i = 0; i < M; ++i)
+                order[spos[shard[i]]++] = i;
+        }
+
+        vs.resize(M);
+        vector<vector<size_t>> new_pos(S);
+
+        #pragma omp parallel for schedule(dynamic, 1) if (S > 1)
+        for (size_t j = 0; j < S; ++j)
+        {
+            auto& h = _shards[j];
+            for (size_t k = sbegin[j]; k < sbegin[j + 1]; ++k)
+            {
+                size_t i = order[k];
+                auto iter = h.find(*names[i]);
+                if (iter == h.end())
+                {
+                    h[*names[i]] = vs[i] = new_flag | i;
+                    new_pos[j].push_back(i);
+                }
+                else
+                {
+                    vs[i] = iter->second;
+                }
+            }
+        }
+
+        // new vertices are numbered in the order of their first appearance
+        vector<size_t> first;
+        for (auto& ps : new_pos)
+            first.insert(first.end(), ps.begin(), ps.end());
+        std::sort(first.begin(), first.end());
+
+        size_t N = num_vertices(g);
+        for (size_t i = 0; i < first.size(); ++i)
+            add_vertex(g);
+
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+        {
+            if (vs[i] & new_flag)
+            {
+                size_t pos = vs[i] & ~new_flag;
+                vs[i] = N + (std::lower_bound(first.begin(), first.end(), pos) -
+                             first.begin());
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic, 1) if (S > 1)
+        for (size_t j = 0; j < S; ++j)
+        {
+            auto& h = _shards[j];
+            for (auto i : new_pos[j])
+                h[*names[i]] = vs[i];
+        }
+
+        if (first.empty())
+            return;
+
+        // grow the storage beforehand, so that it can be written in parallel
+        vnames.get(vertex(num_vertices(g) - 1, g));
+
+        string error;
+        size_t nnew = first.size();
+        #pragma omp parallel for schedule(runtime) if (nnew > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < nnew; ++i)
+        {
+            auto& name = *names[first[i]];
+            try
+            {
+                vnames.put(vertex(N + i, g), name);
+            }
+            catch (bad_lexical_cast&)
+            {
+                #pragma omp critical (edge_list_error)
+                error = "Invalid vertex name: " + name;
+            }
+        }
+        if (!error.empty())
+            throw ValueException(error);
+    }
+
+    template <class Graph, class VNames, class EProps>
+    void add_chunk(Graph& g, VNames& vnames, EProps& eprops)
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+        vector<size_t> vs;
+        if (_hashed)
+        {
+            resolve_names(g, vnames, vs);
+        }
+        else
+        {
+            for (auto& part : _parts)
+                vs.insert(vs.end(), part.idxs.begin(), part.idxs.end());
+            if (!vs.empty())
+            {
+                size_t max_v = *std::max_element(vs.begin(), vs.end());
+                while (max_v >= num_vertices(g))
+                    add_vertex(g);
+            }
+        }
+
+        size_t E = vs.size() / 2;
+        vector<edge_t> es(E);
+        for (size_t i = 0; i < E; ++i)
+            es[i] = add_edge(vertex(vs[2 * i], g), vertex(vs[2 * i + 1], g),
+                             g).first;
+
+        if (eprops.empty() || E == 0)
+            return;
+
+        vector<pair<string*, size_t>> vals; // (values, number present)
+        for (auto& part : _parts)
+            for (size_t r = 0; r < part.nvals.size(); ++r)
+                vals.emplace_back(&part.vals[r * eprops.size()],
+                                  part.nvals[r]);
+
+        auto eindex = get(edge_index_t(), g);
+        auto e_max = *std::max_element(es.begin(), es.end(),
+                                       [&](auto& a, auto& b)
+                                       { return eindex[a] < eindex[b]; });
+
+        string error;
+        for (auto& ep : eprops)
+        {
+            // grow the storage beforehand, so that it can be written in
+            // parallel
+            ep.get(e_max);
+
+            size_t k = &ep - &eprops[0];
+            #pragma omp parallel for schedule(runtime) if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < E; ++i)
+            {
+                if (k >= vals[i].second)
+                    continue;
+                auto& val = vals[i].first[k];
+                try
+                {
+                    ep.put(es[i], val);
+                }
+                catch (bad_lexical_cast&)
+                {
+                    #pragma omp critical (edge_list_error)
+                    error = "Invalid edge property value: " + val;
+                }
+            }
+            if (!error.empty())
+                throw ValueException(error);
+        }
+    }
+
+    edge_list_format _fmt;
+    bool _hashed;
+    size_t _nthreads;
+    vector<edge_list_rows> _parts;
+    vector<gt_hash_map<string, size_t>> _shards;
+};
+
+void do_read_edge_list(GraphInterface& gi, string file, string delim,
+                       string quote, string comment, bool skip_first,
+                       size_t scol, size_t tcol, size_t ncols,
+                       boost::any avnames, python::object eprops)
+{
+    if (delim.size() > 1 || quote.size() > 1 || comment.size() > 1)
+        throw ValueException("Delimiter, quote and comment characters must "
+                             "be single characters");
+
+    edge_list_format fmt;
+    fmt.delim = delim.empty() ? '\0' : delim[0];
+    fmt.quote = quote.empty() ? '\0' : quote[0];
+    fmt.comment = comment.empty() ? '\0' : comment[0];
+    fmt.scol = scol;
+    fmt.tcol = tcol;
+    fmt.ncols = ncols;
+    for (size_t i = 0; i < std::max(ncols, std::max(scol, tcol) + 1); ++i)
+    {
+        if (i != scol && i != tcol)
+            fmt.pcols.push_back(i);
+    }
+
+    bool hashed = !avnames.empty();
+
+    boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+    std::ifstream file_stream;
+    file_stream.open(file.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file_stream.is_open())
+        throw IOException("error opening file '" + file + "'");
+    if (boost::ends_with(file, ".gz"))
+        stream.push(boost::iostreams::gzip_decompressor());
+    if (boost::ends_with(file, ".bz2"))
+        stream.push(boost::iostreams::bzip2_decompressor());
+    stream.push(file_stream);
+    stream.exceptions(ios_base::badbit);
+
+    edge_list_reader reader(fmt, hashed);
+    try
+    {
+        run_action<>()(gi, [&](auto& g)
+                       { reader(g, stream, skip_first, avnames, eprops); })();
+    }
+    catch (ios_base::failure& e)
+    {
+        throw IOException("error reading from file '" + file + "': " +
+                          e.what());
+    }
+}
+
+} // namespace graph_tool
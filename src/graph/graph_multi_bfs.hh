@@ -0,0 +1,307 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_MULTI_BFS_HH
+#define GRAPH_MULTI_BFS_HH
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <limits>
+
+#include <unistd.h>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Multi-source breadth-first search
+// ---------------------------------
+//
+// Unweighted BFS from up to 64 * Words sources at once, following the MS-BFS
+// algorithm of [then-more-2014]. Each vertex holds three bitsets, with one bit
+// per source: the sources that have already reached it, the ones for which it
+// is in the current frontier, and the ones for which it is in the next
+// one. Each level is a single pass over the frontier vertices, in which the
+// out-neighbours of a vertex are visited only once for all the sources that
+// share it in their frontier. The frontier is kept as an explicit list, and
+// all vertices are scanned in order only when it is large, so that the cost
+// of a level is proportional to the size of the frontier, as with an ordinary
+// BFS, regardless of the diameter of the graph.
+//
+// The bitset operations are loops over fixed-size arrays of 64-bit words,
+// which the compiler turns into SIMD instructions when they are available. The
+// memory footprint is 24 * Words bytes per vertex, plus the frontier lists,
+// and is allocated only once per instance, so it should be reused for many
+// batches of sources (e.g. one instance per thread, as done by
+// multi_source_bfs_batches() below).
+//
+// [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, et al., "The More the
+//                  Merrier: Efficient Multi-Source Graph Traversal", PVLDB
+//                  8(4), 2014.
+
+template <size_t Words = 4>
+class multi_source_bfs
+{
+public:
+    static constexpr size_t width = 64 * Words;
+    typedef std::array<uint64_t, Words> bitset_t;
+
+    template <class Graph>
+    multi_source_bfs(const Graph& g)
+        : _seen(num_vertices(g)), _visit(num_vertices(g)),
+          _next(num_vertices(g)) {}
+
+    // Runs the search from the sources in the range [begin, end), which must
+    // contain at most "width" vertices, and calls f(v, bits, d) for every
+    // vertex v reached for the first time at distance d > 0, where bit i of
+    // "bits" is set if v is at distance d from the i-th source.
+    template <class Graph, class Iter, class F>
+    void run(const Graph& g, Iter begin, Iter end, F&& f)
+    {
+        bitset_t zero;
+        zero.fill(0);
+
+        // _visit and _next are always left empty at the end of a search
+        std::fill(_seen.begin(), _seen.end(), zero);
+        _frontier.clear();
+
+        size_t i = 0;
+        for (auto s = begin; s != end; ++s, ++i)
+        {
+            if (!any(_visit[*s]))
+                _frontier.push_back(*s);
+            _seen[*s][i / 64] |= uint64_t(1) << (i % 64);
+            _visit[*s][i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        size_t N = num_vertices(g);
+        size_t d = 0;
+        while (!_frontier.empty())
+        {
+            ++d;
+            _next_frontier.clear();
+
+            // If a large fraction of the vertices is in the frontier, it is
+            // faster to scan all of them in order. Otherwise only the list of
+            // frontier vertices is traversed, and the vertices of the next
+            // frontier are collected as they are reached.
+            if (_frontier.size() > N / 16)
+            {
+                for (auto v : vertices_range(g))
+                {
+                    auto& visit = _visit[v];
+                    if (!any(visit))
+                        continue;
+                    for (auto u : adjacent_vertices_range(v, g))
+                    {
+                        auto& next = _next[u];
+                        auto& seen = _seen[u];
+                        for (size_t j = 0; j < Words; ++j)
+                            next[j] |= visit[j] & ~seen[j];
+                    }
+                }
+
+                for (auto v : vertices_range(g))
+                {
+                    if (any(_next[v]))
+                        _next_frontier.push_back(v);
+                    else
+                        _visit[v] = zero;
+                }
+            }
+            else
+            {
+                for (auto v : _frontier)
+                {
+                    auto& visit = _visit[v];
+                    for (auto u : adjacent_vertices_range(v, g))
+                    {
+                        auto& next = _next[u];
+                        auto& seen = _seen[u];
+                        bitset_t reach;
+                        uint64_t x = 0, y = 0;
+                        for (size_t j = 0; j < Words; ++j)
+                        {
+                            reach[j] = visit[j] & ~seen[j];
+                            x |= reach[j];
+                            y |= next[j];
+                        }
+                        if (x == 0)
+                            continue;
+                        if (y == 0)
+                            _next_frontier.push_back(u);
+                        for (size_t j = 0; j < Words; ++j)
+                            next[j] |= reach[j];
+                    }
+                }
+
+                for (auto v : _frontier)
+                    _visit[v] = zero;
+            }
+
+            for (auto v : _next_frontier)
+            {
+                auto& next = _next[v];
+                auto& seen = _seen[v];
+                for (size_t j = 0; j < Words; ++j)
+                    seen[j] |= next[j];
+                f(v, next, d);
+                _visit[v] = next;
+                next = zero;
+            }
+
+            _frontier.swap(_next_frontier);
+        }
+    }
+
+    static bool any(const bitset_t& bits)
+    {
+        uint64_t x = 0;
+        for (size_t j = 0; j < Words; ++j)
+            x |= bits[j];
+        return x != 0;
+    }
+
+    static size_t count(const bitset_t& bits)
+    {
+        size_t c = 0;
+        for (size_t j = 0; j < Words; ++j)
+            c += __builtin_popcountll(bits[j]);
+        return c;
+    }
+
+    // calls f(i) for every bit i that is set
+    template <class F>
+    static void for_each_bit(const bitset_t& bits, F&& f)
+    {
+        for (size_t j = 0; j < Words; ++j)
+        {
+            uint64_t x = bits[j];
+            while (x != 0)
+            {
+                f(64 * j + __builtin_ctzll(x));
+                x &= x - 1;
+            }
+        }
+    }
+
+private:
+    std::vector<bitset_t> _seen;
+    std::vector<bitset_t> _visit;
+    std::vector<bitset_t> _next;
+    std::vector<size_t> _frontier;
+    std::vector<size_t> _next_frontier;
+};
+
+namespace detail
+{
+
+// Number of 64-bit words per bitset used by multi_source_bfs_batches(). The
+// widest bitsets (i.e. the largest batches) are chosen for which there are
+// still at least as many batches as threads, and for which the bitsets of all
+// threads take at most a quarter of the physical memory.
+inline size_t get_multi_bfs_words(size_t N, size_t n_sources, size_t nthreads)
+{
+    size_t max_mem = std::numeric_limits<size_t>::max();
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0)
+        max_mem = size_t(pages) * size_t(page_size) / 4;
+#endif
+
+    size_t words = 4;
+    while (words > 1 &&
+           (n_sources < 64 * words * nthreads ||
+            N * nthreads * 3 * sizeof(uint64_t) * words > max_mem))
+        words /= 2;
+    return words;
+}
+
+template <size_t Words, class Graph, class Vertex, class F>
+void multi_source_bfs_batches_no_spawn(const Graph& g,
+                                       const std::vector<Vertex>& sources,
+                                       size_t nthreads, F&& f)
+{
+    typedef multi_source_bfs<Words> bfs_t;
+    size_t n = sources.size();
+
+    // if there are too few sources to keep all threads busy, the batches are
+    // made smaller, down to a single source per batch (i.e. an ordinary BFS)
+    size_t width = std::min(bfs_t::width, (n + nthreads - 1) / nthreads);
+    width = std::max(width, size_t(1));
+    size_t n_batches = (n + width - 1) / width;
+
+    // allocated only by the threads that get a batch
+    std::unique_ptr<bfs_t> bfs;
+    #pragma omp for schedule(runtime)
+    for (size_t b = 0; b < n_batches; ++b)
+    {
+        if (!bfs)
+            bfs.reset(new bfs_t(g));
+        auto begin = sources.begin() + b * width;
+        auto end = sources.begin() + std::min(n, (b + 1) * width);
+        f(*bfs, begin, end);
+    }
+}
+
+} // namespace detail
+
+// Calls f(bfs, begin, end) for consecutive batches of vertices of the given
+// list, distributed among the threads of the enclosing parallel region, with
+// one multi_source_bfs instance per thread. Each batch contains at most
+// bfs.width vertices, where the type of "bfs" (and hence its width) is chosen
+// at run time with detail::get_multi_bfs_words(), so "f" must be generic.
+template <class Graph, class Vertex, class F>
+void multi_source_bfs_batches_no_spawn(const Graph& g,
+                                       const std::vector<Vertex>& sources,
+                                       F&& f)
+{
+    size_t nthreads = 1;
+#ifdef USING_OPENMP
+    nthreads = omp_get_num_threads();
+#endif
+    switch (detail::get_multi_bfs_words(num_vertices(g), sources.size(),
+                                        nthreads))
+    {
+    case 4:
+        detail::multi_source_bfs_batches_no_spawn<4>(g, sources, nthreads, f);
+        break;
+    case 2:
+        detail::multi_source_bfs_batches_no_spawn<2>(g, sources, nthreads, f);
+        break;
+    default:
+        detail::multi_source_bfs_batches_no_spawn<1>(g, sources, nthreads, f);
+    }
+}
+
+template <class Graph, class Vertex, class F>
+void multi_source_bfs_batches(const Graph& g, const std::vector<Vertex>& sources,
+                              F&& f)
+{
+    #pragma omp parallel if (num_vertices(g) * sources.size() > \
+                             OPENMP_MIN_THRESH)
+    multi_source_bfs_batches_no_spawn(g, sources, f);
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_MULTI_BFS_HH
@@ -16,6 +16,7 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "graph.hh"
+#include "graph_util.hh"
 
 #include <boost/python.hpp>
 
@@ -28,6 +29,30 @@ using namespace graph_tool;
 #include <omp.h>
 #endif
 
+// global scheduling of parallel_vertex_loop() and parallel_edge_loop(), see
+// graph_util.hh
+namespace graph_tool
+{
+static loop_schedule _loop_schedule = loop_schedule::runtime;
+static size_t _loop_chunk = 0;
+
+loop_schedule get_loop_schedule()
+{
+    return _loop_schedule;
+}
+
+size_t get_loop_chunk()
+{
+    return _loop_chunk;
+}
+
+void set_loop_schedule(loop_schedule sched, size_t chunk)
+{
+    _loop_schedule = sched;
+    _loop_chunk = chunk;
+}
+}
+
 bool openmp_enabled()
 {
 #ifdef USING_OPENMP
@@ -58,6 +83,9 @@ void openmp_set_num_threads(int n)
 python::tuple openmp_get_schedule()
 {
 #ifdef USING_OPENMP
+    if (get_loop_schedule() == loop_schedule::degree)
+        return python::make_tuple("degree", get_loop_chunk());
+
     omp_sched_t kind;
     int chunk;
     omp_get_schedule(&kind, &chunk);
@@ -89,6 +117,14 @@ python::tuple openmp_get_schedule()
 void openmp_set_schedule(string skind, int chunk)
 {
 #ifdef USING_OPENMP
+    if (skind == "degree")
+    {
+        if (chunk < 0)
+            throw ValueException("Invalid chunk size: " + lexical_cast<string>(chunk));
+        set_loop_schedule(loop_schedule::degree, chunk);
+        return;
+    }
+
     omp_sched_t kind;
     if (skind == "static")
         kind = omp_sched_static;
@@ -101,6 +137,7 @@ void openmp_set_schedule(string skind, int chunk)
     else
         throw GraphException("Unknown schedule type: " + skind);
     omp_set_schedule(kind, chunk);
+    set_loop_schedule(loop_schedule::runtime, 0);
 #else
     throw GraphException("OpenMP was not enabled during compilation");
 #endif
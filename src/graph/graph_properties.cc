@@ -51,12 +51,23 @@ struct do_shift_vertex_property
         try
         {
             PropertyMap pmap = any_cast<PropertyMap>(map);
-            size_t back = num_vertices(g) - 1;
+            size_t N = num_vertices(g);
+            vector<bool> deleted(N, false);
+            size_t vmin = N;
             for (auto v : vi)
             {
-                for (size_t i = v; i < back; ++i)
-                    pmap[vertex(i, g)] = pmap[vertex(i + 1, g)];
-                back--;
+                deleted[v] = true;
+                vmin = std::min(vmin, size_t(v));
+            }
+
+            // compact the remaining values in a single pass
+            size_t j = vmin;
+            for (size_t i = vmin; i < N; ++i)
+            {
+                if (deleted[i])
+                    continue;
+                pmap[vertex(j, g)] = pmap[vertex(i, g)];
+                ++j;
             }
             found = true;
         }
@@ -148,6 +159,59 @@ void GraphInterface::re_index_vertex_property(boost::any map,
 
 }
 
+// resets the edge indexes to a contiguous range, and returns the previous
+// index of each edge
+python::object GraphInterface::re_index_edges()
+{
+    vector<size_t> old_index;
+    _mg->reindex_edges(&old_index);
+    return wrap_vector_owned(old_index);
+}
+
+struct reindex_edge_property
+{
+    template <class PropertyMap, class IndexMap>
+    void operator()(PropertyMap, boost::any map, IndexMap& old_index,
+                    bool& found) const
+    {
+        try
+        {
+            PropertyMap pmap = any_cast<PropertyMap>(map);
+            auto& vals = pmap.get_storage();
+            typename std::remove_reference<decltype(vals)>::type
+                old_vals(old_index.size());
+            vals.swap(old_vals);
+            vals.resize(old_index.size());
+
+            size_t E = old_index.size();
+            #pragma omp parallel for default(shared) schedule(runtime) \
+                if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < E; ++i)
+            {
+                size_t j = old_index[i];
+                if (j < old_vals.size())
+                    vals[i] = old_vals[j];
+            }
+            found = true;
+        }
+        catch (bad_any_cast&) {}
+    }
+};
+
+// permutes the values of an edge property map after the edges have been
+// re-indexed with re_index_edges()
+void GraphInterface::re_index_edge_property(boost::any map,
+                                            python::object oold_index) const
+{
+    auto old_index = get_array<uint64_t,1>(oold_index);
+    bool found = false;
+    mpl::for_each<writable_edge_properties>
+        (std::bind(reindex_edge_property(), std::placeholders::_1, map,
+                   std::ref(old_index), std::ref(found)));
+    if (!found)
+        throw GraphException("invalid writable property map");
+}
+
 } // graph_tool namespace
 
 
@@ -19,6 +19,7 @@
 #include "graph.hh"
 #include "graph_util.hh"
 #include "graph_python_interface.hh"
+#include "hash_map_wrap.hh"
 
 #include <boost/python.hpp>
 #include <boost/python/stl_iterator.hpp>
@@ -166,8 +167,11 @@ void remove_vertex_array(GraphInterface& gi, const python::object& oindex, bool
     }
     else
     {
+        // remove all vertices in a single O(V + E) pass
+        vector<bool> deleted(num_vertices(g), false);
         for (auto v : index)
-            remove_vertex(vertex(v, g), g);
+            deleted[v] = true;
+        remove_vertices([&](auto v) { return deleted[v]; }, g);
     }
 }
 
@@ -243,6 +247,137 @@ void remove_edge(GraphInterface& gi, const python::object& e)
         throw ValueException("invalid edge descriptor");
 }
 
+// Finds the edges corresponding to the (source, target) pairs in the rows of
+// elist, which are grouped by source, so that the edges of each vertex are
+// traversed only once.
+struct find_edge_list
+{
+    template <class Graph>
+    void operator()(Graph& g, multi_array_ref<int64_t,2>& elist,
+                    vector<GraphInterface::edge_t>& es) const
+    {
+        size_t M = elist.shape()[0];
+        vector<size_t> rows(M);
+        std::iota(rows.begin(), rows.end(), 0);
+        std::sort(rows.begin(), rows.end(),
+                  [&](size_t i, size_t j)
+                  {
+                      return std::make_pair(elist[i][0], elist[i][1]) <
+                          std::make_pair(elist[j][0], elist[j][1]);
+                  });
+
+        vector<size_t> groups;
+        for (size_t i = 0; i < M; ++i)
+        {
+            if (i == 0 || elist[rows[i]][0] != elist[rows[i - 1]][0])
+                groups.push_back(i);
+        }
+        groups.push_back(M);
+
+        es.resize(M);
+        vector<uint8_t> found(M, false);
+        size_t NG = groups.size() - 1;
+        auto& u = get_dir(g, typename is_directed::apply<Graph>::type());
+
+        #pragma omp parallel for default(shared) schedule(runtime) \
+            if (NG > OPENMP_MIN_THRESH)
+        for (size_t j = 0; j < NG; ++j)
+        {
+            size_t s = elist[rows[groups[j]]][0];
+            if (s >= num_vertices(g) || !is_valid_vertex(vertex(s, g), g))
+                continue;
+
+            // next row to be matched for each target
+            gt_hash_map<size_t, size_t> next;
+            for (size_t i = groups[j]; i < groups[j + 1]; ++i)
+            {
+                size_t t = elist[rows[i]][1];
+                if (next.find(t) == next.end())
+                    next[t] = i;
+            }
+
+            auto match = [&](auto e, size_t w)
+                {
+                    auto iter = next.find(w);
+                    if (iter == next.end())
+                        return;
+                    size_t& i = iter->second;
+                    if (i == groups[j + 1] || size_t(elist[rows[i]][1]) != w)
+                        return;
+                    es[rows[i]] = e;
+                    found[rows[i]] = true;
+                    ++i;
+                };
+
+            for (auto e : out_edges_range(vertex(s, u), u))
+                match(e, target(e, u));
+
+            // for undirected graphs, the edges can be stored in either
+            // direction; self-loops appear in both lists, and are only
+            // considered once
+            if (!is_directed::apply<Graph>::type::value)
+            {
+                for (auto e : in_edges_range(vertex(s, u), u))
+                {
+                    if (source(e, u) != target(e, u))
+                        match(e, source(e, u));
+                }
+            }
+        }
+
+        for (size_t i = 0; i < M; ++i)
+        {
+            if (!found[i])
+                throw ValueException("edge (" +
+                                     lexical_cast<string>(elist[i][0]) + ", " +
+                                     lexical_cast<string>(elist[i][1]) +
+                                     ") does not exist");
+        }
+    }
+};
+
+void remove_edge_list(GraphInterface& gi, python::object oelist)
+{
+    multi_array_ref<int64_t,2> elist = get_array<int64_t,2>(oelist);
+    size_t M = elist.shape()[0];
+    size_t ncols = elist.shape()[1];
+    if (M > 0 && ncols != 2 && ncols != 3)
+        throw ValueException("edge list must have two or three columns");
+
+    GILRelease gil;
+
+    vector<GraphInterface::edge_t> es;
+    auto& g = gi.get_graph();
+    if (ncols == 3)
+    {
+        // (source, target, index) rows describe the edges directly, in the
+        // orientation of the current view
+        bool reversed = gi.get_directed() && gi.get_reversed();
+        for (size_t i = 0; i < M; ++i)
+        {
+            GraphInterface::edge_t e(elist[i][0], elist[i][1], elist[i][2],
+                                     false);
+            if (reversed)
+                std::swap(e.s, e.t);
+            if (!g.is_valid_edge(e) && !gi.get_directed())
+                std::swap(e.s, e.t);
+            if (!g.is_valid_edge(e))
+                throw ValueException("invalid edge: (" +
+                                     lexical_cast<string>(elist[i][0]) + ", " +
+                                     lexical_cast<string>(elist[i][1]) + ", " +
+                                     lexical_cast<string>(elist[i][2]) + ")");
+            es.push_back(e);
+        }
+    }
+    else
+    {
+        run_action<>()(gi, std::bind(find_edge_list(), std::placeholders::_1,
+                                     std::ref(elist), std::ref(es)))();
+    }
+
+    remove_edges(es, g);
+}
+
 struct get_edge_dispatch
 {
     template <class Graph>
@@ -502,6 +637,9 @@ do_get_edge_index(GraphInterface& g)
 void do_add_edge_list(GraphInterface& gi, python::object aedge_list,
                       python::object eprops);
 
+python::object do_add_edge_array(GraphInterface& gi, python::object aedge_list,
+                                 python::object eprops);
+
 void do_add_edge_list_hashed(GraphInterface& gi, python::object aedge_list,
                              boost::any& vertex_map, bool is_str,
                              python::object eprops);
@@ -509,6 +647,19 @@ void do_add_edge_list_hashed(GraphInterface& gi, python::object aedge_list,
 void do_add_edge_list_iter(GraphInterface& gi, python::object edge_list,
                            python::object eprops);
 
+void do_read_edge_list(GraphInterface& gi, std::string file, std::string delim,
+                       std::string quote, std::string comment, bool skip_first,
+                       size_t scol, size_t tcol, size_t ncols,
+                       boost::any avnames, python::object eprops);
+
+python::object get_vertex_list(GraphInterface& gi);
+python::object get_edge_list(GraphInterface& gi);
+python::object get_out_neighbors_list(GraphInterface& gi, size_t v);
+python::object get_in_neighbors_list(GraphInterface& gi, size_t v);
+python::object get_csr(GraphInterface& gi, bool in);
+python::object get_degree_list(GraphInterface& gi, python::object ovs,
+                               std::string deg, boost::any weight);
+
 } // namespace graph_tool
 
 // register everything
@@ -565,10 +716,19 @@ void export_python_interface()
     def("remove_vertex_array", graph_tool::remove_vertex_array);
     def("clear_vertex", graph_tool::clear_vertex);
     def("remove_edge", graph_tool::remove_edge);
+    def("remove_edge_list", graph_tool::remove_edge_list);
     def("add_edge_list", graph_tool::do_add_edge_list);
     def("add_edge_list_hashed", graph_tool::do_add_edge_list_hashed);
+    def("add_edge_array", graph_tool::do_add_edge_array);
     def("add_edge_list_iter", graph_tool::do_add_edge_list_iter);
+    def("read_edge_list", graph_tool::do_read_edge_list);
     def("get_edge", get_edge);
+    def("get_vertex_list", graph_tool::get_vertex_list);
+    def("get_edge_list", graph_tool::get_edge_list);
+    def("get_out_neighbors_list", graph_tool::get_out_neighbors_list);
+    def("get_in_neighbors_list", graph_tool::get_in_neighbors_list);
+    def("get_csr", graph_tool::get_csr);
+    def("get_degree_list", graph_tool::get_degree_list);
 
     def("get_vertex_index", get_vertex_index);
     def("get_edge_index", do_get_edge_index);
@@ -110,6 +110,100 @@ void do_add_edge_list(GraphInterface& gi, python::object aedge_list,
         throw GraphException("Invalid type for edge list; must be two-dimensional with a scalar type");
 }
 
+// Inserts a whole array of edges directly into the underlying adjacency list,
+// with a single pass over each affected adjacency list (see add_edges() in
+// graph_adjacency.hh). The indexes of the new edges are returned; setting the
+// edge filter for them is left to the caller.
+struct add_edge_array
+{
+    template <class Value>
+    void operator()(Value, GraphInterface& gi, python::object& aedge_list,
+                    python::object& oeprops, vector<size_t>& idxs,
+                    bool& found) const
+    {
+        if (found)
+            return;
+        try
+        {
+            auto edge_list = get_array<Value, 2>(aedge_list);
+
+            if (edge_list.shape()[1] < 2)
+                throw GraphException("Second dimension in edge list must be of size (at least) two");
+
+            auto& g = gi.get_graph();
+            size_t M = edge_list.shape()[0];
+            size_t s = 0, t = 1;
+            if (gi.get_reversed())
+                std::swap(s, t);
+
+            size_t N = num_vertices(g);
+            for (size_t i = 0; i < M; ++i)
+            {
+                for (size_t j = 0; j < 2; ++j)
+                {
+                    auto v = edge_list[i][j];
+                    if (v < 0)
+                        throw ValueException("Invalid vertex index: " +
+                                             lexical_cast<string>(v));
+                    N = std::max(N, size_t(v) + 1);
+                }
+            }
+
+            typedef GraphInterface::edge_t edge_t;
+            vector<DynamicPropertyMapWrap<Value, edge_t>> eprops;
+            python::stl_input_iterator<boost::any> iter(oeprops), end;
+            for (; iter != end; ++iter)
+                eprops.emplace_back(*iter, writable_edge_properties());
+            size_t n_props = std::min(eprops.size(), edge_list.shape()[1] - 2);
+
+            {
+                GILRelease gil;
+                while (num_vertices(g) < N)
+                    add_vertex(g);
+                idxs = add_edges(M,
+                                 [&](size_t i) { return size_t(edge_list[i][s]); },
+                                 [&](size_t i) { return size_t(edge_list[i][t]); },
+                                 g);
+            }
+
+            for (size_t i = 0; i < M; ++i)
+            {
+                edge_t e(edge_list[i][s], edge_list[i][t], idxs[i], false);
+                for (size_t j = 0; j < n_props; ++j)
+                {
+                    try
+                    {
+                        put(eprops[j], e, edge_list[i][j + 2]);
+                    }
+                    catch(bad_lexical_cast&)
+                    {
+                        throw ValueException("Invalid edge property value: " +
+                                             lexical_cast<string>(edge_list[i][j + 2]));
+                    }
+                }
+            }
+            found = true;
+        }
+        catch (InvalidNumpyConversion& e) {}
+    }
+};
+
+python::object do_add_edge_array(GraphInterface& gi, python::object aedge_list,
+                                 python::object eprops)
+{
+    typedef mpl::vector<int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t,
+                        uint32_t, uint64_t, double, long double> vals_t;
+    bool found = false;
+    vector<size_t> idxs;
+    mpl::for_each<vals_t>(std::bind(add_edge_array(), std::placeholders::_1,
+                                    std::ref(gi), std::ref(aedge_list),
+                                    std::ref(eprops), std::ref(idxs),
+                                    std::ref(found)));
+    if (!found)
+        throw GraphException("Invalid type for edge list; must be two-dimensional with a scalar type");
+    return wrap_vector_owned(idxs);
+}
+
 template <class ValueList>
 struct add_edge_list_hash
 {
@@ -0,0 +1,297 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_util.hh"
+#include "graph_python_interface.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+// Bulk accessors which return the graph structure as numpy arrays, instead of
+// per-item Python objects. All of them respect the active vertex and edge
+// filters, and the Python GIL is released while the arrays are filled.
+
+namespace graph_tool
+{
+
+template <class Graph>
+void check_vertex(size_t v, const Graph& g)
+{
+    if (v >= num_vertices(g) || !is_valid_vertex(vertex(v, g), g))
+        throw ValueException("invalid vertex: " + lexical_cast<string>(v));
+}
+
+// Per-vertex offsets of the out-edges in the directed view of the graph (with
+// each undirected edge visited only once), given by f(v).
+template <class Graph, class F>
+void get_vertex_offsets(const Graph& g, vector<size_t>& pos, F&& f)
+{
+    size_t N = num_vertices(g);
+    pos.clear();
+    pos.resize(N + 1, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             pos[v + 1] = f(v);
+         });
+    for (size_t i = 0; i < N; ++i)
+        pos[i + 1] += pos[i];
+}
+
+python::object get_vertex_list(GraphInterface& gi)
+{
+    vector<int64_t> vlist;
+    run_action<>()
+        (gi,
+         [&](auto& g)
+         {
+             GILRelease gil;
+             vlist.reserve(num_vertices(g));
+             for (auto v : vertices_range(g))
+                 vlist.push_back(v);
+         })();
+    return wrap_vector_owned(vlist);
+}
+
+python::object get_edge_list(GraphInterface& gi)
+{
+    multi_array<int64_t, 2> elist;
+    run_action<>()
+        (gi,
+         [&](auto& g)
+         {
+             GILRelease gil;
+             auto& u = get_dir(g, typename is_directed::apply
+                                      <std::remove_reference_t<decltype(g)>>::type());
+             vector<size_t> pos;
+             get_vertex_offsets(u, pos,
+                                [&](auto v)
+                                {
+                                    size_t k = 0;
+                                    for (auto e : out_edges_range(v, u))
+                                    {
+                                        (void) e;
+                                        ++k;
+                                    }
+                                    return k;
+                                });
+             elist.resize(extents[pos.back()][3]);
+             auto eindex = get(edge_index, u);
+             parallel_vertex_loop
+                 (u,
+                  [&](auto v)
+                  {
+                      size_t i = pos[v];
+                      for (auto e : out_edges_range(v, u))
+                      {
+                          elist[i][0] = source(e, u);
+                          elist[i][1] = target(e, u);
+                          elist[i][2] = eindex[e];
+                          ++i;
+                      }
+                  });
+         })();
+    return wrap_multi_array_owned<int64_t,2>(elist);
+}
+
+template <class EdgeSelector>
+struct get_neighbors_list
+{
+    template <class Graph>
+    void operator()(Graph& g, size_t v, vector<int64_t>& nlist) const
+    {
+        GILRelease gil;
+        check_vertex(v, g);
+        typename EdgeSelector::template get_edges<Graph> select;
+        auto range = select(vertex(v, g), g);
+        for (auto e = range.first; e != range.second; ++e)
+            nlist.push_back(EdgeSelector::is_in ? source(*e, g) :
+                            target(*e, g));
+    }
+};
+
+struct out_edge_selector
+{
+    template <class Graph>
+    struct get_edges
+    {
+        auto operator()(typename graph_traits<Graph>::vertex_descriptor v,
+                        const Graph& g) const
+        {
+            return out_edges(v, g);
+        }
+    };
+    static constexpr bool is_in = false;
+};
+
+struct in_edge_selector
+{
+    template <class Graph>
+    struct get_edges
+    {
+        auto operator()(typename graph_traits<Graph>::vertex_descriptor v,
+                        const Graph& g) const
+        {
+            return in_edges(v, g);
+        }
+    };
+    static constexpr bool is_in = true;
+};
+
+python::object get_out_neighbors_list(GraphInterface& gi, size_t v)
+{
+    vector<int64_t> nlist;
+    run_action<>()
+        (gi, std::bind(get_neighbors_list<out_edge_selector>(),
+                       std::placeholders::_1, v, std::ref(nlist)))();
+    return wrap_vector_owned(nlist);
+}
+
+python::object get_in_neighbors_list(GraphInterface& gi, size_t v)
+{
+    vector<int64_t> nlist;
+    run_action<>()
+        (gi, std::bind(get_neighbors_list<in_edge_selector>(),
+                       std::placeholders::_1, v, std::ref(nlist)))();
+    return wrap_vector_owned(nlist);
+}
+
+// Compressed sparse row representation of the out- (or in-) adjacency. The
+// rows are indexed by the vertex indexes, and filtered vertices correspond to
+// empty rows.
+
+template <class EdgeSelector>
+struct get_csr_arrays
+{
+    template <class Graph>
+    void operator()(Graph& g, vector<int64_t>& indptr,
+                    vector<int64_t>& indices, vector<int64_t>& eidx) const
+    {
+        GILRelease gil;
+        typename EdgeSelector::template get_edges<Graph> select;
+        vector<size_t> pos;
+        get_vertex_offsets(g, pos,
+                           [&](auto v)
+                           {
+                               auto range = select(v, g);
+                               size_t k = 0;
+                               for (auto e = range.first; e != range.second; ++e)
+                                   ++k;
+                               return k;
+                           });
+        indptr.assign(pos.begin(), pos.end());
+        indices.resize(pos.back());
+        eidx.resize(pos.back());
+        auto eindex = get(edge_index, g);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t i = pos[v];
+                 auto range = select(v, g);
+                 for (auto e = range.first; e != range.second; ++e)
+                 {
+                     indices[i] = EdgeSelector::is_in ? source(*e, g) :
+                         target(*e, g);
+                     eidx[i] = eindex[*e];
+                     ++i;
+                 }
+             });
+    }
+};
+
+python::object get_csr(GraphInterface& gi, bool in)
+{
+    vector<int64_t> indptr, indices, eidx;
+    if (in)
+        run_action<>()
+            (gi, std::bind(get_csr_arrays<in_edge_selector>(),
+                           std::placeholders::_1, std::ref(indptr),
+                           std::ref(indices), std::ref(eidx)))();
+    else
+        run_action<>()
+            (gi, std::bind(get_csr_arrays<out_edge_selector>(),
+                           std::placeholders::_1, std::ref(indptr),
+                           std::ref(indices), std::ref(eidx)))();
+    return python::make_tuple(wrap_vector_owned(indptr),
+                              wrap_vector_owned(indices),
+                              wrap_vector_owned(eidx));
+}
+
+struct get_degree_array
+{
+    template <class Graph, class DegS, class Weight>
+    void operator()(const Graph& g, multi_array_ref<int64_t,1>& vs, DegS deg,
+                    Weight weight, python::object& ret) const
+    {
+        typedef typename detail::get_weight_type<Weight>::type weight_t;
+        typedef typename mpl::if_<std::is_same<weight_t, size_t>, int64_t,
+                                  weight_t>::type deg_t;
+
+        vector<deg_t> degs(vs.size());
+        {
+            GILRelease gil;
+            for (auto v : vs)
+                check_vertex(v, g);
+            size_t N = vs.size();
+            #pragma omp parallel for default(shared) schedule(runtime) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+                degs[i] = deg(vertex(vs[i], g), g, weight);
+        }
+        ret = wrap_vector_owned(degs);
+    }
+};
+
+python::object get_degree_list(GraphInterface& gi, python::object ovs,
+                               string deg, boost::any weight)
+{
+    python::object ret;
+    auto vs = get_array<int64_t,1>(ovs);
+
+    typedef mpl::push_back<edge_scalar_properties,
+                           detail::no_weightS>::type weight_t;
+    if (weight.empty())
+        weight = detail::no_weightS();
+
+    if (deg == "in")
+        run_action<>()(gi, std::bind(get_degree_array(), std::placeholders::_1,
+                                     std::ref(vs), in_degreeS(),
+                                     std::placeholders::_2, std::ref(ret)),
+                       weight_t())(weight);
+    else if (deg == "out")
+        run_action<>()(gi, std::bind(get_degree_array(), std::placeholders::_1,
+                                     std::ref(vs), out_degreeS(),
+                                     std::placeholders::_2, std::ref(ret)),
+                       weight_t())(weight);
+    else if (deg == "total")
+        run_action<>()(gi, std::bind(get_degree_array(), std::placeholders::_1,
+                                     std::ref(vs), total_degreeS(),
+                                     std::placeholders::_2, std::ref(ret)),
+                       weight_t())(weight);
+    else
+        throw ValueException("invalid degree type: " + deg);
+    return ret;
+}
+
+} // namespace graph_tool
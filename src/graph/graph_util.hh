@@ -46,6 +46,15 @@ namespace boost { namespace python { namespace detail {
 
 #include <functional>
 #include <random>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <vector>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
 
 #include "graph_selectors.hh"
 
@@ -177,10 +186,325 @@ void graph_copy(const GraphOrig& g, GraphTarget& gt)
 //
 // Parallel loops
 // ==============
+//
+// The loops over vertices and edges below can be scheduled in two ways:
+//
+// - loop_schedule::runtime: The vertex range is split according to the OpenMP
+//   runtime schedule (see openmp_set_schedule()).
+//
+// - loop_schedule::degree: The vertices are grouped into tasks containing
+//   approximately the same number of incident edges, and the out-edges of
+//   vertices with a large degree are divided over several tasks (in
+//   parallel_edge_loop()). Each thread processes a contiguous block of tasks,
+//   and afterwards steals the remaining tasks from the blocks of the other
+//   threads. This balances the load when the degrees are very heterogeneous.
+//   The tasks are cached for unfiltered graphs, so that repeated loops over
+//   an unmodified graph (e.g. in iterative algorithms) do not pay for the
+//   serial pass that builds them.
+//
+// The default is set globally via set_loop_schedule(), which is exposed to
+// Python via openmp_set_schedule(), and can be overridden in each call.
+
+enum class loop_schedule
+{
+    runtime,
+    degree
+};
+
+// Defined in graph_openmp.cc. The chunk is the target number of edges in each
+// task of loop_schedule::degree (zero means it is chosen automatically).
+loop_schedule get_loop_schedule();
+size_t get_loop_chunk();
+void set_loop_schedule(loop_schedule sched, size_t chunk);
+
+namespace detail
+{
+
+// A range of vertices [v_begin, v_end), or a range of out-edges [e_begin,
+// e_end) of the single vertex v_begin, if the latter was split.
+struct loop_task
+{
+    size_t v_begin;
+    size_t v_end;
+    size_t e_begin;
+    size_t e_end;
+};
+
+typedef std::vector<loop_task> loop_tasks_t;
+
+// builds the tasks from the vertex weights
+inline std::shared_ptr<const loop_tasks_t>
+build_loop_tasks(const std::vector<size_t>& weights, size_t chunk, bool split,
+                 size_t nthreads)
+{
+    auto tasks = std::make_shared<loop_tasks_t>();
+    size_t N = weights.size();
+    size_t total = 0;
+    for (auto w : weights)
+        total += w;
+    if (chunk == 0)
+        chunk = std::max(total / (32 * nthreads), size_t(64));
+
+    size_t acc = 0;
+    size_t begin = 0;
+    for (size_t v = 0; v < N; ++v)
+    {
+        size_t w = weights[v];
+        if (split && w > chunk)
+        {
+            if (acc > 0)
+                tasks->push_back({begin, v, 0, size_t(-1)});
+            for (size_t e = 0; e < w; e += chunk)
+                tasks->push_back({v, v + 1, e, std::min(e + chunk, w)});
+            acc = 0;
+            begin = v + 1;
+            continue;
+        }
+        if (acc == 0)
+            begin = v;
+        acc += w;
+        if (acc >= chunk)
+        {
+            tasks->push_back({begin, v + 1, 0, size_t(-1)});
+            acc = 0;
+            begin = v + 1;
+        }
+    }
+    if (acc > 0)
+        tasks->push_back({begin, N, 0, size_t(-1)});
+    return tasks;
+}
+
+// The tasks only depend on the degrees of the graph, so they are cached for
+// the graphs whose modifications can be tracked, i.e. the (possibly reversed
+// or undirected) views of an adj_list or of its CSR snapshot, which are
+// identified by their type, adj_list::get_uid() and adj_list::get_version().
+// Filtered graphs are not cached, since their filters can change at any time.
+
+struct loop_tasks_key
+{
+    std::type_index type;
+    size_t uid;
+    size_t version;
+    size_t kind;
+    size_t chunk;
+    size_t nthreads;
+    bool split;
+
+    bool operator==(const loop_tasks_key& k) const
+    {
+        return (type == k.type && uid == k.uid && version == k.version &&
+                kind == k.kind && chunk == k.chunk && nthreads == k.nthreads &&
+                split == k.split);
+    }
+};
+
+template <class Vertex>
+bool get_graph_state(const boost::adj_list<Vertex>& g, size_t& uid,
+                     size_t& version)
+{
+    uid = g.get_uid();
+    version = g.get_version();
+    return true;
+}
+
+template <class Vertex, class Index>
+bool get_graph_state(const boost::csr_adj_list<Vertex, Index>& g, size_t& uid,
+                     size_t& version)
+{
+    uid = g.get_uid();
+    version = g.get_version();
+    return true;
+}
+
+template <class Graph, class GraphRef>
+bool get_graph_state(const boost::reverse_graph<Graph, GraphRef>& g,
+                     size_t& uid, size_t& version)
+{
+    return get_graph_state(g.m_g, uid, version);
+}
+
+template <class Graph>
+bool get_graph_state(const boost::UndirectedAdaptor<Graph>& g, size_t& uid,
+                     size_t& version)
+{
+    return get_graph_state(g.original_graph(), uid, version);
+}
+
+template <class Graph>
+bool get_graph_state(const Graph&, size_t&, size_t&)
+{
+    return false;
+}
+
+class loop_tasks_cache
+{
+public:
+    std::shared_ptr<const loop_tasks_t> get(const loop_tasks_key& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& entry : _entries)
+        {
+            if (entry.first == key)
+                return entry.second;
+        }
+        return nullptr;
+    }
+
+    void put(const loop_tasks_key& key,
+             std::shared_ptr<const loop_tasks_t> tasks)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.size() >= max_entries)
+            _entries.erase(_entries.begin());
+        _entries.emplace_back(key, tasks);
+    }
+
+    static loop_tasks_cache& instance()
+    {
+        static loop_tasks_cache cache;
+        return cache;
+    }
+
+private:
+    static constexpr size_t max_entries = 16;
+    std::mutex _mutex;
+    std::vector<std::pair<loop_tasks_key,
+                          std::shared_ptr<const loop_tasks_t>>> _entries;
+};
+
+// distributes the tasks among nthreads queues
+class degree_partition
+{
+public:
+    degree_partition(std::shared_ptr<const loop_tasks_t> tasks,
+                     size_t nthreads)
+        : _tasks(std::move(tasks)), _queues(new queue[nthreads]),
+          _nqueues(nthreads)
+    {
+        size_t M = _tasks->size();
+        for (size_t i = 0; i < _nqueues; ++i)
+        {
+            _queues[i].next = (i * M) / _nqueues;
+            _queues[i].end = ((i + 1) * M) / _nqueues;
+        }
+    }
+
+    // process the tasks of the current thread's queue, and then steal from the
+    // other ones
+    template <class F>
+    void run(F&& f)
+    {
+        size_t tid = 0;
+#ifdef USING_OPENMP
+        tid = omp_get_thread_num();
+#endif
+        for (size_t k = 0; k < _nqueues; ++k)
+        {
+            auto& q = _queues[(tid + k) % _nqueues];
+            while (true)
+            {
+                size_t i = q.next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= q.end)
+                    break;
+                f((*_tasks)[i]);
+            }
+        }
+    }
+
+private:
+    // padded to avoid false sharing between the threads
+    struct queue
+    {
+        std::atomic<size_t> next;
+        size_t end;
+        char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    };
+
+    std::shared_ptr<const loop_tasks_t> _tasks;
+    std::unique_ptr<queue[]> _queues;
+    size_t _nqueues;
+};
+
+// Must be called by all threads of the current team (or outside a parallel
+// region). The weight of each valid vertex is given by weight(v), and "kind"
+// identifies the weight function in the cache.
+template <class Graph, class Weight, class F>
+void degree_loop_no_spawn(const Graph& g, Weight&& weight, size_t kind,
+                          bool split, F&& f)
+{
+    size_t nthreads = 1;
+#ifdef USING_OPENMP
+    nthreads = omp_get_num_threads();
+#endif
+    loop_tasks_key key = {typeid(Graph), 0, 0, kind, get_loop_chunk(),
+                          nthreads, split};
+    bool cached = get_graph_state(g, key.uid, key.version);
+
+    std::shared_ptr<degree_partition> part;
+    std::shared_ptr<std::vector<size_t>> weights;
+    #pragma omp single copyprivate(part, weights)
+    {
+        std::shared_ptr<const loop_tasks_t> tasks;
+        if (cached)
+            tasks = loop_tasks_cache::instance().get(key);
+        if (tasks)
+            part = std::make_shared<degree_partition>(tasks, nthreads);
+        else
+            weights = std::make_shared<std::vector<size_t>>(num_vertices(g));
+    }
+
+    if (!part)
+    {
+        size_t N = num_vertices(g);
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (is_valid_vertex(v, g))
+                (*weights)[i] = weight(v);
+        }
+
+        #pragma omp single copyprivate(part)
+        {
+            auto tasks = build_loop_tasks(*weights, key.chunk, split,
+                                          nthreads);
+            if (cached)
+                loop_tasks_cache::instance().put(key, tasks);
+            part = std::make_shared<degree_partition>(tasks, nthreads);
+        }
+    }
+
+    part->run(f);
+
+    #pragma omp barrier
+}
+
+} // namespace detail
 
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
-void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
+void parallel_vertex_loop_no_spawn(const Graph& g, F&& f,
+                                   loop_schedule sched = get_loop_schedule())
 {
+    if (sched == loop_schedule::degree)
+    {
+        detail::degree_loop_no_spawn
+            (g,
+             [&](auto v) { return total_degreeS()(v, g) + 1; },
+             0, false,
+             [&](const detail::loop_task& task)
+             {
+                 for (size_t i = task.v_begin; i < task.v_end; ++i)
+                 {
+                     auto v = vertex(i, g);
+                     if (!is_valid_vertex(v, g))
+                         continue;
+                     f(v);
+                 }
+             });
+        return;
+    }
+
     size_t N = num_vertices(g);
     #pragma omp for schedule(runtime)
     for (size_t i = 0; i < N; ++i)
@@ -193,11 +517,13 @@ void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
 }
 
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
-void parallel_vertex_loop(const Graph& g, F&& f)
+void parallel_vertex_loop(const Graph& g, F&& f,
+                          loop_schedule sched = get_loop_schedule())
 {
     #pragma omp parallel if (num_vertices(g) > thres)
     {
-        parallel_vertex_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f));
+        parallel_vertex_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f),
+                                                       sched);
     }
 }
 
@@ -210,13 +536,50 @@ const auto& get_dir(const Graph& g, std::false_type)
 { return g.original_graph(); }
 
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
-void parallel_edge_loop_no_spawn(const Graph& g, F&& f)
+void parallel_edge_loop_no_spawn(const Graph& g, F&& f,
+                                 loop_schedule sched = get_loop_schedule())
 {
     auto& u = get_dir(g, typename is_directed::apply<Graph>::type());
     typedef typename std::remove_const
         <typename std::remove_reference<decltype(u)>::type>::type graph_t;
     static_assert(is_directed::apply<graph_t>::type::value,
                   "graph must be directed at this point");
+
+    if (sched == loop_schedule::degree)
+    {
+        // the out-edges of a vertex can only be split if they can be accessed
+        // in constant time
+        typedef typename boost::graph_traits<graph_t>::out_edge_iterator
+            eiter_t;
+        constexpr bool split = std::is_convertible
+            <typename std::iterator_traits<eiter_t>::iterator_category,
+             std::random_access_iterator_tag>::value;
+        detail::degree_loop_no_spawn
+            (u,
+             [&](auto v) { return out_degree(v, u); },
+             1, split,
+             [&](const detail::loop_task& task)
+             {
+                 for (size_t i = task.v_begin; i < task.v_end; ++i)
+                 {
+                     auto v = vertex(i, u);
+                     if (!is_valid_vertex(v, u))
+                         continue;
+                     auto es = out_edges(v, u);
+                     if (task.e_begin > 0 || task.e_end != size_t(-1))
+                     {
+                         auto e_end = es.first;
+                         std::advance(es.first, task.e_begin);
+                         std::advance(e_end, task.e_end);
+                         es.second = e_end;
+                     }
+                     for (auto e = es.first; e != es.second; ++e)
+                         f(*e);
+                 }
+             });
+        return;
+    }
+
     auto dispatch =
         [&](auto v)
         {
@@ -224,15 +587,18 @@ void parallel_edge_loop_no_spawn(const Graph& g, F&& f)
                  f(e);
         };
     typedef decltype(dispatch) dispatch_t;
-    parallel_vertex_loop_no_spawn<graph_t, dispatch_t&, thres>(u, dispatch);
+    parallel_vertex_loop_no_spawn<graph_t, dispatch_t&, thres>
+        (u, dispatch, loop_schedule::runtime);
 }
 
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
-void parallel_edge_loop(const Graph& g, F&& f)
+void parallel_edge_loop(const Graph& g, F&& f,
+                        loop_schedule sched = get_loop_schedule())
 {
     #pragma omp parallel if (num_vertices(g) > thres)
     {
-        parallel_edge_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f));
+        parallel_edge_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f),
+                                                     sched);
     }
 }
 
@@ -22,77 +22,25 @@ namespace graph_tool
 
 using namespace std;
 
-vector<double> __safelog_cache;
-vector<double> __xlogx_cache;
-vector<double> __lgamma_cache;
+double __safelog_cache[__cache_size];
+double __xlogx_cache[__cache_size];
+double __lgamma_cache[__cache_size];
 
-void init_safelog(size_t x)
+namespace
 {
-    #pragma omp critical (_safelog_)
-    {
-        size_t old_size = __safelog_cache.size();
-        if (x >= old_size)
-        {
-            __safelog_cache.resize(x + 1);
-            for (size_t i = old_size; i < __safelog_cache.size(); ++i)
-                __safelog_cache[i] = safelog(double(i));
-        }
-    }
-}
-
-void clear_safelog()
-{
-    vector<double>().swap(__safelog_cache);
-}
-
-
-void init_xlogx(size_t x)
+struct init_cache
 {
-    #pragma omp critical (_xlogx_)
+    init_cache()
     {
-        size_t old_size = __xlogx_cache.size();
-        if (x >= old_size)
+        for (size_t i = 0; i < __cache_size; ++i)
         {
-            __xlogx_cache.resize(x + 1);
-            for (size_t i = old_size; i < __xlogx_cache.size(); ++i)
-                __xlogx_cache[i] = i * safelog(i);
+            __safelog_cache[i] = safelog(double(i));
+            __xlogx_cache[i] = i * safelog(double(i));
+            __lgamma_cache[i] = (i == 0) ?
+                numeric_limits<double>::infinity() : lgamma(double(i));
         }
     }
+} __init_cache;
 }
 
-void clear_xlogx()
-{
-    vector<double>().swap(__xlogx_cache);
-}
-
-void init_lgamma(size_t x)
-{
-    #pragma omp critical (_lgamma_)
-    {
-        size_t old_size = __lgamma_cache.size();
-        if (x >= old_size)
-        {
-            __lgamma_cache.resize(x + 1);
-            if (old_size == 0)
-                __lgamma_cache[0] = numeric_limits<double>::infinity();
-            for (size_t i = std::max(old_size, size_t(1));
-                 i < __lgamma_cache.size(); ++i)
-                __lgamma_cache[i] = lgamma(i);
-        }
-    }
-}
-
-void clear_lgamma()
-{
-    vector<double>().swap(__lgamma_cache);
-}
-
-void init_cache(size_t E)
-{
-    init_lgamma(2 * E);
-    init_xlogx(2 * E);
-    init_safelog(2 * E);
-}
-
-
 } // namespace graph_tool
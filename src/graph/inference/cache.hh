@@ -31,12 +31,18 @@ using namespace std;
 
 // Repeated computation of x*log(x) and log(x) actually adds up to a lot of
 // time. A significant speedup can be made by caching pre-computed values.
+//
+// The tables have a fixed size, small enough to stay resident in the CPU
+// cache, and are filled once when the library is loaded, so that they can be
+// read concurrently without any synchronization. Larger arguments are
+// computed directly, with lgamma() given by its Stirling series, which at this
+// cutoff is accurate to machine precision.
 
-extern vector<double> __safelog_cache;
-extern vector<double> __xlogx_cache;
-extern vector<double> __lgamma_cache;
+constexpr size_t __cache_size = 1 << 14;
 
-void init_safelog(size_t x);
+extern double __safelog_cache[__cache_size];
+extern double __xlogx_cache[__cache_size];
+extern double __lgamma_cache[__cache_size];
 
 template <class Type>
 inline double safelog(Type x)
@@ -48,33 +54,33 @@ inline double safelog(Type x)
 
 inline double safelog(size_t x)
 {
-    if (x >= __safelog_cache.size())
-        init_safelog(x);
-    return __safelog_cache[x];
+    if (x < __cache_size)
+        return __safelog_cache[x];
+    return log(double(x));
 }
 
-void init_xlogx(size_t x);
-
 inline double xlogx(size_t x)
 {
-    //return x * safelog(x);
-    if (x >= __xlogx_cache.size())
-        init_xlogx(x);
-    return __xlogx_cache[x];
+    if (x < __cache_size)
+        return __xlogx_cache[x];
+    return x * log(double(x));
 }
 
-void init_lgamma(size_t x);
+// Stirling series for log Gamma(x), for large x
+inline double lgamma_stirling(double x)
+{
+    double x2 = 1. / (x * x);
+    return (x - 0.5) * log(x) - x + 0.91893853320467274178 +
+        (1. / 12 - x2 * (1. / 360 - x2 * (1. / 1260))) / x;
+}
 
 inline double lgamma_fast(size_t x)
 {
-    //return lgamma(x);
-    if (x >= __lgamma_cache.size())
-        init_lgamma(x);
-    return __lgamma_cache[x];
+    if (x < __cache_size)
+        return __lgamma_cache[x];
+    return lgamma_stirling(x);
 }
 
-void init_cache(size_t E);
-
 } // graph_tool namespace
 
 #endif //CACHE_HH
@@ -45,7 +45,6 @@ auto gibbs_sweep(GibbsState state, RNG& rng_)
     if (state._parallel)
     {
         init_rngs(rngs, rng_);
-        init_cache(state._E);
         best_move.resize(num_vertices(g));
     }
 
@@ -96,13 +95,12 @@ auto gibbs_sweep(GibbsState state, RNG& rng_)
                  deltas.resize(moves.size());
                  idx.resize(moves.size());
 
+                 state.virtual_moves_dS(v, moves, deltas);
+
                  double dS_min = numeric_limits<double>::max();
                  for (size_t j = 0; j < moves.size(); ++j)
                  {
-                     size_t s = moves[j];
-                     double dS = state.virtual_move_dS(v, s);
-                     dS_min = std::min(dS, dS_min);
-                     deltas[j] = dS;
+                     dS_min = std::min(deltas[j], dS_min);
                      idx[j] = j;
                  }
 
@@ -27,18 +27,6 @@
 using namespace boost;
 using namespace graph_tool;
 
-namespace graph_tool
-{
-vmap_t::unchecked_t uncheck(boost::any& amap, vmap_t::unchecked_t*)
-{
-    return any_cast<vmap_t&>(amap).get_unchecked();
-}
-emap_t::unchecked_t uncheck(boost::any& amap, emap_t::unchecked_t*)
-{
-    return any_cast<emap_t&>(amap).get_unchecked();
-}
-}
-
 GEN_DISPATCH(block_state, BlockState, BLOCK_STATE_params)
 
 python::object make_block_state(boost::python::object ostate,
@@ -165,6 +153,9 @@ void export_blockmodel_state()
              double (state_t::*virtual_move)(size_t, size_t, size_t,
                                              entropy_args_t) =
                  &state_t::virtual_move;
+             void (state_t::*virtual_moves)(size_t, python::object,
+                                            python::object, entropy_args_t) =
+                 &state_t::virtual_moves;
              size_t (state_t::*sample_block)(size_t, double, rng_t&) =
                  &state_t::sample_block;
              size_t (state_t::*random_neighbour)(size_t, rng_t&) =
@@ -176,6 +167,10 @@ void export_blockmodel_state()
                  &state_t::merge_vertices;
              void (state_t::*set_partition)(boost::any&) =
                  &state_t::set_partition;
+             python::object (state_t::*get_snapshot)() =
+                 &state_t::get_snapshot;
+             void (state_t::*set_snapshot)(python::object) =
+                 &state_t::set_snapshot;
 
              class_<state_t> c(name_demangle(typeid(state_t).name()).c_str(),
                                no_init);
@@ -187,6 +182,7 @@ void export_blockmodel_state()
                  .def("move_vertices", move_vertices)
                  .def("set_partition", set_partition)
                  .def("virtual_move", virtual_move)
+                 .def("virtual_moves", virtual_moves)
                  .def("merge_vertices", merge_vertices)
                  .def("sample_block", sample_block)
                  .def("sample_neighbour", random_neighbour)
@@ -209,7 +205,11 @@ void export_blockmodel_state()
                  .def("rebuild_neighbour_sampler",
                       &state_t::rebuild_neighbour_sampler)
                  .def("sync_emat",
-                      &state_t::sync_emat);
+                      &state_t::sync_emat)
+                 .def("get_snapshot", get_snapshot)
+                 .def("set_snapshot", set_snapshot);
+             c.setattr("snapshot_header_size",
+                       size_t(state_t::snapshot_header_size));
          });
 
     class_<vcmap_t>("unity_vprop_t").def("_get_any", &get_any<vcmap_t>);
@@ -37,8 +37,14 @@ typedef UnityPropertyMap<int,GraphInterface::edge_t> ecmap_t;
 
 template <class CMap>
 CMap& uncheck(boost::any& amap, CMap*) { return any_cast<CMap&>(amap); }
-vmap_t::unchecked_t uncheck(boost::any& amap, vmap_t::unchecked_t*);
-emap_t::unchecked_t uncheck(boost::any& amap, emap_t::unchecked_t*);
+inline vmap_t::unchecked_t uncheck(boost::any& amap, vmap_t::unchecked_t*)
+{
+    return any_cast<vmap_t&>(amap).get_unchecked();
+}
+inline emap_t::unchecked_t uncheck(boost::any& amap, emap_t::unchecked_t*)
+{
+    return any_cast<emap_t&>(amap).get_unchecked();
+}
 
 typedef mpl::vector2<std::true_type, std::false_type> bool_tr;
 typedef mpl::vector2<simple_degs_t, degs_map_t> degs_tr;
@@ -115,16 +121,7 @@ public:
           _m_entries(num_vertices(_bg)),
           _coupled_state(nullptr)
     {
-        _empty_blocks.clear();
-        _candidate_blocks.clear();
-        _candidate_blocks.push_back(null_group);
-        for (auto r : vertices_range(_bg))
-        {
-            if (_wr[r] == 0)
-                add_element(_empty_blocks, _empty_pos, r);
-            else
-                add_element(_candidate_blocks, _candidate_pos, r);
-        }
+        init_block_lists();
     }
 
     BlockState(const BlockState& other)
@@ -218,30 +215,7 @@ public:
                            this->_c_bdrec[me].clear();
                        }
 
-                       this->_mrs[me] += get<0>(delta);
-                       this->_mrp[r] += get<0>(delta);
-                       this->_mrm[s] += get<0>(delta);
-
-                       assert(this->_mrs[me] >= 0);
-                       assert(this->_mrp[r] >= 0);
-                       assert(this->_mrm[s] >= 0);
-
-                       this->_brec[me].resize(get<1>(delta).size());
-                       this->_bdrec[me].resize(get<2>(delta).size());
-                       for (size_t i = 0; i < this->_rec_types.size(); ++i)
-                       {
-                           switch (this->_rec_types[i])
-                           {
-                           case weight_type::REAL_NORMAL: // signed weights
-                               this->_bdrec[me][i] += get<2>(delta)[i];
-                           case weight_type::REAL_EXPONENTIAL:
-                           case weight_type::DISCRETE_GEOMETRIC:
-                           case weight_type::DISCRETE_POISSON:
-                           case weight_type::DISCRETE_BINOMIAL:
-                           case weight_type::DELTA_T:
-                               this->_brec[me][i] += get<1>(delta)[i];
-                           }
-                       }
+                       this->add_me_delta(r, s, me, delta);
 
                        if (!Add && this->_mrs[me] == 0)
                        {
@@ -273,6 +247,35 @@ public:
         }
     }
 
+    template <class Edge, class Delta>
+    void add_me_delta(size_t r, size_t s, const Edge& me, const Delta& delta)
+    {
+        _mrs[me] += get<0>(delta);
+        _mrp[r] += get<0>(delta);
+        _mrm[s] += get<0>(delta);
+
+        assert(_mrs[me] >= 0);
+        assert(_mrp[r] >= 0);
+        assert(_mrm[s] >= 0);
+
+        _brec[me].resize(get<1>(delta).size());
+        _bdrec[me].resize(get<2>(delta).size());
+        for (size_t i = 0; i < _rec_types.size(); ++i)
+        {
+            switch (_rec_types[i])
+            {
+            case weight_type::REAL_NORMAL: // signed weights
+                _bdrec[me][i] += get<2>(delta)[i];
+            case weight_type::REAL_EXPONENTIAL:
+            case weight_type::DISCRETE_GEOMETRIC:
+            case weight_type::DISCRETE_POISSON:
+            case weight_type::DISCRETE_BINOMIAL:
+            case weight_type::DELTA_T:
+                _brec[me][i] += get<1>(delta)[i];
+            }
+        }
+    }
+
     void remove_partition_node(size_t v, size_t r)
     {
         _wr[r] -= _vweight[v];
@@ -526,6 +529,90 @@ public:
         move_vertex(v, r, nr);
     }
 
+    // Calls f(t) for every block touched by the move of vertex v to block nr,
+    // i.e. its current and new blocks and the blocks of its neighbours.
+    template <class F>
+    void move_footprint(size_t v, size_t nr, F&& f)
+    {
+        f(_b[v]);
+        f(nr);
+        for (auto e : all_edges_range(v, _g))
+        {
+            auto u = (source(e, _g) == v) ? target(e, _g) : source(e, _g);
+            f(_b[u]);
+        }
+    }
+
+    // Move a vertex without touching anything outside of its footprint (see
+    // move_footprint()), so that moves with disjoint footprints can be
+    // performed concurrently. If the move would empty or occupy a block, or
+    // add or remove an edge of the block graph, nothing is changed and false
+    // is returned; the move then needs to be done via move_vertex().
+    template <class MEntries>
+    bool move_vertex_local(size_t v, size_t nr, MEntries& m_entries)
+    {
+        size_t r = _b[v];
+        if (r == nr)
+            return true;
+
+        if (_wr[r] == _vweight[v] || _wr[nr] == 0 ||
+            _partition_stats.size() > 1)
+            return false;
+
+        m_entries.clear();
+        get_move_entries(v, r, nr, m_entries);
+
+        bool local = true;
+        entries_op(m_entries, _emat,
+                   [&](auto, auto, auto& me, auto& delta)
+                   {
+                       int d = get<0>(delta);
+                       if (d == 0)
+                           return;
+                       if (me == _emat.get_null_edge() ||
+                           int(this->_mrs[me]) + d == 0)
+                           local = false;
+                   });
+        if (!local)
+            return false;
+
+        entries_op(m_entries, _emat,
+                   [&](auto r, auto s, auto& me, auto& delta)
+                   {
+                       if (get<0>(delta) == 0)
+                           return;
+                       this->add_me_delta(r, s, me, delta);
+                   });
+
+        if (!_rec_types.empty() &&
+            _rec_types.front() == weight_type::DELTA_T) // waiting times
+        {
+            if (_ignore_degrees[v] > 0)
+            {
+                auto dt = out_degreeS()(v, _g, _rec);
+                _brecsum[r] -= dt[0];
+                _brecsum[nr] += dt[0];
+            }
+        }
+
+        _wr[r] -= _vweight[v];
+        _wr[nr] += _vweight[v];
+
+        if (!_egroups.empty() && _egroups_enabled)
+            _egroups.remove_vertex(v, _b, _g);
+
+        if (is_partition_stats_enabled())
+            get_partition_stats(v).move_vertex(v, r, nr, _deg_corr, _g,
+                                               _vweight, _eweight, _degs);
+
+        _b[v] = nr;
+
+        if (!_egroups.empty() && _egroups_enabled)
+            _egroups.add_vertex(v, _b, _eweight, _g);
+
+        return true;
+    }
+
     void set_vertex_weight(size_t v, int w)
     {
         set_vertex_weight(v, w, _vweight);
@@ -982,24 +1069,7 @@ public:
             }
         }
 
-        if (ea.partition_dl || ea.degree_dl || ea.edges_dl)
-        {
-            enable_partition_stats();
-            auto& ps = get_partition_stats(v);
-            if (ea.partition_dl)
-                dS += ps.get_delta_partition_dl(v, r, nr, _vweight);
-            if (_deg_corr && ea.degree_dl)
-                dS += ps.get_delta_deg_dl(v, r, nr, _vweight, _eweight,
-                                          _degs, _g, ea.degree_dl_kind);
-            if (ea.edges_dl)
-            {
-                size_t actual_B = 0;
-                for (auto& ps : _partition_stats)
-                    actual_B += ps.get_actual_B();
-                dS += ps.get_delta_edges_dl(v, r, nr, _vweight, actual_B,
-                                            _g);
-            }
-        }
+        dS += virtual_move_dl(v, r, nr, ea);
 
         if (ea.recs)
         {
@@ -1115,6 +1185,59 @@ public:
             }
         }
 
+        dS += virtual_move_coupled(v, r, nr);
+        return dS;
+    }
+
+    double virtual_move(size_t v, size_t r, size_t nr, entropy_args_t ea)
+    {
+        return virtual_move(v, r, nr, ea, _m_entries);
+    }
+
+    // Python interface of virtual_moves() (used for testing), which stores in
+    // odS the entropy differences of moving v from its current block to each
+    // of the blocks in onrs
+    void virtual_moves(size_t v, python::object onrs, python::object odS,
+                       entropy_args_t ea)
+    {
+        auto nrs = get_array<uint64_t, 1>(onrs);
+        auto dS = get_array<double, 1>(odS);
+        if (nrs.shape()[0] != dS.shape()[0])
+            throw ValueException("block and entropy lists do not have the same size");
+        std::vector<size_t> bs(nrs.begin(), nrs.end());
+        std::vector<double> ret;
+        virtual_moves(v, _b[v], bs, ea, _m_entries, ret);
+        for (size_t i = 0; i < ret.size(); ++i)
+            dS[i] = ret[i];
+    }
+
+    double virtual_move_dl(size_t v, size_t r, size_t nr, entropy_args_t ea)
+    {
+        double dS = 0;
+        if (ea.partition_dl || ea.degree_dl || ea.edges_dl)
+        {
+            enable_partition_stats();
+            auto& ps = get_partition_stats(v);
+            if (ea.partition_dl)
+                dS += ps.get_delta_partition_dl(v, r, nr, _vweight);
+            if (_deg_corr && ea.degree_dl)
+                dS += ps.get_delta_deg_dl(v, r, nr, _vweight, _eweight,
+                                          _degs, _g, ea.degree_dl_kind);
+            if (ea.edges_dl)
+            {
+                size_t actual_B = 0;
+                for (auto& ps : _partition_stats)
+                    actual_B += ps.get_actual_B();
+                dS += ps.get_delta_edges_dl(v, r, nr, _vweight, actual_B,
+                                            _g);
+            }
+        }
+        return dS;
+    }
+
+    double virtual_move_coupled(size_t v, size_t r, size_t nr)
+    {
+        double dS = 0;
         if (_coupled_state != nullptr && _vweight[v] > 0)
         {
             assert(r == null_group || nr == null_group || allow_move(r, nr));
@@ -1143,9 +1266,203 @@ public:
         return dS;
     }
 
-    double virtual_move(size_t v, size_t r, size_t nr, entropy_args_t ea)
+    // Compute the entropy differences of moving vertex v from block r to each
+    // of the blocks in nrs, which are stored in dS. The edge weights between
+    // v and the blocks of its neighbours are tallied only once, and the terms
+    // that involve only block r are shared by all candidates.
+    template <class MEntries, class Blocks>
+    void virtual_moves(size_t v, size_t r, const Blocks& nrs,
+                       entropy_args_t ea, MEntries& m_entries,
+                       std::vector<double>& dS)
     {
-        return virtual_move(v, r, nr, ea, _m_entries);
+        dS.resize(nrs.size());
+
+        if (r == null_group || !ea.adjacency || ea.dense ||
+            (ea.recs && !_rec_types.empty()))
+        {
+            for (size_t i = 0; i < nrs.size(); ++i)
+                dS[i] = virtual_move(v, r, nrs[i], ea, m_entries);
+            return;
+        }
+
+        if (ea.exact)
+            virtual_moves_sparse<true>(v, r, nrs, m_entries._nblocks, dS);
+        else
+            virtual_moves_sparse<false>(v, r, nrs, m_entries._nblocks, dS);
+
+        for (size_t i = 0; i < nrs.size(); ++i)
+        {
+            size_t nr = nrs[i];
+            if (nr == r)
+            {
+                dS[i] = 0;
+            }
+            else if (nr == null_group)
+            {
+                dS[i] = virtual_move(v, r, nr, ea, m_entries);
+            }
+            else if (!allow_move(r, nr))
+            {
+                dS[i] = std::numeric_limits<double>::infinity();
+            }
+            else
+            {
+                dS[i] += virtual_move_dl(v, r, nr, ea);
+                dS[i] += virtual_move_coupled(v, r, nr);
+            }
+        }
+    }
+
+    // Sparse adjacency terms of virtual_moves(). The entries of the e_rs
+    // matrix that are modified by a move r -> nr are (r, t) and (nr, t) for
+    // all neighbouring blocks t; the first kind does not depend on nr, except
+    // for t == nr, and is computed only once.
+    template <bool exact, class Blocks>
+    void virtual_moves_sparse(size_t v, size_t r, const Blocks& nrs,
+                              NeighbourBlocks& nb, std::vector<double>& dS)
+    {
+        typedef typename graph_traits<g_t>::vertex_descriptor vertex_t;
+        constexpr bool directed = is_directed::apply<g_t>::type::value;
+
+        auto et = [&](size_t r, size_t s, int mrs)
+            {
+                assert(mrs >= 0);
+                if (exact)
+                    return eterm_exact(r, s, mrs, _bg);
+                else
+                    return eterm(r, s, mrs, _bg);
+            };
+
+        auto vt = [&](auto mrp, auto mrm, auto nr)
+            {
+                assert(mrp >= 0 && mrm >=0 && nr >= 0);
+                if (exact)
+                    return vterm_exact(mrp, mrm, nr, _deg_corr, _bg);
+                else
+                    return vterm(mrp, mrm, nr, _deg_corr, _bg);
+            };
+
+        auto dterm = [&](size_t r, size_t s, int d)
+            {
+                if (d == 0)
+                    return 0.;
+                int mrs = get_beprop(r, s, _mrs, _emat);
+                return et(r, s, mrs + d) - et(r, s, mrs);
+            };
+
+        // tally the edge weights to the neighbouring blocks, with self-loops
+        // kept separately
+        nb.clear();
+        int l = 0;
+        for (auto e : out_edges_range(v, _g))
+        {
+            vertex_t u = target(e, _g);
+            if (u == v)
+                l += _eweight[e];
+            else
+                nb.add(_b[u], _eweight[e], 0);
+        }
+
+        if (directed)
+        {
+            for (auto e : in_edges_range(v, _g))
+            {
+                vertex_t u = source(e, _g);
+                if (u != v)
+                    nb.add(_b[u], 0, _eweight[e]);
+            }
+        }
+        else
+        {
+            l /= 2; // self-loops appear twice in the out-edge list
+        }
+
+        auto& blocks = nb._blocks;
+        auto& kouts = nb._kout;
+        auto& kins = nb._kin;
+        auto& dS_r = nb._dS_r;
+
+        // terms of the (r, t) entries, which are shared by all moves
+        dS_r.resize(blocks.size());
+        double dS_rt = 0;
+        for (size_t j = 0; j < blocks.size(); ++j)
+        {
+            size_t t = blocks[j];
+            if (t == r)
+            {
+                dS_r[j] = 0;
+                continue;
+            }
+            dS_r[j] = dterm(r, t, -kouts[j]);
+            if (directed)
+                dS_r[j] += dterm(t, r, -kins[j]);
+            dS_rt += dS_r[j];
+        }
+
+        int kout_r = nb.get_kout(r);
+        int kin_r = nb.get_kin(r);
+
+        double dS_rr;
+        if (directed)
+            dS_rr = dterm(r, r, -kout_r - kin_r - l);
+        else
+            dS_rr = dterm(r, r, -kout_r - l);
+
+        size_t kout = out_degreeS()(v, _g, _eweight);
+        size_t kin = kout;
+        if (directed)
+            kin = in_degreeS()(v, _g, _eweight);
+
+        int dw = _vweight[v];
+
+        double dS_vr = vt(_mrp[r] - kout, _mrm[r] - kin, _wr[r] - dw) -
+                       vt(_mrp[r]       , _mrm[r]      , _wr[r]     );
+
+        for (size_t i = 0; i < nrs.size(); ++i)
+        {
+            size_t nr = nrs[i];
+            if (nr == r || nr == null_group)
+            {
+                dS[i] = 0;
+                continue;
+            }
+
+            double ddS = dS_rt + dS_rr + dS_vr;
+
+            for (size_t j = 0; j < blocks.size(); ++j)
+            {
+                size_t t = blocks[j];
+                if (t == r || t == nr)
+                    continue;
+                ddS += dterm(nr, t, kouts[j]);
+                if (directed)
+                    ddS += dterm(t, nr, kins[j]);
+            }
+
+            int kout_nr = nb.get_kout(nr);
+            int kin_nr = nb.get_kin(nr);
+
+            size_t j = nb.get_pos(nr);
+            if (j < blocks.size())
+                ddS -= dS_r[j];
+
+            if (directed)
+            {
+                ddS += dterm(r, nr, -kout_nr + kin_r);
+                ddS += dterm(nr, r, -kin_nr + kout_r);
+                ddS += dterm(nr, nr, kout_nr + kin_nr + l);
+            }
+            else
+            {
+                ddS += dterm(r, nr, -kout_nr + kout_r);
+                ddS += dterm(nr, nr, kout_nr + l);
+            }
+
+            ddS += vt(_mrp[nr] + kout, _mrm[nr] + kin, _wr[nr] + dw) -
+                   vt(_mrp[nr]       , _mrm[nr]      , _wr[nr]     );
+
+            dS[i] = ddS;
+        }
     }
 
     double get_delta_partition_dl(size_t v, size_t r, size_t nr)
@@ -1687,6 +2004,267 @@ public:
         _emat.sync(_bg);
     }
 
+    void init_block_lists()
+    {
+        _empty_blocks.clear();
+        _candidate_blocks.clear();
+        _candidate_blocks.push_back(null_group);
+        for (auto r : vertices_range(_bg))
+        {
+            if (_wr[r] == 0)
+                add_element(_empty_blocks, _empty_pos, r);
+            else
+                add_element(_candidate_blocks, _candidate_pos, r);
+        }
+    }
+
+    // =========================================================================
+    // Snapshots
+    // =========================================================================
+
+    // The snapshot contains the partition, the per-group counts and the block
+    // graph with its edge counts and covariate sums. It can only be restored
+    // into a state built for the same graph, number of groups and covariates;
+    // everything else (edge matrix, half-edge lists, partition statistics) is
+    // rebuilt from it in O(N + E).
+
+    static constexpr uint32_t snapshot_magic = 0x53425447; // "GTBS"
+    static constexpr uint32_t snapshot_version = 1;
+
+    // magic, version, N, B, E and the number of covariates; the partition
+    // follows immediately after it
+    static constexpr size_t snapshot_header_size =
+        3 * sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+    void get_snapshot(snapshot_writer& out)
+    {
+        out.put<uint32_t>(snapshot_magic);
+        out.put<uint32_t>(snapshot_version);
+        out.put<uint64_t>(num_vertices(_g));
+        out.put<uint64_t>(num_vertices(_bg));
+        out.put<uint64_t>(num_edges(_bg));
+        out.put<uint32_t>(_rec_types.size());
+
+        for (auto v : vertices_range(_g))
+            out.put<int32_t>(_b[v]);
+
+        for (auto r : vertices_range(_bg))
+        {
+            out.put<int32_t>(_wr[r]);
+            out.put<int32_t>(_mrp[r]);
+            out.put<int32_t>(_mrm[r]);
+            out.put<int32_t>(_bclabel[r]);
+            out.put<double>(_brecsum[r]);
+        }
+
+        for (auto me : edges_range(_bg))
+        {
+            out.put<uint32_t>(source(me, _bg));
+            out.put<uint32_t>(target(me, _bg));
+            out.put<int32_t>(_mrs[me]);
+            out.put_vector(_brec[me]);
+            out.put_vector(_bdrec[me]);
+        }
+    }
+
+    void set_snapshot(snapshot_reader& in)
+    {
+        if (in.get<uint32_t>() != snapshot_magic ||
+            in.get<uint32_t>() != snapshot_version)
+            throw ValueException("invalid block state snapshot");
+
+        size_t N = in.get<uint64_t>();
+        size_t B = in.get<uint64_t>();
+        size_t E = in.get<uint64_t>();
+        size_t nrec = in.get<uint32_t>();
+
+        if (N != num_vertices(_g) || B != num_vertices(_bg) ||
+            nrec != _rec_types.size())
+            throw ValueException("snapshot does not match the state: "
+                                 "different number of vertices, groups or "
+                                 "edge covariates");
+
+        // everything is read and checked before the state is touched, so
+        // that an invalid snapshot leaves it unchanged
+        std::vector<size_t> vs;
+        for (auto v : vertices_range(_g))
+            vs.push_back(v);
+        std::vector<int32_t> b(vs.empty() ? 0 : *std::max_element(vs.begin(),
+                                                                   vs.end()) + 1);
+        for (auto v : vs)
+        {
+            auto& r = b[v];
+            r = in.get<int32_t>();
+            if (r < 0 || size_t(r) >= B)
+                throw ValueException("invalid group label in snapshot");
+        }
+
+        std::vector<std::array<int32_t, 4>> bcounts(B);
+        std::vector<double> brecsum(B);
+        for (size_t r = 0; r < B; ++r)
+        {
+            for (auto& x : bcounts[r])
+                x = in.get<int32_t>();
+            // the constraint labels are groups of the coupled state, if any
+            if (bcounts[r][3] < 0 ||
+                (_coupled_state != nullptr &&
+                 size_t(bcounts[r][3]) >= num_vertices(_coupled_state->_bg)))
+                throw ValueException("invalid constraint label in snapshot");
+            brecsum[r] = in.get<double>();
+        }
+
+        // each block graph edge takes at least 20 bytes
+        if (E > in.remaining() / 20)
+            throw ValueException("truncated snapshot");
+
+        std::vector<std::tuple<size_t, size_t, int32_t>> bedges(E);
+        std::vector<std::vector<double>> brec(E), bdrec(E);
+        for (size_t i = 0; i < E; ++i)
+        {
+            size_t r = in.get<uint32_t>();
+            size_t s = in.get<uint32_t>();
+            if (r >= B || s >= B)
+                throw ValueException("invalid block graph in snapshot");
+            bedges[i] = std::make_tuple(r, s, in.get<int32_t>());
+            in.get_vector(brec[i]);
+            in.get_vector(bdrec[i]);
+        }
+
+        if (!in.done())
+            throw ValueException("trailing data in snapshot");
+
+        check_snapshot_counts(b, bcounts, bedges);
+
+        for (auto v : vs)
+            _b[v] = b[v];
+
+        for (size_t r = 0; r < B; ++r)
+        {
+            _wr[r] = bcounts[r][0];
+            _mrp[r] = bcounts[r][1];
+            _mrm[r] = bcounts[r][2];
+            _bclabel[r] = bcounts[r][3];
+            _brecsum[r] = brecsum[r];
+        }
+
+        for (auto r : vertices_range(_bg))
+            clear_vertex(r, _bg);
+        for (size_t i = 0; i < E; ++i)
+        {
+            auto me = add_edge(get<0>(bedges[i]), get<1>(bedges[i]), _bg).first;
+            _c_mrs[me] = get<2>(bedges[i]);
+            _c_brec[me] = std::move(brec[i]);
+            _c_bdrec[me] = std::move(bdrec[i]);
+        }
+
+        _emat.sync(_bg);
+        init_block_lists();
+
+        if (!_egroups.empty())
+        {
+            _egroups.clear();
+            _egroups.init(_b, _eweight, _g, _bg);
+        }
+
+        if (is_partition_stats_enabled())
+        {
+            disable_partition_stats();
+            enable_partition_stats();
+        }
+    }
+
+    // Recount the group sizes, degrees and edge counts from the partition
+    // contained in the snapshot, in O(N + E), and compare them with the
+    // stored ones. The vertices in the same group must also have the same
+    // partition constraint label.
+    template <class Bmap, class BCounts, class BEdges>
+    void check_snapshot_counts(Bmap& b, BCounts& bcounts, BEdges& bedges)
+    {
+        size_t B = bcounts.size();
+        std::vector<size_t> wr(B), mrp(B), mrm(B);
+        std::vector<int> rpc(B, -1);
+        for (auto v : vertices_range(_g))
+        {
+            size_t r = b[v];
+            wr[r] += _vweight[v];
+            if (rpc[r] == -1)
+                rpc[r] = _pclabel[v];
+            else if (rpc[r] != _pclabel[v])
+                throw ValueException("inconsistent partition constraint "
+                                     "labels in snapshot");
+        }
+
+        gt_hash_map<std::pair<size_t, size_t>, size_t> mrs;
+        for (auto e : edges_range(_g))
+        {
+            size_t r = b[source(e, _g)];
+            size_t s = b[target(e, _g)];
+            mrp[r] += _eweight[e];
+            mrm[s] += _eweight[e];
+            if (!is_directed::apply<g_t>::type::value)
+            {
+                // mrp and mrm hold the same total degree
+                mrp[s] += _eweight[e];
+                mrm[r] += _eweight[e];
+                if (s < r)
+                    std::swap(r, s);
+            }
+            mrs[std::make_pair(r, s)] += _eweight[e];
+        }
+
+        for (size_t r = 0; r < B; ++r)
+        {
+            if (size_t(bcounts[r][0]) != wr[r] ||
+                size_t(bcounts[r][1]) != mrp[r] ||
+                size_t(bcounts[r][2]) != mrm[r])
+                throw ValueException("inconsistent group counts in snapshot");
+        }
+
+        size_t nmatched = 0;
+        gt_hash_set<std::pair<size_t, size_t>> seen;
+        for (auto& rsm : bedges)
+        {
+            size_t r = get<0>(rsm);
+            size_t s = get<1>(rsm);
+            if (!is_directed::apply<g_t>::type::value && s < r)
+                std::swap(r, s);
+            auto rs = std::make_pair(r, s);
+            if (!seen.insert(rs).second)
+                throw ValueException("repeated block graph edge in snapshot");
+            auto iter = mrs.find(rs);
+            size_t m = (iter == mrs.end()) ? 0 : iter->second;
+            if (get<2>(rsm) < 0 || size_t(get<2>(rsm)) != m)
+                throw ValueException("inconsistent edge counts in snapshot");
+            if (m > 0)
+                nmatched++;
+        }
+
+        size_t nnonzero = 0;
+        for (auto& rsm : mrs)
+        {
+            if (rsm.second > 0)
+                nnonzero++;
+        }
+        if (nmatched != nnonzero)
+            throw ValueException("inconsistent edge counts in snapshot");
+    }
+
+    python::object get_snapshot()
+    {
+        snapshot_writer out;
+        get_snapshot(out);
+        auto& buf = out.get_buffer();
+        PyObject* bytes = PyBytes_FromStringAndSize(buf.data(), buf.size());
+        return python::object(python::handle<>(bytes));
+    }
+
+    void set_snapshot(python::object obuf)
+    {
+        std::string buf = python::extract<std::string>(obuf);
+        snapshot_reader in(buf);
+        set_snapshot(in);
+    }
+
     bool check_edge_counts()
     {
         gt_hash_map<std::pair<size_t, size_t>, size_t> mrs;
@@ -1750,7 +2328,7 @@ public:
 
     typedef typename std::conditional<use_hash_t::value,
                                       EHash<bg_t>,
-                                      EMat<bg_t>>::type
+                                      EAdaptive<bg_t>>::type
         emat_t;
     emat_t _emat;
 
@@ -76,6 +76,7 @@ struct Gibbs
 
         typename state_t::g_t& _g;
         typename state_t::m_entries_t _m_entries;
+        std::vector<size_t> _nrs;
 
         auto& get_moves(size_t) { return _state._candidate_blocks; }
 
@@ -104,6 +105,42 @@ struct Gibbs
             return _state.virtual_move(v, r, nr, _entropy_args, _m_entries);
         }
 
+        template <class Moves>
+        void virtual_moves_dS(size_t v, const Moves& moves,
+                              std::vector<double>& dS)
+        {
+            size_t r = _state._b[v];
+            _nrs.resize(moves.size());
+            for (size_t j = 0; j < moves.size(); ++j)
+            {
+                size_t nr = moves[j];
+                if (nr == null_group && !_state._empty_blocks.empty())
+                    nr = _state._empty_blocks.front();
+                if (nr == null_group || !_state.allow_move(r, nr))
+                    nr = r; // forbidden move, see below
+                _nrs[j] = nr;
+            }
+
+            _state.virtual_moves(v, r, _nrs, _entropy_args, _m_entries, dS);
+
+#ifndef NDEBUG
+            // the batched computation must agree with the individual moves
+            for (size_t j = 0; j < _nrs.size(); ++j)
+            {
+                double ddS = _state.virtual_move(v, r, _nrs[j], _entropy_args,
+                                                 _m_entries);
+                assert((std::isinf(ddS) && std::isinf(dS[j])) ||
+                       abs(ddS - dS[j]) <= 1e-8 * max(1., abs(ddS)));
+            }
+#endif
+
+            for (size_t j = 0; j < moves.size(); ++j)
+            {
+                if (_nrs[j] == r && moves[j] != r)
+                    dS[j] = numeric_limits<double>::infinity();
+            }
+        }
+
         template <class RNG>
         void perform_move(size_t v, size_t nr, RNG& rng)
         {
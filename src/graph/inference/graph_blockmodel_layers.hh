@@ -420,6 +420,16 @@ struct Layers
             return virtual_move(v, r, s, ea, _m_entries);
         }
 
+        template <class MEntries, class Blocks>
+        void virtual_moves(size_t v, size_t r, const Blocks& nrs,
+                           entropy_args_t ea, MEntries& m_entries,
+                           std::vector<double>& dS)
+        {
+            dS.resize(nrs.size());
+            for (size_t i = 0; i < nrs.size(); ++i)
+                dS[i] = virtual_move(v, r, nrs[i], ea, m_entries);
+        }
+
         void merge_vertices(size_t u, size_t v)
         {
             std::set<size_t> ls;
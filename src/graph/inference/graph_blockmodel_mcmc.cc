@@ -24,6 +24,7 @@
 #include "graph_blockmodel.hh"
 #include "graph_blockmodel_mcmc.hh"
 #include "mcmc_loop.hh"
+#include "tempering_loop.hh"
 
 using namespace boost;
 using namespace graph_tool;
@@ -50,7 +51,7 @@ python::object do_mcmc_sweep(python::object omcmc_state,
             {
                 if (s._parallel)
                 {
-                    auto ret_ = mcmc_sweep_parallel(s, rng);
+                    auto ret_ = mcmc_sweep_async(s, rng);
                     ret = python::make_tuple(ret_.first, ret_.second);
                 }
                 else
@@ -64,8 +65,73 @@ python::object do_mcmc_sweep(python::object omcmc_state,
     return ret;
 }
 
+python::object do_tempering_sweep(python::object omcmc_states,
+                                  python::object oblock_state,
+                                  python::object oS, size_t niter,
+                                  rng_t& rng)
+{
+    size_t N = python::len(omcmc_states);
+    if (N == 0 || size_t(python::len(oS)) != N)
+        throw ValueException("invalid number of replicas");
+
+    std::vector<double> S;
+    for (size_t i = 0; i < N; ++i)
+        S.push_back(python::extract<double>(oS[i]));
+
+    python::object ret;
+    auto dispatch = [&](auto& block_state)
+    {
+        typedef typename std::remove_reference<decltype(block_state)>::type
+            state_t;
+
+        // The MCMC states are constructed on the stack by make_dispatch(), so
+        // they are collected recursively, and the sweep is run from the
+        // innermost call. All replicas must be of the same type, otherwise
+        // the extraction of their block states will fail (this is checked
+        // by TemperingState.tempering_sweep()).
+        mcmc_block_state<state_t>::make_dispatch
+           (omcmc_states[0],
+            [&](auto& s)
+            {
+                typedef typename std::remove_reference<decltype(s)>::type
+                    mcmc_state_t;
+                std::vector<mcmc_state_t*> states = {&s};
+                std::function<void()> collect = [&]()
+                    {
+                        if (states.size() < N)
+                        {
+                            mcmc_block_state<state_t>::make_dispatch
+                                (omcmc_states[states.size()],
+                                 [&](auto& si)
+                                 {
+                                     states.push_back(&si);
+                                     collect();
+                                 });
+                            return;
+                        }
+
+                        std::vector<size_t> idx;
+                        auto ret_ = tempering_sweep(states, S, idx, niter,
+                                                    rng);
+                        python::list nS, oidx;
+                        for (size_t i = 0; i < N; ++i)
+                        {
+                            nS.append(S[i]);
+                            oidx.append(idx[i]);
+                        }
+                        ret = python::make_tuple(get<0>(ret_), get<1>(ret_),
+                                                 get<2>(ret_), nS, oidx);
+                    };
+                collect();
+            });
+    };
+    block_state::dispatch(oblock_state, dispatch);
+    return ret;
+}
+
 void export_blockmodel_mcmc()
 {
     using namespace boost::python;
     def("mcmc_sweep", &do_mcmc_sweep);
+    def("tempering_sweep", &do_tempering_sweep);
 }
@@ -126,6 +126,17 @@ struct MCMC
         {
             _state.move_vertex(v, nr);
         }
+
+        template <class F>
+        void move_footprint(size_t v, size_t nr, F&& f)
+        {
+            _state.move_footprint(v, nr, std::forward<F>(f));
+        }
+
+        bool perform_move_local(size_t v, size_t nr)
+        {
+            return _state.move_vertex_local(v, nr, _m_entries);
+        }
     };
 };
 
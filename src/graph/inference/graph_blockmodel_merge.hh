@@ -133,6 +133,21 @@ struct Merge
             _state.merge_vertices(r, s);
         }
 
+        template <class F>
+        void merge_footprint(size_t r, size_t s, F&& f)
+        {
+            for (auto v : {r, s})
+            {
+                f(v);
+                for (auto e : all_edges_range(v, _g))
+                {
+                    auto u = (source(e, _g) == v) ? target(e, _g) :
+                        source(e, _g);
+                    f(u);
+                }
+            }
+        }
+
         size_t get_root(size_t s)
         {
             int r = s;
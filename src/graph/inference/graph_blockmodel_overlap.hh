@@ -114,7 +114,7 @@ public:
         {
             size_t s = _b[u];
 
-            auto& me = _emat.get_me(r, s);
+            auto me = _emat.get_me(r, s);
 
             _mrs[me] -= 1;
             _mrp[r] -= 1;
@@ -133,7 +133,7 @@ public:
         {
             size_t s = _b[u];
 
-            auto& me = _emat.get_me(s, r);
+            auto me = _emat.get_me(s, r);
 
             _mrs[me] -= 1;
             _mrp[s] -= 1;
@@ -550,6 +550,16 @@ public:
         return virtual_move(v, r, nr, ea, _m_entries);
     }
 
+    template <class MEntries, class Blocks>
+    void virtual_moves(size_t v, size_t r, const Blocks& nrs,
+                       entropy_args_t ea, MEntries& m_entries,
+                       std::vector<double>& dS)
+    {
+        dS.resize(nrs.size());
+        for (size_t i = 0; i < nrs.size(); ++i)
+            dS[i] = virtual_move(v, r, nrs[i], ea, m_entries);
+    }
+
     double get_delta_partition_dl(size_t v, size_t r, size_t nr)
     {
         enable_partition_stats();
@@ -1095,7 +1105,7 @@ public:
 
     typedef typename std::conditional<use_hash_t::value,
                                       EHash<bg_t>,
-                                      EMat<bg_t>>::type
+                                      EAdaptive<bg_t>>::type
         emat_t;
     emat_t _emat;
 
@@ -1299,7 +1299,7 @@ public:
     }
 
     template <class Emat>
-    const bedge_t& get_me(size_t t, size_t s, Emat& emat)
+    bedge_t get_me(size_t t, size_t s, Emat& emat)
     {
         if (!is_directed::apply<Graph>::type::value && (t > s))
             std::swap(t, s);
@@ -21,6 +21,8 @@
 #include "config.h"
 
 #include <tuple>
+#include <array>
+#include <cstring>
 
 #include "hash_map_wrap.hh"
 
@@ -790,6 +792,28 @@ public:
         change_vertex(v, nr, deg_corr, g, vweight, eweight, degs, 1);
     }
 
+    // Move a vertex between two blocks that are both occupied before and
+    // after the move. Only the entries of r and nr are modified, so moves
+    // involving disjoint blocks can be done concurrently.
+    template <class Graph, class VWeight, class EWeight, class Degs>
+    void move_vertex(size_t v, size_t r, size_t nr, bool deg_corr, Graph& g,
+                     VWeight& vweight, EWeight& eweight, Degs& degs)
+    {
+        if (vweight[v] == 0)
+            return;
+        r = get_r(r);
+        nr = get_r(nr);
+        auto&& ks = get_degs(v, vweight, eweight, degs, g);
+        for (auto& k : ks)
+        {
+            auto kin = get<0>(k);
+            auto kout = get<1>(k);
+            int n = get<2>(k);
+            change_block_k(v, r, deg_corr, n, kin, kout, -1);
+            change_block_k(v, nr, deg_corr, n, kin, kout, 1);
+        }
+    }
+
     void change_k(size_t v, size_t r, bool deg_corr, int vweight,
                   int kin, int kout, int diff)
     {
@@ -799,9 +823,16 @@ public:
         if (_total[r] == vweight && diff * vweight < 0)
             _actual_B--;
 
-        _total[r] += diff * vweight;
         _N += diff * vweight;
 
+        change_block_k(v, r, deg_corr, vweight, kin, kout, diff);
+    }
+
+    void change_block_k(size_t v, size_t r, bool deg_corr, int vweight,
+                        int kin, int kout, int diff)
+    {
+        _total[r] += diff * vweight;
+
         assert(_total[r] >= 0);
 
         if (deg_corr && _ignore_degree[v] != 1)
@@ -843,114 +874,139 @@ private:
 // Block moves
 // ===============================
 
-// this structure speeds up the access to the edges between given blocks, since
-// we're using an adjacency list to store the block structure (it is simply an
-// adjacency matrix)
+// The structures below speed up the access to the edges between given blocks,
+// since we're using an adjacency list to store the block structure. Instead of
+// full edge descriptors, they store compact 32-bit codes: the edge index, with
+// the highest bit set if the edge is stored as (s, r) rather than (r, s) in the
+// block graph. The descriptor is reconstructed on lookup.
+
+template <class BGraph>
+struct emat_code
+{
+    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+
+    static constexpr uint32_t null = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t inv = uint32_t(1) << 31;
+
+    static uint32_t encode(vertex_t r, const edge_t& e)
+    {
+        assert(e.idx < inv);
+        return uint32_t(e.idx) | ((e.s == r) ? 0 : inv);
+    }
+
+    static edge_t decode(vertex_t r, vertex_t s, uint32_t c)
+    {
+        if (c == null)
+            return edge_t();
+        if (c & inv)
+            return edge_t(s, r, c & ~inv, false);
+        return edge_t(r, s, c, false);
+    }
+};
+
+template <class BGraph>
+constexpr uint32_t emat_code<BGraph>::null;
+template <class BGraph>
+constexpr uint32_t emat_code<BGraph>::inv;
+
+// dense layout (it is simply an adjacency matrix)
 
 template <class BGraph>
 class EMat
 {
 public:
+    EMat() {}
+
     template <class RNG>
     EMat(BGraph& bg, RNG&)
     {
         sync(bg);
     }
 
+    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+    typedef emat_code<BGraph> code_t;
+
     void sync(BGraph& bg)
     {
         size_t B = num_vertices(bg);
         _mat.resize(boost::extents[B][B]);
-        std::fill(_mat.data(), _mat.data() + _mat.num_elements(), _null_edge);
+        std::fill(_mat.data(), _mat.data() + _mat.num_elements(),
+                  code_t::null);
 
         for (auto e : edges_range(bg))
         {
             assert(get_me(source(e, bg),target(e, bg)) == _null_edge);
-            _mat[source(e, bg)][target(e, bg)] = e;
-            if (!is_directed::apply<BGraph>::type::value)
-                _mat[target(e, bg)][source(e, bg)] = e;
+            put_me(source(e, bg), target(e, bg), e);
         }
     }
 
-    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
-    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+    void clear()
+    {
+        _mat.resize(boost::extents[0][0]);
+    }
 
-    const auto& get_me(vertex_t r, vertex_t s) const
+    edge_t get_me(vertex_t r, vertex_t s) const
     {
-        return _mat[r][s];
+        return code_t::decode(r, s, _mat[r][s]);
     }
 
     void put_me(vertex_t r, vertex_t s, const edge_t& e)
     {
-        _mat[r][s] = e;
+        _mat[r][s] = code_t::encode(r, e);
         if (!is_directed::apply<BGraph>::type::value && r != s)
-            _mat[s][r] = e;
+            _mat[s][r] = code_t::encode(s, e);
     }
 
     void remove_me(const edge_t& me, BGraph& bg)
     {
         auto r = source(me, bg);
         auto s = target(me, bg);
-        _mat[r][s] = _null_edge;
+        _mat[r][s] = code_t::null;
         if (!is_directed::apply<BGraph>::type::value)
-            _mat[s][r] = _null_edge;
+            _mat[s][r] = code_t::null;
         remove_edge(me, bg);
     }
 
     const auto& get_null_edge() const { return _null_edge; }
 
 private:
-    multi_array<edge_t, 2> _mat;
+    multi_array<uint32_t, 2> _mat;
     static const edge_t _null_edge;
 };
 
 template <class BGraph>
 const typename EMat<BGraph>::edge_t EMat<BGraph>::_null_edge;
 
-
-template <class Key>
-class perfect_hash_t
-{
-public:
-    template <class RNG>
-    perfect_hash_t(size_t N, RNG& rng)
-        : _index(std::make_shared<std::vector<size_t>>())
-    {
-        auto& index = *_index;
-        index.reserve(N);
-        for (size_t i = 0; i < N; ++i)
-            index.push_back(i);
-        std::shuffle(index.begin(), index.end(), rng);
-    }
-    perfect_hash_t() {}
-    size_t operator()(const Key& k) const {return (*_index)[k];}
-private:
-    std::shared_ptr<std::vector<size_t>> _index;
-};
-
-// this structure speeds up the access to the edges between given blocks, since
-// we're using an adjacency list to store the block structure (this is like
-// EMat above, but takes less space and is slower)
+// sparse layout: a single open-addressing table with linear probing over the
+// (r, s) pairs, with 16-byte slots (four per cache line) and a load factor of
+// at most 1/2. Removals shift the following entries back, so that no
+// tombstones accumulate as block-graph edges are created and destroyed.
 
 template <class BGraph>
 class EHash
 {
 public:
+    EHash()
+    {
+        clear();
+    }
 
     template <class RNG>
-    EHash(BGraph& bg, RNG& rng)
-        : _hash_function(num_vertices(bg), rng),
-          _hash(num_vertices(bg), ehash_t(0, _hash_function))
+    EHash(BGraph& bg, RNG&)
     {
         sync(bg);
     }
 
+    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+    typedef emat_code<BGraph> code_t;
+
     void sync(BGraph& bg)
     {
-        _hash.clear();
-        _hash.resize(num_vertices(bg), ehash_t(0, _hash_function));
-        for (auto& h : _hash)
-            h.max_load_factor(.3);
+        clear();
+        rehash(2 * num_edges(bg));
 
         for (auto e : edges_range(bg))
         {
@@ -959,27 +1015,37 @@ public:
         }
     }
 
-    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
-    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+    void clear()
+    {
+        _table.clear();
+        _table.shrink_to_fit();
+        _size = 0;
+        rehash(0);
+    }
 
     __attribute__((flatten))
-    const auto& get_me(vertex_t r, vertex_t s) const
+    edge_t get_me(vertex_t r, vertex_t s) const
     {
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        auto& map = _hash[r];
-        const auto& iter = map.find(s);
-        if (iter == map.end())
-            return _null_edge;
-        return iter->second;
+        auto key = get_key(r, s);
+        for (size_t i = get_pos(key); ; i = (i + 1) & _mask)
+        {
+            const auto& slot = _table[i];
+            if (slot.key == key)
+                return code_t::decode(r, s, slot.code);
+            if (slot.key == _empty)
+                return _null_edge;
+        }
     }
 
     void put_me(vertex_t r, vertex_t s, const edge_t& e)
     {
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        assert(r < _hash.size());
-        _hash[r][s] = e;
+        if (2 * (_size + 1) > _table.size())
+            rehash(_table.size());
+        insert(get_key(r, s), code_t::encode(r, e));
     }
 
     void remove_me(const edge_t& me, BGraph& bg)
@@ -988,23 +1054,175 @@ public:
         auto s = target(me, bg);
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        assert(r < _hash.size());
-        _hash[r].erase(s);
+        erase(get_key(r, s));
         remove_edge(me, bg);
     }
 
     const auto& get_null_edge() const { return _null_edge; }
 
 private:
-    perfect_hash_t<vertex_t> _hash_function;
-    typedef gt_hash_map<vertex_t, edge_t, perfect_hash_t<vertex_t>> ehash_t;
-    std::vector<ehash_t> _hash;
+    static constexpr uint64_t _empty = std::numeric_limits<uint64_t>::max();
+
+    struct slot_t
+    {
+        uint64_t key = _empty;
+        uint32_t code = code_t::null;
+    };
+
+    static uint64_t get_key(vertex_t r, vertex_t s)
+    {
+        assert(r < (uint64_t(1) << 32) && s < (uint64_t(1) << 32));
+        return (uint64_t(r) << 32) | uint64_t(s);
+    }
+
+    size_t get_pos(uint64_t key) const
+    {
+        return (key * 0x9e3779b97f4a7c15ULL) >> _shift;
+    }
+
+    // resize the table to the smallest power of two (but at least 8) that is
+    // larger than n, and reinsert all entries
+    void rehash(size_t n)
+    {
+        size_t bits = 3;
+        while ((size_t(1) << bits) <= n)
+            ++bits;
+        std::vector<slot_t> old(size_t(1) << bits);
+        _table.swap(old);
+        _mask = _table.size() - 1;
+        _shift = 64 - bits;
+        _size = 0;
+        for (auto& slot : old)
+        {
+            if (slot.key != _empty)
+                insert(slot.key, slot.code);
+        }
+    }
+
+    void insert(uint64_t key, uint32_t code)
+    {
+        size_t i = get_pos(key);
+        while (_table[i].key != _empty && _table[i].key != key)
+            i = (i + 1) & _mask;
+        if (_table[i].key == _empty)
+            _size++;
+        _table[i].key = key;
+        _table[i].code = code;
+    }
+
+    void erase(uint64_t key)
+    {
+        size_t i = get_pos(key);
+        while (_table[i].key != key)
+        {
+            if (_table[i].key == _empty)
+                return;
+            i = (i + 1) & _mask;
+        }
+
+        // move back every following entry of the same cluster whose home
+        // position is not cyclically in (i, j]
+        for (size_t j = (i + 1) & _mask; _table[j].key != _empty;
+             j = (j + 1) & _mask)
+        {
+            size_t k = get_pos(_table[j].key);
+            if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)))
+            {
+                _table[i] = _table[j];
+                i = j;
+            }
+        }
+        _table[i] = slot_t();
+        _size--;
+    }
+
+    std::vector<slot_t> _table;
+    size_t _mask;
+    size_t _shift;
+    size_t _size;
     static const edge_t _null_edge;
 };
 
+template <class BGraph>
+constexpr uint64_t EHash<BGraph>::_empty;
+
 template <class BGraph>
 const typename EHash<BGraph>::edge_t EHash<BGraph>::_null_edge;
 
+// this chooses between the dense and sparse layouts above, according to the
+// size and density of the block graph; the choice is made again every time it
+// is synced, so it follows the number of blocks as it changes
+
+template <class BGraph>
+class EAdaptive
+{
+public:
+    template <class RNG>
+    EAdaptive(BGraph& bg, RNG&)
+    {
+        sync(bg);
+    }
+
+    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
+
+    // the dense matrix takes 4 * B^2 bytes and the table between 32 and 64
+    // bytes per block-graph edge; small matrices are always dense
+    static constexpr size_t max_dense_B = 1 << 10;
+
+    void sync(BGraph& bg)
+    {
+        size_t B = num_vertices(bg);
+        _dense = (B <= max_dense_B || B * B <= 12 * num_edges(bg));
+        if (_dense)
+        {
+            _hash.clear();
+            _mat.sync(bg);
+        }
+        else
+        {
+            _mat.clear();
+            _hash.sync(bg);
+        }
+    }
+
+    __attribute__((flatten))
+    edge_t get_me(vertex_t r, vertex_t s) const
+    {
+        if (_dense)
+            return _mat.get_me(r, s);
+        return _hash.get_me(r, s);
+    }
+
+    void put_me(vertex_t r, vertex_t s, const edge_t& e)
+    {
+        if (_dense)
+            _mat.put_me(r, s, e);
+        else
+            _hash.put_me(r, s, e);
+    }
+
+    void remove_me(const edge_t& me, BGraph& bg)
+    {
+        if (_dense)
+            _mat.remove_me(me, bg);
+        else
+            _hash.remove_me(me, bg);
+    }
+
+    const auto& get_null_edge() const { return _mat.get_null_edge(); }
+
+    bool is_dense() const { return _dense; }
+
+private:
+    bool _dense;
+    EMat<BGraph> _mat;
+    EHash<BGraph> _hash;
+};
+
+template <class BGraph>
+constexpr size_t EAdaptive<BGraph>::max_dense_B;
+
 template <class Vertex, class Eprop, class Emat, class BEdge>
 inline auto get_beprop(Vertex r, Vertex s, const Eprop& eprop, const Emat& emat,
                        BEdge& me)
@@ -1024,6 +1242,68 @@ inline auto get_beprop(Vertex r, Vertex s, const Eprop& eprop, const Emat& emat)
     return get_beprop(r, s, eprop, emat, me);
 }
 
+// Tally of the edge weights between a vertex and the blocks of its
+// neighbours, kept in contiguous arrays, so that the moves of the vertex to
+// many candidate blocks can be evaluated in a single pass (see
+// BlockState::virtual_moves())
+
+class NeighbourBlocks
+{
+public:
+    void clear()
+    {
+        for (auto t : _blocks)
+            _pos[t] = 0;
+        _blocks.clear();
+        _kout.clear();
+        _kin.clear();
+    }
+
+    void add(size_t t, int kout, int kin)
+    {
+        if (t >= _pos.size())
+            _pos.resize(t + 1, 0);
+        auto& pos = _pos[t];
+        if (pos == 0)
+        {
+            _blocks.push_back(t);
+            _kout.push_back(0);
+            _kin.push_back(0);
+            pos = _blocks.size();
+        }
+        _kout[pos - 1] += kout;
+        _kin[pos - 1] += kin;
+    }
+
+    // position of block t in the arrays, or
+    // numeric_limits<size_t>::max() if it is not a neighbour
+    size_t get_pos(size_t t) const
+    {
+        if (t >= _pos.size() || _pos[t] == 0)
+            return numeric_limits<size_t>::max();
+        return _pos[t] - 1;
+    }
+
+    int get_kout(size_t t) const
+    {
+        size_t j = get_pos(t);
+        return (j < _blocks.size()) ? _kout[j] : 0;
+    }
+
+    int get_kin(size_t t) const
+    {
+        size_t j = get_pos(t);
+        return (j < _blocks.size()) ? _kin[j] : 0;
+    }
+
+    std::vector<size_t> _blocks;
+    std::vector<int> _kout;
+    std::vector<int> _kin;
+    std::vector<double> _dS_r;
+
+private:
+    std::vector<size_t> _pos;
+};
 
 // Manage a set of block pairs and corresponding edge counts that will be
 // updated
@@ -1197,7 +1477,7 @@ public:
     }
 
     template <class Emat>
-    const bedge_t& get_me(size_t r, size_t s, Emat& emat)
+    bedge_t get_me(size_t r, size_t s, Emat& emat)
     {
         size_t field = get_field(r, s);
         if (field >= _mes.size())
@@ -1206,6 +1486,7 @@ public:
     }
 
     std::tuple<EVals...> _self_weight;
+    NeighbourBlocks _nblocks;
 
 private:
     static constexpr size_t _null = numeric_limits<size_t>::max();
@@ -1602,6 +1883,75 @@ void collect_vertex_marginals(Vprop b, VVprop p, Graph& g)
     }
 }
 
+// ================
+// Binary snapshots
+// ================
+
+// Flat, native-endian buffers used to save and restore the state of a
+// blockmodel without going through Python objects.
+
+class snapshot_writer
+{
+public:
+    template <class T>
+    void put(T x)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only trivially copyable values can be written");
+        _buf.append(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+
+    template <class T>
+    void put_vector(const std::vector<T>& v)
+    {
+        put<uint32_t>(v.size());
+        for (auto& x : v)
+            put<T>(x);
+    }
+
+    std::string& get_buffer() { return _buf; }
+
+private:
+    std::string _buf;
+};
+
+class snapshot_reader
+{
+public:
+    snapshot_reader(const std::string& buf)
+        : _buf(buf), _pos(0) {}
+
+    template <class T>
+    T get()
+    {
+        if (_pos + sizeof(T) > _buf.size())
+            throw ValueException("truncated snapshot");
+        T x;
+        std::memcpy(&x, _buf.data() + _pos, sizeof(T));
+        _pos += sizeof(T);
+        return x;
+    }
+
+    template <class T>
+    void get_vector(std::vector<T>& v)
+    {
+        size_t n = get<uint32_t>();
+        if (n > remaining() / sizeof(T))
+            throw ValueException("truncated snapshot");
+        v.resize(n);
+        for (auto& x : v)
+            x = get<T>();
+    }
+
+    bool done() const { return _pos == _buf.size(); }
+
+    size_t remaining() const { return _buf.size() - _pos; }
+
+private:
+    const std::string& _buf;
+    size_t _pos;
+};
+
 } // graph_tool namespace
 
 #endif //GRAPH_BLOCKMODEL_UTIL_HH
@@ -112,7 +112,6 @@ auto mcmc_sweep_parallel(MCMCState state, RNG& rng_)
     std::vector<std::pair<size_t, double>> best_move;
 
     init_rngs(rngs, rng_);
-    init_cache(state._E);
     best_move.resize(num_vertices(g));
 
     auto& vlist = state._vlist;
@@ -181,6 +180,145 @@ auto mcmc_sweep_parallel(MCMCState state, RNG& rng_)
     return make_pair(S, nmoves);
 }
 
+// Like mcmc_sweep_parallel(), but accepted moves whose footprints (the blocks
+// they touch, as given by move_footprint()) do not overlap are committed
+// concurrently, and their entropy differences are kept as computed, since no
+// other move in the same round can have changed them. Only the remaining
+// moves, and those that perform_move_local() refuses, are re-evaluated and
+// committed serially.
+template <class MCMCState, class RNG>
+auto mcmc_sweep_async(MCMCState state, RNG& rng_)
+{
+    auto& g = state._g;
+
+    vector<std::shared_ptr<RNG>> rngs;
+    std::vector<std::pair<size_t, double>> best_move;
+    std::vector<size_t> claim;
+    std::vector<size_t> local_moves, serial_moves;
+    std::vector<uint8_t> done;
+
+    init_rngs(rngs, rng_);
+    best_move.resize(num_vertices(g));
+
+    auto& vlist = state._vlist;
+    auto& beta = state._beta;
+
+    double S = 0;
+    size_t nmoves = 0;
+
+    for (size_t iter = 0; iter < state._niter; ++iter)
+    {
+        parallel_loop(vlist,
+                      [&](size_t, auto v)
+                      {
+                          best_move[v] =
+                              std::make_pair(state.node_state(v),
+                                             numeric_limits<double>::max());
+                      });
+
+        #pragma omp parallel firstprivate(state)
+        parallel_loop_no_spawn
+            (vlist,
+             [&](size_t, auto v)
+             {
+                 auto& rng = get_rng(rngs, rng_);
+
+                 if (state.node_weight(v) == 0)
+                     return;
+
+                 auto r = state.node_state(v);
+                 auto s = state.move_proposal(v, rng);
+
+                 if (s == r)
+                     return;
+
+                 double dS, mP;
+                 std::tie(dS, mP) = state.virtual_move_dS(v, s);
+
+                 if (metropolis_accept(dS, mP, beta, rng))
+                 {
+                     best_move[v].first = s;
+                     best_move[v].second = dS;
+                 }
+
+                 if (state._verbose)
+                     cout << v << ": " << r << " -> " << s << " " << S << endl;
+             });
+
+        // greedily select a set of accepted moves with disjoint footprints;
+        // claim[t] holds the last iteration + 1 in which block t was claimed
+        local_moves.clear();
+        serial_moves.clear();
+        for (auto v : vlist)
+        {
+            auto s = best_move[v].first;
+            if (best_move[v].second == numeric_limits<double>::max())
+                continue;
+
+            bool free = true;
+            state.move_footprint(v, s,
+                                 [&](size_t t)
+                                 {
+                                     if (t < claim.size() &&
+                                         claim[t] == iter + 1)
+                                         free = false;
+                                 });
+            if (!free)
+            {
+                serial_moves.push_back(v);
+                continue;
+            }
+
+            state.move_footprint(v, s,
+                                 [&](size_t t)
+                                 {
+                                     if (t >= claim.size())
+                                         claim.resize(t + 1, 0);
+                                     claim[t] = iter + 1;
+                                 });
+            local_moves.push_back(v);
+        }
+
+        done.clear();
+        done.resize(local_moves.size(), false);
+
+        double lS = 0;
+        size_t lmoves = 0;
+        #pragma omp parallel firstprivate(state) reduction(+:lS, lmoves)
+        parallel_loop_no_spawn
+            (local_moves,
+             [&](size_t i, auto v)
+             {
+                 if (!state.perform_move_local(v, best_move[v].first))
+                     return;
+                 done[i] = true;
+                 lmoves++;
+                 lS += best_move[v].second;
+             });
+        S += lS;
+        nmoves += lmoves;
+
+        for (size_t i = 0; i < local_moves.size(); ++i)
+        {
+            if (!done[i])
+                serial_moves.push_back(local_moves[i]);
+        }
+
+        for (auto v : serial_moves)
+        {
+            auto s = best_move[v].first;
+            auto ddS = state.virtual_move_dS(v, s);
+
+            if (get<0>(ddS) > 0 && std::isinf(beta))
+                continue;
+
+            state.perform_move(v, s);
+            nmoves++;
+            S += get<0>(ddS);
+        }
+    }
+    return make_pair(S, nmoves);
+}
 
 } // graph_tool namespace
 
@@ -41,7 +41,6 @@ auto merge_sweep(MergeState state, RNG& rng_)
     if (state._parallel)
     {
         init_rngs(rngs, rng_);
-        init_cache(state._E);
     }
 
     typedef std::tuple<size_t, size_t, double> merge_t;
@@ -99,31 +98,125 @@ auto merge_sweep(MergeState state, RNG& rng_)
     for (auto& merge : best_merge)
         queue.push(merge);
 
+    // The queue is drained in rounds. In each round, the best candidates are
+    // popped in a batch and their (possibly stale) dS values are refreshed in
+    // parallel. The batch is then committed in increasing order of dS, with
+    // each merge being accepted under the same lazy greedy criterion as
+    // before. Merges that touch the neighbourhood of a previous merge in the
+    // same round are returned to the queue, to be refreshed in the next
+    // round. Without parallelism, the batch has size one, and this reduces to
+    // the usual lazy evaluation.
+
+    // thread-local copies of the state are kept across rounds, to avoid
+    // copying the move entries at every round
+    std::vector<std::shared_ptr<MergeState>> states;
+    size_t nbatch = 1;
+#ifdef USING_OPENMP
+    if (state._parallel)
+    {
+        size_t nthreads = omp_get_max_threads();
+        for (size_t i = 0; i < nthreads; ++i)
+            states.push_back(std::make_shared<MergeState>(state));
+        nbatch = 4 * nthreads;
+    }
+#endif
+
+    std::vector<merge_t> batch;
+    std::vector<size_t> touched(num_vertices(state._g), 0);
+
+    auto is_touched = [&](size_t v, size_t s, size_t round)
+        {
+            bool ret = false;
+            state.merge_footprint(v, s,
+                                  [&](size_t u)
+                                  {
+                                      if (touched[u] == round)
+                                          ret = true;
+                                  });
+            return ret;
+        };
+
     double S = 0;
     size_t nmerges = 0;
+    size_t round = 0;
     while (nmerges != state._nmerges && !queue.empty())
     {
-        auto merge = queue.top();
-        queue.pop();
-
-        auto v = state.get_root(get<0>(merge));
-        auto s = state.get_root(get<1>(merge));
-        double dS = get<2>(merge);
-        if (v == s || dS == numeric_limits<double>::max())
-            continue;
-        double ndS = state.virtual_move_dS(v, s);
-        if (!queue.empty() && ndS > get<2>(queue.top()))
+        round++;
+
+        batch.clear();
+        while (batch.size() < nbatch && !queue.empty())
         {
-            get<2>(merge) = ndS;
-            queue.push(merge);
-            continue;
+            auto merge = queue.top();
+            queue.pop();
+            auto v = state.get_root(get<0>(merge));
+            auto s = state.get_root(get<1>(merge));
+            if (v == s || get<2>(merge) == numeric_limits<double>::max())
+                continue;
+            batch.emplace_back(v, s, get<2>(merge));
         }
-        if (state._verbose)
-            cout << "merging " << v << " -> " << s << " : "
-                 << dS << " " << ndS << endl;
-        state.perform_merge(v, s);
-        S += ndS;
-        nmerges++;
+
+        std::vector<double> ndS(batch.size());
+
+        #pragma omp parallel if (!states.empty() && batch.size() > 1)
+        parallel_loop_no_spawn
+            (batch,
+             [&](size_t i, auto& merge)
+             {
+                 auto* s = &state;
+#ifdef USING_OPENMP
+                 if (!states.empty())
+                     s = states[omp_get_thread_num()].get();
+#endif
+                 ndS[i] = s->virtual_move_dS(get<0>(merge), get<1>(merge));
+             });
+
+        for (size_t i = 0; i < batch.size(); ++i)
+            get<2>(batch[i]) = ndS[i];
+        std::sort(batch.begin(), batch.end(),
+                  [](auto& a, auto& b) { return get<2>(a) < get<2>(b); });
+
+        size_t pos = 0;
+        bool changed = false;
+        for (; pos < batch.size(); ++pos)
+        {
+            if (nmerges == state._nmerges)
+                break;
+
+            auto& merge = batch[pos];
+            auto v = get<0>(merge);
+            auto s = get<1>(merge);
+
+            if (changed)
+            {
+                // the state was modified by a previous merge in this round,
+                // hence the refreshed values are no longer exact
+                if (state.get_root(v) != v || state.get_root(s) != s ||
+                    is_touched(v, s, round))
+                {
+                    queue.push(merge);
+                    continue;
+                }
+                get<2>(merge) = state.virtual_move_dS(v, s);
+            }
+
+            double dS = get<2>(merge);
+            if ((!queue.empty() && dS > get<2>(queue.top())) ||
+                (pos + 1 < batch.size() && dS > get<2>(batch[pos + 1])))
+                break;
+
+            if (state._verbose)
+                cout << "merging " << v << " -> " << s << " : "
+                     << dS << endl;
+
+            state.merge_footprint(v, s, [&](size_t u) { touched[u] = round; });
+            state.perform_merge(v, s);
+            S += dS;
+            nmerges++;
+            changed = true;
+        }
+
+        for (; pos < batch.size(); ++pos)
+            queue.push(batch[pos]);
     }
 
     // collapse merge tree
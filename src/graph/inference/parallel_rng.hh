@@ -21,13 +21,9 @@
 #include <vector>
 
 template <class RNG>
-void init_rngs(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
+void init_rngs(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng, size_t n)
 {
-    size_t num_threads = 1;
-#ifdef USING_OPENMP
-    num_threads = omp_get_max_threads();
-#endif
-    for (size_t i = 0; i < num_threads; ++i)
+    for (size_t i = 0; i < n; ++i)
     {
         std::array<int, RNG::state_size> seed_data;
         std::generate_n(seed_data.data(), seed_data.size(), std::ref(rng));
@@ -36,6 +32,16 @@ void init_rngs(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
     }
 }
 
+template <class RNG>
+void init_rngs(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
+{
+    size_t num_threads = 1;
+#ifdef USING_OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    init_rngs(rngs, rng, num_threads);
+}
+
 template <class RNG>
 RNG& get_rng(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
 {
@@ -0,0 +1,106 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TEMPERING_LOOP_HH
+#define TEMPERING_LOOP_HH
+
+#include "config.h"
+
+#include <iostream>
+#include <tuple>
+
+#include "parallel_rng.hh"
+#include "mcmc_loop.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+namespace graph_tool
+{
+
+// Parallel tempering over a set of replicas, where states[i] is initially at
+// inverse temperature states[i]->_beta, and has entropy S[i]. At each of the
+// niter rounds, all replicas are swept concurrently, each with its own RNG,
+// and then swaps between neighbouring temperatures are attempted, in random
+// order. Swaps exchange the inverse temperatures of the replicas, not their
+// partitions; upon return, idx[i] is the replica at the i-th temperature.
+template <class MCMCState, class RNG>
+auto tempering_sweep(std::vector<MCMCState*>& states, std::vector<double>& S,
+                     std::vector<size_t>& idx, size_t niter, RNG& rng_)
+{
+    size_t N = states.size();
+
+    std::vector<double> betas(N);
+    idx.resize(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        betas[i] = states[i]->_beta;
+        idx[i] = i;
+    }
+
+    auto get_S = [&]()
+        {
+            double S_w = 0;
+            for (size_t i = 0; i < N; ++i)
+                S_w += betas[i] * S[idx[i]];
+            return S_w;
+        };
+
+    // one RNG per replica, so that the outcome does not depend on the
+    // scheduling of the threads
+    std::vector<std::shared_ptr<RNG>> rngs;
+    init_rngs(rngs, rng_, N);
+
+    std::vector<size_t> pairs;
+    for (size_t i = 0; i + 1 < N; ++i)
+        pairs.push_back(i);
+
+    double S_i = get_S();
+    size_t nmoves = 0;
+    size_t nswaps = 0;
+
+    for (size_t iter = 0; iter < niter; ++iter)
+    {
+        #pragma omp parallel for schedule(runtime) reduction(+:nmoves)
+        for (size_t j = 0; j < N; ++j)
+        {
+            auto ret = mcmc_sweep(*states[j], *rngs[j]);
+            S[j] += ret.first;
+            nmoves += ret.second;
+        }
+
+        std::shuffle(pairs.begin(), pairs.end(), rng_);
+        for (auto i : pairs)
+        {
+            size_t r = idx[i];
+            size_t s = idx[i + 1];
+            double dS = -(betas[i] - betas[i + 1]) * (S[r] - S[s]);
+            if (!metropolis_accept(dS, 0, 1., rng_))
+                continue;
+            std::swap(idx[i], idx[i + 1]);
+            states[r]->_beta = betas[i + 1];
+            states[s]->_beta = betas[i];
+            nswaps++;
+        }
+    }
+
+    return std::make_tuple(get_S() - S_i, nmoves, nswaps);
+}
+
+} // graph_tool namespace
+
+#endif //TEMPERING_LOOP_HH
@@ -28,6 +28,7 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_multi_bfs.hh"
 
 namespace graph_tool
 {
@@ -50,6 +51,49 @@ struct get_val_type<no_weightS>
     typedef size_t type;
 };
 
+// Distance histogram of all the vertices reachable from the given sources in
+// an unweighted graph, obtained with multi-source BFS.
+template <class Graph, class Vertex>
+python::object get_bfs_distance_histogram(const Graph& g,
+                                          const vector<Vertex>& sources,
+                                          const vector<long double>& obins)
+{
+    typedef Histogram<size_t, size_t, 1> hist_t;
+
+    std::array<vector<size_t>,1> bins;
+    bins[0].resize(obins.size());
+    for (size_t i = 0; i < obins.size(); ++i)
+        bins[0][i] = obins[i];
+
+    hist_t hist(bins);
+    SharedHistogram<hist_t> s_hist(hist);
+
+    typename hist_t::point_t point;
+    #pragma omp parallel if (num_vertices(g) * sources.size() > \
+                             OPENMP_MIN_THRESH) firstprivate(s_hist) \
+        private(point)
+    {
+        multi_source_bfs_batches_no_spawn
+            (g, sources,
+             [&](auto& bfs, auto begin, auto end)
+             {
+                 typedef std::remove_reference_t<decltype(bfs)> bfs_t;
+                 bfs.run(g, begin, end,
+                         [&](auto, const auto& bits, size_t d)
+                         {
+                             point[0] = d;
+                             s_hist.put_value(point, bfs_t::count(bits));
+                         });
+             });
+        s_hist.gather();
+    }
+
+    python::list ret;
+    ret.append(wrap_multi_array_owned<size_t,1>(hist.get_array()));
+    ret.append(wrap_vector_owned<size_t>(hist.get_bins()[0]));
+    return ret;
+}
+
 struct get_distance_histogram
 {
 
@@ -58,13 +102,6 @@ struct get_distance_histogram
                     const vector<long double>& obins, python::object& phist)
         const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
         typedef Histogram<val_type, size_t, 1> hist_t;
@@ -78,7 +115,7 @@ struct get_distance_histogram
         SharedHistogram<hist_t> s_hist(hist);
 
         typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
+        get_dists_djk get_vertex_dists;
 
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
             firstprivate(s_hist)
@@ -113,6 +150,21 @@ struct get_distance_histogram
         phist = ret;
     }
 
+    // unweighted version, with many sources searched at once
+    template <class Graph, class VertexIndex>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    const vector<long double>& obins, python::object& phist)
+        const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        vector<vertex_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+
+        phist = get_bfs_distance_histogram(g, sources, obins);
+    }
+
     // weighted version. Use dijkstra_shortest_paths()
     struct get_dists_djk
     {
@@ -125,29 +177,6 @@ struct get_distance_histogram
                                     weight_map(weights).distance_map(dist_map));
         }
     };
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
-        {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
-        }
-    };
 };
 
 } // boost namespace
@@ -28,6 +28,7 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_distance.hh"
 
 namespace graph_tool
 {
@@ -36,20 +37,6 @@ using namespace boost;
 
 // retrieves the sampled vertex-vertex distance histogram
 
-struct no_weightS {};
-
-template <class Map>
-struct get_val_type
-{
-    typedef typename property_traits<Map>::value_type type;
-};
-
-template <>
-struct get_val_type<no_weightS>
-{
-    typedef size_t type;
-};
-
 struct get_sampled_distance_histogram
 {
 
@@ -60,11 +47,6 @@ struct get_sampled_distance_histogram
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
 
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
@@ -85,7 +67,7 @@ struct get_sampled_distance_histogram
         n_samples = min(n_samples, sources.size());
 
         typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
+        get_dists_djk get_vertex_dists;
 
         #pragma omp parallel for default(shared) private(point) \
             firstprivate(s_hist) schedule(runtime) \
@@ -128,6 +110,31 @@ struct get_sampled_distance_histogram
         phist = ret;
     }
 
+    // unweighted version, with many sources searched at once
+    template <class Graph, class VertexIndex, class RNG>
+    void operator()(const Graph& g, VertexIndex, no_weightS, size_t n_samples,
+                    const vector<long double>& obins, python::object& phist,
+                    RNG& rng) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        vector<vertex_t> sources;
+        sources.reserve(num_vertices(g));
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+        n_samples = min(n_samples, sources.size());
+
+        // partial shuffle; the first n_samples vertices are the sample
+        for (size_t i = 0; i < n_samples; ++i)
+        {
+            uniform_int_distribution<size_t> randint(i, sources.size() - 1);
+            swap(sources[i], sources[randint(rng)]);
+        }
+        sources.resize(n_samples);
+
+        phist = get_bfs_distance_histogram(g, sources, obins);
+    }
+
     // weighted version. Use dijkstra_shortest_paths()
     struct get_dists_djk
     {
@@ -140,31 +147,6 @@ struct get_sampled_distance_histogram
                                     weight_map(weights).distance_map(dist_map));
         }
     };
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
-        {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef typename vprop_map_t<default_color_type>::type::unchecked_t vmap_t;
-            vmap_t color_map(vertex_index, num_vertices(g));
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     color_map[v] = color_traits<default_color_type>::white();
-                 });
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
-        }
-    };
 };
 
 } // boost namespace
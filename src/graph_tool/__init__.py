@@ -141,7 +141,8 @@ from inspect import ismethod
 __all__ = ["Graph", "GraphView", "Vertex", "Edge", "VertexBase", "EdgeBase",
            "Vector_bool", "Vector_int16_t", "Vector_int32_t", "Vector_int64_t",
            "Vector_double", "Vector_long_double", "Vector_string",
-           "Vector_size_t", "value_types", "load_graph", "load_graph_from_csv",
+           "Vector_size_t", "MutationBatch", "value_types", "load_graph",
+           "load_graph_from_csv",
            "PropertyMap", "PropertyArray", "group_vector_property",
            "ungroup_vector_property", "map_property_values",
            "infect_vertex_property", "edge_endpoint_property",
@@ -1777,6 +1778,92 @@ class Graph(object):
         """
         return libcore.get_edges(self.__graph)
 
+    def get_vertices(self):
+        """Return a :class:`numpy.ndarray` with the vertex indexes.
+
+        .. note::
+
+           The order of the vertices is the same as the one given by
+           :meth:`~graph_tool.Graph.vertices`. Filtered vertices are not
+           included.
+
+        """
+        return libcore.get_vertex_list(self.__graph)
+
+    def get_edges(self):
+        """Return a :class:`numpy.ndarray` of shape ``(E, 3)`` with the
+        source, target and index of every edge.
+
+        .. note::
+
+           The order of the edges is the same as the one given by iterating
+           over the out-edges of each vertex, in the order of the vertex
+           indexes. Filtered vertices and edges are not included.
+
+        """
+        return libcore.get_edge_list(self.__graph)
+
+    def get_out_neighbours(self, v):
+        """Return a :class:`numpy.ndarray` with the out-neighbours of vertex
+        ``v``."""
+        return libcore.get_out_neighbors_list(self.__graph, int(v))
+
+    def get_in_neighbours(self, v):
+        """Return a :class:`numpy.ndarray` with the in-neighbours of vertex
+        ``v``. For undirected graphs, this is the same as
+        :meth:`~graph_tool.Graph.get_out_neighbours`."""
+        return libcore.get_in_neighbors_list(self.__graph, int(v))
+
+    @_limit_args({"mode": ["out", "in"]})
+    def get_csr(self, mode="out"):
+        """Return the out- (or in-) adjacency of the graph in compressed sparse
+        row (CSR) format, as a tuple ``(indptr, indices, eindex)`` of
+        :class:`numpy.ndarray` objects. The neighbours of vertex ``v`` are
+        given by ``indices[indptr[v]:indptr[v+1]]``, and the indexes of the
+        corresponding edges by ``eindex[indptr[v]:indptr[v+1]]``.
+
+        The rows are indexed by the vertex indexes, so that filtered vertices
+        correspond to empty rows. For undirected graphs, each edge appears in
+        the rows of both its endpoints.
+
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> g.add_edge_list([(0, 1), (0, 2), (2, 1)])
+        >>> indptr, indices, eindex = g.get_csr()
+        >>> print(indptr, indices)
+        [0 2 2 3] [1 2 1]
+
+        """
+        return libcore.get_csr(self.__graph, mode == "in")
+
+    def get_out_degrees(self, vs, eweight=None):
+        """Return a :class:`numpy.ndarray` with the out-degrees of the vertices
+        with indexes given by ``vs``. If provided, ``eweight`` should be an edge
+        :class:`~graph_tool.PropertyMap` containing the edge weights which
+        should be summed."""
+        return libcore.get_degree_list(self.__graph,
+                                       numpy.asarray(vs, dtype="int64"),
+                                       "out", _prop("e", self, eweight))
+
+    def get_in_degrees(self, vs, eweight=None):
+        """Return a :class:`numpy.ndarray` with the in-degrees of the vertices
+        with indexes given by ``vs``. If provided, ``eweight`` should be an edge
+        :class:`~graph_tool.PropertyMap` containing the edge weights which
+        should be summed."""
+        return libcore.get_degree_list(self.__graph,
+                                       numpy.asarray(vs, dtype="int64"),
+                                       "in", _prop("e", self, eweight))
+
+    def get_total_degrees(self, vs, eweight=None):
+        """Return a :class:`numpy.ndarray` with the total degrees of the
+        vertices with indexes given by ``vs``. If provided, ``eweight`` should
+        be an edge :class:`~graph_tool.PropertyMap` containing the edge weights
+        which should be summed."""
+        return libcore.get_degree_list(self.__graph,
+                                       numpy.asarray(vs, dtype="int64"),
+                                       "total", _prop("e", self, eweight))
+
     def add_vertex(self, n=1):
         """Add a vertex to the graph, and return it. If ``n != 1``, ``n``
         vertices are inserted and an iterator over the new vertices is returned.
@@ -1873,6 +1960,27 @@ class Graph(object):
         else:
             libcore.remove_vertex(self.__graph, vertex, fast)
 
+    def mutation_batch(self, reindex_edges=False):
+        r"""Return a :class:`~graph_tool.MutationBatch` object, which collects
+        vertex and edge insertions and removals, and applies them to the graph
+        all at once. If ``reindex_edges == True``, the edges are re-indexed
+        after the batch is applied (see :meth:`~graph_tool.Graph.reindex_edges`).
+
+        The returned object can also be used as a context manager, in which
+        case the modifications are applied when the context exits.
+
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> with g.mutation_batch() as batch:
+        ...     vs = batch.add_vertex(4)
+        ...     batch.add_edge_list([(0, 1), (1, 2), (2, 3), (3, 0)])
+        ...     batch.remove_vertex(0)
+        >>> print(g.num_vertices(), g.num_edges())
+        3 2
+        """
+        return MutationBatch(self, reindex_edges=reindex_edges)
+
     def clear_vertex(self, vertex):
         """Remove all in and out-edges from the given vertex."""
         libcore.clear_vertex(self.__graph, int(vertex))
@@ -1890,22 +1998,43 @@ class Graph(object):
         return e
 
     def remove_edge(self, edge):
-        r"""Remove an edge from the graph.
+        r"""Remove an edge from the graph. If ``edge`` is a
+        :class:`~numpy.ndarray` of shape ``(E, 2)`` or ``(E, 3)``, its rows
+        should contain ``(source, target)`` pairs, or ``(source, target,
+        index)`` triples (as returned by :meth:`~Graph.get_edges`), which
+        specify a batch of edges to be removed. If it is any other iterable,
+        it should correspond to a sequence of edges to be removed.
 
         .. note::
 
-           This operation is normally :math:`O(k_s + k_t)`, where :math:`k_s`
-           and :math:`k_s` are the total degrees of the source and target
-           vertices, respectively. However, if :meth:`~Graph.set_fast_edge_removal`
-           is set to `True`, this operation becomes :math:`O(1)`.
+           This operation is :math:`O(1)`, since the positions of the edges in
+           the adjacency lists are kept up to date (this is the default).
+           If :meth:`~Graph.set_fast_edge_removal` is set to `False`, this
+           operation becomes :math:`O(k_s + k_t)`, where :math:`k_s` and
+           :math:`k_t` are the total degrees of the source and target
+           vertices, respectively.
+
+           When removing a batch of edges given by ``(source, target)`` pairs,
+           the edges of each source vertex are traversed only once. The same
+           happens with the edges of all affected vertices if
+           :meth:`~Graph.set_fast_edge_removal` is set to `False`.
 
         .. warning::
 
-           The relative ordering of the remaining edges in the graph is kept
-           unchanged, unless :meth:`~Graph.set_fast_edge_removal` is set to
-           `True`, in which case it can change.
+           The relative ordering of the remaining edges in the graph may
+           change, unless :meth:`~Graph.set_fast_edge_removal` is set to
+           `False`, in which case it is kept unchanged.
         """
-        return libcore.remove_edge(self.__graph, edge)
+        if isinstance(edge, numpy.ndarray):
+            libcore.remove_edge_list(self.__graph,
+                                     numpy.asarray(edge, dtype="int64"))
+        elif isinstance(edge, EdgeBase):
+            return libcore.remove_edge(self.__graph, edge)
+        else:
+            es = [(int(e.source()), int(e.target()),
+                   int(self.edge_index[e])) for e in edge]
+            libcore.remove_edge_list(self.__graph,
+                                     numpy.array(es, dtype="int64").reshape((-1, 3)))
 
     def add_edge_list(self, edge_list, hashed=False, string_vals=False,
                       eprops=None):
@@ -1959,9 +2088,10 @@ class Graph(object):
 
     def set_fast_edge_removal(self, fast=True):
         r"""If ``fast == True`` the fast :math:`O(1)` removal of edges will be
-        enabled. This requires an additional data structure of size :math:`O(E)`
-        to be kept at all times.  If ``fast == False``, this data structure is
-        destroyed."""
+        enabled (this is the default). This requires an additional data
+        structure of size :math:`O(E)` to be kept at all times.  If ``fast ==
+        False``, this data structure is destroyed, and the relative ordering of
+        the edges is preserved when they are removed."""
         self.__graph.set_keep_epos(fast)
 
     def get_fast_edge_removal(self):
@@ -1969,6 +2099,30 @@ class Graph(object):
         enabled."""
         return self.__graph.get_keep_epos()
 
+    def set_frozen(self, frozen=True, compact=True):
+        r"""If ``frozen == True``, an immutable compressed sparse row (CSR)
+        snapshot of the graph will be kept, and used by read-only algorithms
+        (e.g. :func:`~graph_tool.centrality.pagerank`,
+        :func:`~graph_tool.centrality.closeness` and
+        :func:`~graph_tool.clustering.local_clustering`) when no filtering is
+        active. Since the adjacency lists are stored contiguously in memory,
+        this results in faster traversals for large graphs. This requires an
+        additional data structure of size :math:`O(V + E)`.
+
+        If ``compact == True``, the snapshot will be stored with 32-bit integers
+        whenever the graph has fewer than :math:`2^{32}` vertices and edges,
+        which halves its memory requirement.
+
+        The graph can still be modified, in which case the snapshot will be
+        rebuilt the next time it is used. If ``frozen == False``, the snapshot
+        is destroyed."""
+        self.__graph.set_frozen(frozen, compact)
+
+    def get_frozen(self):
+        r"""Return whether the graph is currently frozen, as set by
+        :meth:`~graph_tool.Graph.set_frozen`."""
+        return self.__graph.get_frozen()
+
     def clear(self):
         """Remove all vertices and edges from the graph."""
         self.__graph.clear()
@@ -2100,16 +2254,32 @@ class Graph(object):
         """
         Reset the edge indexes so that they lie in the [0, :meth:`~graph_tool.Graph.num_edges` - 1]
         range. The index ordering will be compatible with the sequence returned
-        by the :meth:`~graph_tool.Graph.edges` function.
+        by the :meth:`~graph_tool.Graph.edges` function. This operation is
+        :math:`O(V + E)`.
+
+        The values of all existing writable edge property maps are permuted
+        accordingly, so that they remain associated with the same edges.
 
         .. WARNING::
 
-           Calling this function will invalidate all existing edge property
-           maps, if the index ordering is modified! The property maps will still
-           be usable, but their contents will still be tied to the old indexes,
-           and thus may become scrambled.
+           Calling this function will invalidate all existing edge descriptors,
+           and any array of edge indexes obtained before, if the index ordering
+           is modified!
         """
-        self.__graph.re_index_edges()
+        old_index = self.__graph.re_index_edges()
+        # several wrappers may share the same storage (e.g. maps of graph
+        # views), which must be permuted only once
+        done = set()
+        for pmap_ in self.__known_properties.values():
+            pmap = pmap_()
+            if (pmap is not None and pmap.key_type() == "e" and
+                pmap.is_writable()):
+                amap = _prop("e", self, pmap)
+                ptr = pmap.data_ptr()
+                if ptr in done:
+                    continue
+                done.add(ptr)
+                self.__graph.re_index_edge_property(amap, old_index)
 
 
     def shrink_to_fit(self):
@@ -2343,12 +2513,26 @@ class Graph(object):
             del self.graph_properties["_Graph__reversed"]
         self.shrink_to_fit()
 
-    def save(self, file_name, fmt="auto"):
+    def save(self, file_name, fmt="auto", aligned=False, block_compress=False):
         """Save graph to ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from the ``file_name``, or can be
         specified by ``fmt``, which can be either "gt", "graphml", "xml", "dot"
         or "gml".  (Note that "graphml" and "xml" are synonyms).
 
+        If ``aligned == True`` and the format is "gt", the aligned variant of
+        the format is used (see :ref:`sec_gt_format`), where the adjacency and
+        the scalar property maps are stored as contiguous arrays. Uncompressed
+        files in this variant are loaded via a memory map, which is
+        significantly faster for large graphs. Note that these files cannot be
+        read by older versions of graph-tool.
+
+        If ``block_compress == True`` and the format is "gt", the file is split
+        into blocks which are compressed independently, and in parallel if
+        OpenMP is enabled, using `zstd <https://facebook.github.io/zstd/>`_ if
+        it was available during compilation, or zlib otherwise. This cannot be
+        combined with the ``.gz``, ``.bz2`` or ``.xz`` file name suffixes. Such
+        files are detected automatically by :meth:`~graph_tool.Graph.load`.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -2383,6 +2567,8 @@ class Graph(object):
             fmt = "xml"
 
         if isinstance(file_name, (str, unicode)) and file_name.endswith(".xz"):
+            if block_compress:
+                raise ValueError("block compression cannot be combined with xz compression")
             try:
                 file_name = lzma.open(file_name, mode="wb")
             except NameError:
@@ -2395,9 +2581,11 @@ class Graph(object):
             f = open(file_name, "w") # throw the appropriate exception, if
                                      # unable to open
             f.close()
-            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props)
+            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props,
+                                    aligned, block_compress)
         else:
-            u.__graph.write_to_file("", file_name, _c_str(fmt), props)
+            u.__graph.write_to_file("", file_name, _c_str(fmt), props, aligned,
+                                    block_compress)
 
 
     # Directedness
@@ -2539,8 +2727,8 @@ class Graph(object):
 
         If the option ``in_place == True`` is given, the algorithm will remove
         the filtered vertices and re-index all property maps which are tied with
-        the graph. This is a slow operation which has an :math:`O(V^2)`
-        complexity.
+        the graph. This is done in a single pass over the graph, and has an
+        :math:`O(V + E)` complexity.
 
         If ``in_place == False``, the graph and its vertex and edge property
         maps are temporarily copied to a new unfiltered graph, which will
@@ -2706,7 +2894,8 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
 def load_graph_from_csv(file_name, directed=True, eprop_types=None,
                         eprop_names=None, string_vals=True, hashed=False,
                         skip_first=False, ecols=(0,1),
-                        csv_options={"delimiter": ",","quotechar": '"'}):
+                        csv_options={"delimiter": ",","quotechar": '"'},
+                        comment=None):
     """Load a graph from a :mod:`csv` file containing a list of edges and edge
     properties.
 
@@ -2738,6 +2927,8 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
         Line columns used as source and target for the edges.
     csv_options : ``dict`` (optional, default: ``{"delimiter": ",", "quotechar": '"'}``)
         Options to be passed to the :func:`csv.reader` parser.
+    comment : ``str`` (optional, default: ``None``)
+        If given, lines starting with this character will be ignored.
 
     Returns
     -------
@@ -2746,7 +2937,36 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
         internal edge property maps. If ``hashed == True``, it will also contain
         an internal vertex property map with the vertex names.
 
+    Notes
+    -----
+    If ``file_name`` is a path to an uncompressed, ``gzip`` or ``bzip2`` file,
+    ``csv_options`` contains only single-character ``delimiter`` and
+    ``quotechar`` values, and no edge property is of type ``object``, the file
+    is parsed directly in C++, without creating intermediary Python objects. In
+    this case the file is read in large chunks, which are parsed in parallel,
+    and the vertex names are hashed concurrently, while preserving the order in
+    which they are first encountered. If ``string_vals == False`` and ``hashed
+    == True``, the vertex names are then stored as a ``int64_t`` property map.
+    A ``delimiter`` equal to ``" "`` is interpreted as any run of whitespace.
+
+    Otherwise, the file is read with the :mod:`csv` module.
+
     """
+    _csv_options = {"delimiter": ",", "quotechar": '"'}
+    _csv_options.update(csv_options)
+    if eprop_types is None:
+        obj_props = False
+    else:
+        obj_props = any(t in ["object", "python::object"] for t in eprop_types)
+    if (isinstance(file_name, (str, unicode)) and
+        not file_name.endswith(".xz") and
+        set(_csv_options.keys()) <= set(["delimiter", "quotechar"]) and
+        all(len(x or "") <= 1 for x in _csv_options.values()) and
+        len(comment or "") <= 1 and not obj_props):
+        return _read_edge_list(file_name, directed, eprop_types, eprop_names,
+                               string_vals, hashed, skip_first, ecols,
+                               _csv_options, comment)
+
     if isinstance(file_name, (str, unicode)):
         if file_name.endswith(".xz"):
             try:
@@ -2759,8 +2979,8 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
             file_name = bz2.open(file_name, mode="r")
         else:
             file_name = open(file_name, "r")
-    _csv_options = {"delimiter": ",", "quotechar": '"'}
-    _csv_options.update(csv_options)
+    if comment is not None:
+        file_name = (l for l in file_name if not l.startswith(comment))
     r = csv.reader(file_name, **_csv_options)
     if skip_first:
         next(r)
@@ -2807,6 +3027,66 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
     return g
 
 
+def _read_edge_list(file_name, directed, eprop_types, eprop_names, string_vals,
+                    hashed, skip_first, ecols, csv_options, comment):
+    """Native implementation of :func:`load_graph_from_csv`."""
+    delim = csv_options["delimiter"] or ""
+    quote = csv_options["quotechar"] or ""
+    if delim.isspace():
+        delim = ""
+
+    # peek at the first row to determine the number of columns, which must
+    # then be the same in every row
+    if file_name.endswith(".gz"):
+        f = gzip.open(file_name, mode="rt")
+    elif file_name.endswith(".bz2"):
+        f = bz2.open(file_name, mode="rt")
+    else:
+        f = open(file_name, "r")
+    with f:
+        lines = (l for l in f if l.strip() != "")
+        if comment is not None:
+            lines = (l for l in lines if not l.startswith(comment))
+        if delim == "":
+            r = (l.split() for l in lines)
+        else:
+            r = csv.reader(lines, **csv_options)
+        if skip_first:
+            next(f, None)
+        line = next(r, None)
+
+    g = Graph(directed=directed)
+    ncols = len(line) if line is not None else 0
+    if eprop_types is None:
+        eprops = [g.new_ep("string") for i in range(max(ncols - 2, 0))]
+    else:
+        eprops = [g.new_ep(t) for t in eprop_types]
+
+    if string_vals or hashed:
+        name = g.new_vp("string" if string_vals else "int64_t")
+        vnames = _prop("v", g, name)
+    else:
+        name = None
+        vnames = libcore.any()
+
+    if line is not None:
+        libcore.read_edge_list(g._Graph__graph, file_name, delim, quote,
+                               comment or "", skip_first, ecols[0], ecols[1],
+                               ncols, vnames,
+                               [_prop("e", g, p) for p in eprops])
+
+    for i, p in enumerate(eprops):
+        if eprop_names:
+            ename = eprop_names[i]
+        else:
+            ename = "c%d" % i
+        g.ep[ename] = p
+
+    if name is not None:
+        g.vp.name = name
+    return g
+
+
 class GraphView(Graph):
     """A view of selected vertices or edges of another graph.
 
@@ -2937,6 +3217,128 @@ class GraphView(Graph):
         self.__init__(g)
 
 
+class MutationBatch(object):
+    r"""Collection of graph modifications which are applied all at once.
+
+    Instead of modifying the adjacency lists (and the positions of the edges
+    in them) after each individual insertion or removal, the modifications are
+    recorded and applied in a single step by :meth:`~MutationBatch.commit`:
+    all new vertices are added first, then all new edges (extending each
+    adjacency list only once), then the removed edges, and finally the removed
+    vertices, which are deleted in a single :math:`O(V + E)` pass. All
+    property maps are kept consistent, as with the individual operations.
+
+    Vertices and edges are referred to by their indexes in the graph as it
+    will be just before the removals take place, i.e. the new vertices
+    returned by :meth:`~MutationBatch.add_vertex` can be used in further
+    insertions and removals.
+
+    Instances of this class should be obtained with
+    :meth:`~graph_tool.Graph.mutation_batch`.
+    """
+
+    def __init__(self, g, reindex_edges=False):
+        self.__g = g
+        self.__reindex_edges = reindex_edges
+        self.__clear()
+
+    def __clear(self):
+        self.__new_vertices = 0
+        self.__new_edges = []
+        self.__edge_lists = []
+        self.__rm_edges = []
+        self.__rm_pairs = []
+        self.__rm_vertices = []
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        if exc_type is None:
+            self.commit()
+        else:
+            self.__clear()
+
+    def add_vertex(self, n=1):
+        """Schedule the insertion of ``n`` vertices, and return the index of the
+        new vertex (if ``n == 1``) or a range with the indexes of the new
+        vertices."""
+        pos = self.__g.num_vertices(True) + self.__new_vertices
+        self.__new_vertices += n
+        if n == 1:
+            return pos
+        return range(pos, pos + n)
+
+    def add_edge(self, source, target):
+        """Schedule the insertion of an edge from ``source`` to ``target``."""
+        self.__new_edges.append((int(source), int(target)))
+
+    def add_edge_list(self, edge_list, eprops=None):
+        """Schedule the insertion of the edges in ``edge_list``, which must be
+        a :class:`~numpy.ndarray` of shape ``(E, 2 + k)`` (or a sequence which
+        can be converted to one), where the first two columns are the source
+        and target vertices, and the remaining ``k`` columns contain the
+        values of the edge property maps given in the ``eprops`` list, as in
+        :meth:`~graph_tool.Graph.add_edge_list`."""
+        edge_list = numpy.asarray(edge_list)
+        if edge_list.ndim != 2 or edge_list.shape[1] < 2:
+            raise ValueError("edge list must be two-dimensional, with at least two columns")
+        if eprops is None:
+            eprops = []
+        self.__edge_lists.append((edge_list, list(eprops)))
+
+    def remove_edge(self, edge):
+        """Schedule the removal of an edge, given either as an edge descriptor
+        or as a ``(source, target)`` pair."""
+        if isinstance(edge, EdgeBase):
+            self.__rm_edges.append((int(edge.source()), int(edge.target()),
+                                    int(self.__g.edge_index[edge])))
+        else:
+            s, t = edge
+            self.__rm_pairs.append((int(s), int(t)))
+
+    def remove_vertex(self, vertex):
+        """Schedule the removal of a vertex (or an iterable of vertices)."""
+        if isinstance(vertex, collections.Iterable):
+            self.__rm_vertices.extend(int(v) for v in vertex)
+        else:
+            self.__rm_vertices.append(int(vertex))
+
+    def commit(self):
+        """Apply all scheduled modifications to the graph, and reset the
+        batch."""
+        g = self.__g
+        try:
+            if self.__new_vertices > 0:
+                g.add_vertex(self.__new_vertices)
+
+            edge_lists = self.__edge_lists
+            if len(self.__new_edges) > 0:
+                edge_lists = ([(numpy.array(self.__new_edges, dtype="int64"), [])] +
+                              edge_lists)
+            for edge_list, eprops in edge_lists:
+                vmax = edge_list[:,:2].max() if edge_list.shape[0] > 0 else -1
+                if vmax >= g.num_vertices(True):
+                    g.add_vertex(int(vmax) - g.num_vertices(True) + 1)
+                idx = libcore.add_edge_array(g._Graph__graph, edge_list,
+                                             [_prop("e", g, x) for x in eprops])
+                efilt, inverted = g.get_edge_filter()
+                if efilt is not None:
+                    efilt.a[idx] = not inverted
+
+            if len(self.__rm_edges) > 0:
+                g.remove_edge(numpy.array(self.__rm_edges, dtype="int64"))
+            if len(self.__rm_pairs) > 0:
+                g.remove_edge(numpy.array(self.__rm_pairs, dtype="int64"))
+            if len(self.__rm_vertices) > 0:
+                g.remove_vertex(numpy.unique(self.__rm_vertices))
+
+            if self.__reindex_edges:
+                g.reindex_edges()
+        finally:
+            self.__clear()
+
+
 def value_types():
     """Return a list of possible properties value types."""
     return libcore.get_property_types()
@@ -3168,12 +3570,22 @@ def openmp_set_num_threads(n):
 
 def openmp_get_schedule():
     """Return the runtime OpenMP schedule and chunk size. The schedule can by
-    any of: `"static"`, `"dynamic"`, `"guided"`, `"auto"`."""
+    any of: `"static"`, `"dynamic"`, `"guided"`, `"auto"`, `"degree"`."""
     return libcore.openmp_get_schedule()
 
 def openmp_set_schedule(schedule, chunk=0):
     """Set the runtime OpenMP schedule and chunk size. The schedule can by
-    any of: `"static"`, `"dynamic"`, `"guided"`, `"auto"`."""
+    any of: `"static"`, `"dynamic"`, `"guided"`, `"auto"`, `"degree"`.
+
+    The `"degree"` schedule applies to the parallel loops over vertices and
+    edges performed by most algorithms. The vertices are split into tasks
+    containing approximately the same number of edges (``chunk``, which is
+    chosen automatically if ``chunk == 0``), the edges of high-degree vertices
+    are divided among several tasks whenever possible, and idle threads steal
+    the remaining tasks of busy ones. This gives a much better load balance
+    for graphs with very heterogeneous degrees (e.g. with a power-law degree
+    distribution), at the cost of an additional :math:`O(V)` pass in each
+    loop."""
     return libcore.openmp_set_schedule(schedule, chunk)
 
 if openmp_enabled() and os.environ.get("OMP_SCHEDULE") is None:
@@ -31,9 +31,12 @@ Summary
    :nosignatures:
 
    pagerank
+   personalized_pagerank
    betweenness
+   betweenness_top_k
    central_point_dominance
    closeness
+   closeness_top_k
    eigenvector
    katz
    hits
@@ -49,18 +52,21 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property
+from .. import _prop, ungroup_vector_property, _get_rng
 from .. topology import shortest_distance
 import sys
 import numpy
 import numpy.linalg
+import scipy.sparse
 
-__all__ = ["pagerank", "betweenness", "central_point_dominance", "closeness",
-           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity"]
+__all__ = ["pagerank", "personalized_pagerank", "betweenness",
+           "betweenness_top_k", "central_point_dominance", "closeness",
+           "closeness_top_k", "eigentrust", "eigenvector", "katz", "hits",
+           "trust_transitivity"]
 
 
 def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
-             max_iter=None, ret_iter=False):
+             max_iter=None, ret_iter=False, method="power"):
     r"""
     Calculate the PageRank of each vertex.
 
@@ -77,14 +83,19 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         Edge weights. If omitted, a constant value of 1 will be used.
     prop : :class:`~graph_tool.PropertyMap`, optional (default: None)
         Vertex property map to store the PageRank values. If supplied, it will
-        be used uninitialized.
+        be used uninitialized, i.e. its values are used as the starting point
+        of the iteration.
     epsilon : float, optional (default: 1e-6)
         Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        vertices are below this value (or, if ``method == "push"``, if the
+        total residual is below this value).
     max_iter : int, optional (default: None)
         If supplied, this will limit the total number of iterations.
     ret_iter : bool, optional (default: False)
         If true, the total number of iterations is also returned.
+    method : str, optional (default: ``"power"``)
+        Either ``"power"``, for the power iteration, or ``"push"``, for
+        residual pushes (see below).
 
     Returns
     -------
@@ -133,6 +144,19 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     it no longer changes, according to the parameter epsilon. It has a
     topology-dependent running time.
 
+    If ``method == "push"``, the residual of the above equations is computed
+    once for the initial values, and then repeatedly "pushed" from the
+    vertices where it is larger than :math:`\epsilon/N` to their
+    out-neighbours [andersen-local-2006]_, until the total residual is below
+    :math:`\epsilon`, which bounds the total error by
+    :math:`\epsilon/(1-d)`. Only the vertices whose residual exceeds the
+    threshold are touched, which makes it much faster than the power
+    iteration when the initial values are already close to the solution. In
+    particular, after a small batch of edge insertions or removals, the
+    PageRank values can be updated by passing the previous result as
+    ``prop``. In this case, the number of iterations returned is the number of
+    rounds of pushes.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -210,8 +234,13 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", Proceedings of FOCS 2006,
+       :DOI:`10.1109/FOCS.2006.44`
     """
 
+    if method not in ["power", "push"]:
+        raise ValueError("invalid method: " + str(method))
     if max_iter is None:
         max_iter = 0
     if prop is None:
@@ -221,14 +250,150 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     ic = libgraph_tool_centrality.\
             get_pagerank(g._Graph__graph, _prop("v", g, prop),
                          _prop("v", g, pers), _prop("e", g, weight),
-                         damping, epsilon, max_iter)
+                         damping, epsilon, max_iter, method == "push")
     if ret_iter:
         return prop, ic
     else:
         return prop
 
 
-def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
+def personalized_pagerank(g, pers, damping=0.85, weight=None, epsilon=1e-6,
+                          max_iter=None, ret_iter=False, method="power"):
+    r"""
+    Calculate the personalized PageRank of each vertex, for many
+    personalization vectors at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    pers : :class:`~numpy.ndarray`, :class:`~scipy.sparse.spmatrix` or list
+        Personalization vectors, either as a :math:`N\times k` array or sparse
+        matrix, with one column per vector and one row per vertex index, or as
+        a list of :math:`k` sequences of vertices, each corresponding to a
+        uniform personalization over them (e.g. a set of seed vertices).
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Convergence condition. If ``method == "power"``, the iteration for each
+        vector will stop when the total delta of all vertices is below this
+        value. If ``method == "push"``, the pushes stop when the residual of
+        every vertex is below this value.
+    max_iter : int, optional (default: None)
+        If supplied, this will limit the total number of iterations (or
+        pushes, if ``method == "push"``) for each vector.
+    ret_iter : bool, optional (default: False)
+        If true, the number of iterations (or pushes) for each vector is also
+        returned.
+    method : str, optional (default: ``"power"``)
+        Either ``"power"``, for the power iteration of all vectors together,
+        or ``"push"``, for a local approximation of each vector (see below).
+
+    Returns
+    -------
+    pagerank : :class:`~numpy.ndarray` or :class:`~scipy.sparse.csc_matrix`
+        A :math:`N\times k` array with the PageRank values for each
+        personalization vector in its columns, indexed by the vertex indexes.
+        If ``method == "push"``, this is a sparse matrix.
+    iters : :class:`~numpy.ndarray`
+        Number of iterations (or pushes) for each vector. Only returned if
+        ``ret_iter == True``.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+
+    Notes
+    -----
+    The values are the same as those obtained with :func:`pagerank` for each
+    personalization vector separately.
+
+    If ``method == "power"``, all the vectors are iterated together, as a
+    dense :math:`N\times k` block, so that each edge is visited only once per
+    iteration for all of them, and the inner loops are vectorized. Each vector
+    stops being iterated as soon as it converges. The memory requirement is
+    :math:`O(Nk)`, so a large number of vectors should be split in batches of
+    a few dozen or hundreds.
+
+    If ``method == "push"``, each vector is approximated independently by
+    pushing residuals from the vertices where they exceed ``epsilon``, starting
+    from the personalization itself [andersen-local-2006]_. The total error
+    (in the L1 norm) is at most :math:`\epsilon/(1-d)` times the number of
+    vertices touched. Only the vertices reached by the pushes are touched, so the
+    running time does not depend on the size of the graph, which makes it
+    appropriate for sparse personalizations, such as a few seed vertices.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> seeds = [[0, 1, 2], [10], [20, 30]]
+    >>> pr = gt.personalized_pagerank(g, seeds)
+    >>> print(pr.shape)
+    (1490, 3)
+
+    References
+    ----------
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", Proceedings of FOCS 2006,
+       :DOI:`10.1109/FOCS.2006.44`
+    """
+
+    if method not in ["power", "push"]:
+        raise ValueError("invalid method: " + str(method))
+    if max_iter is None:
+        max_iter = 0
+    N = g.num_vertices(ignore_filter=True)
+
+    if isinstance(pers, numpy.ndarray) or scipy.sparse.issparse(pers):
+        if pers.ndim != 2 or pers.shape[0] != N:
+            raise ValueError("personalization array must have shape (N, k), with"
+                             " N = %d" % N)
+        P = scipy.sparse.csc_matrix(pers, dtype="double")
+    else:
+        ptr = [0]
+        idx = []
+        val = []
+        for seeds in pers:
+            seeds = numpy.asarray(seeds, dtype="int64").ravel()
+            if len(seeds) == 0:
+                raise ValueError("empty set of seed vertices")
+            idx.append(seeds)
+            val.append(numpy.ones(len(seeds)) / len(seeds))
+            ptr.append(ptr[-1] + len(seeds))
+        k = len(ptr) - 1
+        idx = numpy.concatenate(idx) if k > 0 else numpy.zeros(0, dtype="int64")
+        val = numpy.concatenate(val) if k > 0 else numpy.zeros(0)
+        P = scipy.sparse.csc_matrix((val, idx, ptr), shape=(N, k))
+        P.sum_duplicates()
+    P.sort_indices()
+
+    if method == "power":
+        R, iters = libgraph_tool_centrality.\
+            get_pagerank_multi(g._Graph__graph, P.toarray(),
+                               _prop("e", g, weight), damping, epsilon,
+                               max_iter)
+    else:
+        ptr, idx, val, iters = libgraph_tool_centrality.\
+            get_pagerank_multi_push(g._Graph__graph,
+                                    numpy.asarray(P.indptr, dtype="int64"),
+                                    numpy.asarray(P.indices, dtype="int64"),
+                                    numpy.asarray(P.data, dtype="double"),
+                                    _prop("e", g, weight), damping, epsilon,
+                                    max_iter)
+        R = scipy.sparse.csc_matrix((val, idx, ptr), shape=P.shape)
+    if ret_iter:
+        return R, iters
+    return R
+
+
+def betweenness(g, vprop=None, eprop=None, weight=None, norm=True,
+                samples=None, pivots=None, epsilon=None, delta=0.1,
+                sampling="uniform"):
     r"""
     Calculate the betweenness centrality for each vertex and edge.
 
@@ -244,11 +409,32 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         Edge property map corresponding to the weight value of each edge.
     norm : bool, optional (default: True)
         Whether or not the betweenness values should be normalized.
+    samples : int, optional (default: None)
+        If given, the betweenness values are estimated from this number of
+        randomly chosen pivot vertices, instead of all of them (see below). If
+        ``epsilon`` is also given, this is the maximum number of pivots used.
+    pivots : list or :class:`~numpy.ndarray`, optional (default: None)
+        If given, the betweenness values are estimated from the shortest paths
+        starting from these vertices only. This cannot be combined with
+        ``sampling="degree"``, since the pivots were not sampled.
+    epsilon : float, optional (default: None)
+        If given, pivots are sampled until the estimated maximum error of the
+        normalized vertex betweenness values is at most this value.
+    delta : float, optional (default: 0.1)
+        Probability that the actual error exceeds the error estimate returned.
+    sampling : str, optional (default: ``"uniform"``)
+        How the pivots are sampled. If ``"uniform"``, they are chosen uniformly
+        without replacement; if ``"degree"``, they are chosen with replacement,
+        with probability proportional to their total degree plus one.
 
     Returns
     -------
     vertex_betweenness : A vertex property map with the vertex betweenness values.
     edge_betweenness : An edge property map with the edge betweenness values.
+    error : float
+        Estimated maximum error of the vertex betweenness values, which holds
+        with probability at least :math:`1-\delta`. This is only returned if
+        either ``samples``, ``pivots`` or ``epsilon`` are given.
 
     See Also
     --------
@@ -278,6 +464,22 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
     complexity of :math:`O(VE)` for unweighted graphs and :math:`O(VE + V(V+E)
     \log V)` for weighted graphs. The space complexity is :math:`O(VE)`.
 
+    If either ``samples``, ``pivots`` or ``epsilon`` are given, the dependencies
+    are accumulated only from a set of :math:`k` pivot vertices, and rescaled
+    accordingly, so that the values obtained are unbiased estimates of the
+    exact ones [brandes-centrality-2007]_. In this case the complexity is
+    :math:`O(kE)` for unweighted graphs and :math:`O(kE + kV\log V)` for
+    weighted graphs. The error estimate returned is an upper bound on the
+    absolute deviation from the exact values, simultaneously for all vertices,
+    which holds with probability at least :math:`1-\delta`. It is obtained
+    from the smallest of Hoeffding's and the empirical Bernstein
+    [maurer-empirical-2009]_ inequalities, and assumes that the pivots were
+    sampled at random (as is the case if ``pivots`` is not given). If
+    ``epsilon`` is given, the pivots are processed in rounds of increasing
+    size, until this bound falls below ``epsilon``. With uniform sampling, if
+    the number of pivots reaches the number of vertices, the exact values are
+    computed, and the error returned is zero.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -319,6 +521,12 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
     .. [betweenness-wikipedia] http://en.wikipedia.org/wiki/Centrality#Betweenness_centrality
     .. [brandes-faster-2001] U. Brandes, "A faster algorithm for betweenness
        centrality", Journal of Mathematical Sociology, 2001, :doi:`10.1080/0022250X.2001.9990249`
+    .. [brandes-centrality-2007] U. Brandes and C. Pich, "Centrality
+       estimation in large networks", International Journal of Bifurcation and
+       Chaos, 2007, :doi:`10.1142/S0218127407018403`
+    .. [maurer-empirical-2009] A. Maurer and M. Pontil, "Empirical Bernstein
+       bounds and sample variance penalization", Proceedings of COLT, 2009,
+       :arxiv:`0907.3740`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -331,10 +539,117 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         nw = g.new_edge_property(eprop.value_type())
         g.copy_property(weight, nw)
         weight = nw
-    libgraph_tool_centrality.\
+    if samples is None and pivots is None and epsilon is None:
+        libgraph_tool_centrality.\
             get_betweenness(g._Graph__graph, _prop("e", g, weight),
                             _prop("e", g, eprop), _prop("v", g, vprop), norm)
-    return vprop, eprop
+        return vprop, eprop
+    if sampling not in ["uniform", "degree"]:
+        raise ValueError("invalid pivot sampling: " + str(sampling))
+    if pivots is not None and sampling == "degree":
+        raise ValueError("pivots cannot be given with degree sampling")
+    if pivots is None:
+        pivots = []
+    pivots = numpy.asarray(pivots, dtype="int64")
+    err, k = libgraph_tool_centrality.\
+        get_betweenness_sampled(g._Graph__graph, _prop("e", g, weight),
+                                _prop("e", g, eprop), _prop("v", g, vprop),
+                                norm, pivots,
+                                samples if samples is not None else 0,
+                                epsilon if epsilon is not None else 0,
+                                delta, sampling == "degree", 0, _get_rng())
+    return vprop, eprop, err
+
+
+def _top_k_array(vs, cs):
+    top = numpy.empty(len(vs), dtype=[("vertex", "int64"), ("score", "float64")])
+    top["vertex"] = vs
+    top["score"] = cs
+    return top
+
+
+def betweenness_top_k(g, k, weight=None, norm=True, epsilon=0.01, delta=0.1,
+                      samples=None, sampling="uniform"):
+    r"""Return the ``k`` vertices with the largest betweenness centrality.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : int
+        Number of vertices to be returned.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge property map corresponding to the weight value of each edge.
+    norm : bool, optional (default: True)
+        Whether or not the betweenness values should be normalized.
+    epsilon : float, optional (default: ``0.01``)
+        If the top ``k`` vertices cannot be separated from the rest, pivots are
+        sampled until the estimated maximum error of the normalized values is
+        at most this value.
+    delta : float, optional (default: 0.1)
+        Probability that the actual error exceeds the error estimate returned.
+    samples : int, optional (default: None)
+        If given, the maximum number of pivots used.
+    sampling : str, optional (default: ``"uniform"``)
+        How the pivots are sampled, as in :func:`~graph_tool.centrality.betweenness`.
+
+    Returns
+    -------
+    top : :class:`~numpy.ndarray`
+        Structured array with fields ``"vertex"`` and ``"score"``, with the
+        estimated betweenness of the top ``k`` vertices, in decreasing order.
+    err : float
+        Estimated maximum error of the betweenness values (see
+        :func:`~graph_tool.centrality.betweenness`).
+
+    Notes
+    -----
+    The betweenness values are estimated from random pivots, as in
+    :func:`~graph_tool.centrality.betweenness`, which are processed in rounds
+    of increasing size. The sampling stops as soon as the ``k``-th largest
+    estimate minus the error bound exceeds the next largest estimate plus the
+    error bound, since then the set of the top ``k`` vertices is correct with
+    probability at least ``1 - delta`` [riondato-abra-2016]_. Only the
+    membership in the set is guaranteed, not the order within it, which is
+    that of the estimates. If the ``k``-th and the next value are too close,
+    the sampling continues until the error falls below ``epsilon``, as with
+    :func:`~graph_tool.centrality.betweenness`.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> top, err = gt.betweenness_top_k(g, 10)
+
+    References
+    ----------
+    .. [riondato-abra-2016] M. Riondato, E. Upfal, "ABRA: Approximating
+       Betweenness Centrality in Static and Dynamic Graphs with Rademacher
+       Averages", Proceedings of KDD, 2016, :doi:`10.1145/2939672.2939770`
+    """
+    if sampling not in ["uniform", "degree"]:
+        raise ValueError("invalid pivot sampling: " + str(sampling))
+    vprop = g.new_vertex_property("double")
+    eprop = g.new_edge_property("double")
+    if weight is not None and weight.value_type() != eprop.value_type():
+        nw = g.new_edge_property(eprop.value_type())
+        g.copy_property(weight, nw)
+        weight = nw
+    pivots = numpy.asarray([], dtype="int64")
+    err, n_pivots = libgraph_tool_centrality.\
+        get_betweenness_sampled(g._Graph__graph, _prop("e", g, weight),
+                                _prop("e", g, eprop), _prop("v", g, vprop),
+                                norm, pivots,
+                                samples if samples is not None else 0,
+                                epsilon, delta, sampling == "degree", k,
+                                _get_rng())
+    vs = g.get_vertices()
+    cs = vprop.fa
+    idx = numpy.lexsort((vs, -cs))[:k]
+    return _top_k_array(vs[idx], cs[idx]), err
+
 
 def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False):
     r"""
@@ -469,6 +784,65 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
         return c
 
 
+def closeness_top_k(g, k, weight=None, norm=True, harmonic=False):
+    r"""Return the ``k`` vertices with the largest closeness centrality.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : int
+        Number of vertices to be returned.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge property map corresponding to the weight value of each edge.
+    norm : bool, optional (default: ``True``)
+        Whether or not the centrality values should be normalized.
+    harmonic : bool, optional (default: ``False``)
+        If true, the sum of the inverse of the distances will be computed,
+        instead of the inverse of the sum.
+
+    Returns
+    -------
+    top : :class:`~numpy.ndarray`
+        Structured array with fields ``"vertex"`` and ``"score"``, with the
+        centrality of the top ``k`` vertices, in decreasing order.
+
+    Notes
+    -----
+    The centrality values are the same as computed by
+    :func:`~graph_tool.centrality.closeness`, but only for the top ``k``
+    vertices, using the pruning strategy of [bergamini-computing-2016]_. The
+    vertices are processed in decreasing order of an upper bound on their
+    centrality obtained from their neighbourhood, and the search from each
+    vertex is abandoned as soon as an upper bound on its centrality falls
+    below the ``k``-th largest value found so far. The worst-case complexity is
+    the same as for :func:`~graph_tool.centrality.closeness`, but in practice
+    only a small fraction of the graph is visited from most vertices.
+
+    Vertices for which the normalized closeness is undefined, since they
+    cannot reach any other vertex, are not included.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> top = gt.closeness_top_k(g, 10, harmonic=True)
+
+    References
+    ----------
+    .. [bergamini-computing-2016] E. Bergamini, M. Borassi, P. Crescenzi,
+       A. Marino, H. Meyerhenke, "Computing top-k closeness centrality faster
+       in unweighted graphs", Proceedings of ALENEX, 2016,
+       :doi:`10.1137/1.9781611974317.6`
+    """
+    vs, cs, n_pruned = libgraph_tool_centrality.\
+        closeness_top_k(g._Graph__graph, _prop("e", g, weight), k, harmonic,
+                        norm)
+    return _top_k_array(vs, cs)
+
+
 def central_point_dominance(g, betweenness):
     r"""
     Calculate the central point dominance of the graph, given the betweenness
@@ -438,11 +438,12 @@ def random_graph(N, deg_sampler, directed=True,
         bm = None
 
     if random:
+        fast = g.get_fast_edge_removal()
         g.set_fast_edge_removal(True)
         random_rewire(g, parallel_edges=parallel_edges,
                       self_loops=self_loops, verbose=verbose,
                       block_membership=bm, **kwargs)
-        g.set_fast_edge_removal(False)
+        g.set_fast_edge_removal(fast)
 
     if bm is None:
         return g
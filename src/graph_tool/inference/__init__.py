@@ -67,6 +67,8 @@ Sampling and minimization
    MulticanonicalState
    bisection_minimize
    hierarchy_minimize
+   save_checkpoint
+   load_checkpoint
 
 Auxiliary functions
 ===================
@@ -141,6 +143,8 @@ __all__ = ["minimize_blockmodel_dl",
            "MulticanonicalState",
            "bisection_minimize",
            "hierarchy_minimize",
+           "save_checkpoint",
+           "load_checkpoint",
            "EMBlockState",
            "em_infer",
            "model_entropy",
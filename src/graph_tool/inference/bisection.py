@@ -87,9 +87,13 @@ def get_state_dl(B, b_cache, mcmc_multilevel_args={}, extra_entropy_args={},
     b_cache[B] = (dl, state)
     return dl
 
+def get_best_state(b_cache):
+    B = min(b_cache.keys(), key=lambda B: b_cache[B][0])
+    return b_cache[B][1]
+
 def bisection_minimize(init_states, random_bisection=False,
                        mcmc_multilevel_args={}, extra_entropy_args={},
-                       verbose=False):
+                       callback=None, verbose=False):
     r"""Find the best order (number of groups) given an initial set of states by
     performing a one-dimension minimization, using a Fibonacci (or golden
     section) search.
@@ -105,6 +109,9 @@ def bisection_minimize(init_states, random_bisection=False,
         Arguments to be passed to :func:`~graph_tool.inference.mcmc_multilevel`.
     extra_entropy_args : ``dict`` (optional, default: ``{}``)
         Extra arguments to be passed to ``state.entropy()``.
+    callback : ``function`` (optional, default: ``None``)
+        If given, this function will be called after each bisection step with
+        the state with minimal entropy found so far as its argument.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -163,6 +170,9 @@ def bisection_minimize(init_states, random_bisection=False,
 
         cleanup_cache(b_cache, min_B, max_B)
 
+        if callback is not None:
+            callback(get_best_state(b_cache))
+
         if f_mid > f_min or f_mid > f_max:
             if f_min < f_max:
                 max_B = mid_B
@@ -220,3 +230,6 @@ def bisection_minimize(init_states, random_bisection=False,
                 min_B = x
 
         cleanup_cache(b_cache, min_B, max_B)
+
+        if callback is not None:
+            callback(get_best_state(b_cache))
@@ -220,15 +220,17 @@ class BlockState(object):
     allow_empty : ``bool`` (optional, default: ``True``)
         If ``True``, partition description length computed will allow for empty
         groups.
-    max_BE : ``int`` (optional, default: ``1000``)
-        If the number of blocks exceeds this value, a sparse matrix is used for
-        the block graph. Otherwise a dense matrix will be used.
+    max_BE : ``int`` (optional, default: ``None``)
+        If given, and the number of blocks exceeds this value, a sparse matrix
+        is always used for the block graph. Otherwise, a dense or sparse matrix
+        is chosen automatically, depending on the number of blocks and the
+        density of the block graph.
 
     """
 
     def __init__(self, g, b=None, B=None, eweight=None, vweight=None, recs=[],
                  rec_types=[], rec_params=[], clabel=None, pclabel=None,
-                 deg_corr=True, allow_empty=False, max_BE=1000, **kwargs):
+                 deg_corr=True, allow_empty=False, max_BE=None, **kwargs):
         kwargs = kwargs.copy()
 
         # initialize weights to unity, if necessary
@@ -371,7 +373,7 @@ class BlockState(object):
 
         self.max_BE = max_BE
 
-        self.use_hash = self.B > self.max_BE
+        self.use_hash = self.max_BE is not None and self.B > self.max_BE
 
         self.ignore_degrees = kwargs.pop("ignore_degrees", None)
         if self.ignore_degrees is None:
@@ -573,6 +575,23 @@ class BlockState(object):
         conv_pickle_state(state)
         self.__init__(**state)
 
+    def get_snapshot(self):
+        r"""Return a compact binary snapshot of the current partition and block
+        graph, as a ``bytes`` object.
+
+        The snapshot can be restored with :meth:`~BlockState.set_snapshot` into
+        a state constructed with the same graph and parameters, in time
+        :math:`O(N + E)`."""
+        return self._state.get_snapshot()
+
+    def set_snapshot(self, snapshot):
+        r"""Restore a snapshot obtained with :meth:`~BlockState.get_snapshot`.
+
+        The state must have been constructed for the same graph, with the same
+        number of groups and edge covariates, otherwise a :class:`ValueError`
+        is raised and the state is left unchanged."""
+        self._state.set_snapshot(snapshot)
+
     def get_block_state(self, b=None, vweight=False, **kwargs):
         r"""Returns a :class:`~graph_tool.community.BlockState`` corresponding to the
         block graph (i.e. the blocks of the current state become the nodes). The
@@ -1184,6 +1203,34 @@ class BlockState(object):
         return libinference.mcmc_sweep(mcmc_state, self._state,
                                        _get_rng())
 
+    def _get_mcmc_state(self, beta=1., c=1., niter=1, entropy_args={},
+                        allow_vacate=True, sequential=True, parallel=False,
+                        vertices=None, verbose=False):
+        mcmc_state = DictState(locals())
+        entropy_args = dict(self._entropy_args, **entropy_args)
+        if (_bm_test() and entropy_args["multigraph"] and
+            not entropy_args["dense"] and
+            hasattr(self, "degs") and
+            not isinstance(self.degs, libinference.simple_degs_t)):
+            entropy_args["multigraph"] = False
+        mcmc_state.entropy_args = get_entropy_args(entropy_args)
+        mcmc_state.vlist = Vector_size_t()
+        if vertices is None:
+            vertices = self.g.vertex_index.copy().fa
+            if self.is_weighted:
+                # ignore vertices with zero weight
+                vw = self.vweight.fa
+                vertices = vertices[vw > 0]
+        mcmc_state.vlist.resize(len(vertices))
+        mcmc_state.vlist.a = vertices
+        mcmc_state.E = self.get_E()
+        mcmc_state.state = self._state
+        return mcmc_state, entropy_args
+
+    def _tempering_sweep_dispatch(self, mcmc_states, S, niter):
+        return libinference.tempering_sweep(mcmc_states, self._state, S,
+                                            niter, _get_rng())
+
     def mcmc_sweep(self, beta=1., c=1., niter=1, entropy_args={},
                    allow_vacate=True, sequential=True, parallel=False,
                    vertices=None, verbose=False, **kwargs):
@@ -1216,6 +1263,9 @@ class BlockState(object):
             the chance to move.
         parallel : ``bool`` (optional, default: ``False``)
             If ``parallel == True``, vertex movements are attempted in parallel.
+            Accepted moves that touch disjoint sets of groups are also
+            performed in parallel, and only the remaining ones are
+            re-evaluated and performed serially.
 
             .. warning::
 
@@ -1247,25 +1297,12 @@ class BlockState(object):
            :arxiv:`1310.4378`
         """
 
-        mcmc_state = DictState(locals())
-        entropy_args = dict(self._entropy_args, **entropy_args)
-        if (_bm_test() and entropy_args["multigraph"] and
-            not entropy_args["dense"] and
-            hasattr(self, "degs") and
-            not isinstance(self.degs, libinference.simple_degs_t)):
-            entropy_args["multigraph"] = False
-        mcmc_state.entropy_args = get_entropy_args(entropy_args)
-        mcmc_state.vlist = Vector_size_t()
-        if vertices is None:
-            vertices = self.g.vertex_index.copy().fa
-            if self.is_weighted:
-                # ignore vertices with zero weight
-                vw = self.vweight.fa
-                vertices = vertices[vw > 0]
-        mcmc_state.vlist.resize(len(vertices))
-        mcmc_state.vlist.a = vertices
-        mcmc_state.E = self.get_E()
-        mcmc_state.state = self._state
+        mcmc_state, entropy_args = \
+            self._get_mcmc_state(beta=beta, c=c, niter=niter,
+                                 entropy_args=entropy_args,
+                                 allow_vacate=allow_vacate,
+                                 sequential=sequential, parallel=parallel,
+                                 vertices=vertices, verbose=verbose)
 
         disable_callback_test = kwargs.pop("disable_callback_test", False)
         if _bm_test():
@@ -1737,7 +1774,8 @@ class BlockState(object):
             :meth:`graph_tool.inference.BlockState.entropy`.
         parallel : ``bool`` (optional, default: ``True``)
             If ``parallel == True``, the merge candidates are obtained in
-            parallel.
+            parallel, and the stale candidates at the top of the merge queue
+            are re-evaluated in parallel batches.
         verbose : ``bool`` (optional, default: ``False``)
             If ``verbose == True``, detailed information will be displayed.
 
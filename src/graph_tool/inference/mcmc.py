@@ -26,6 +26,8 @@ if sys.version_info < (3,):
 from .. import Vector_size_t, Vector_double
 
 import numpy
+import os
+import pickle
 from . util import *
 
 def mcmc_equilibrate(state, wait=1000, nbreaks=2, max_niter=numpy.inf,
@@ -425,6 +427,27 @@ class MulticanonicalState(object):
         self._hist.a[:] = hist
         self._perm_hist[:] = phist
 
+    def get_snapshot(self):
+        """Return the histogram, density of states and refinement parameters,
+        without the graph. It can be restored with
+        :meth:`~MulticanonicalState.set_snapshot`."""
+        return [self._S_min, self._S_max, numpy.array(self._density.a),
+                numpy.array(self._hist.a), numpy.array(self._perm_hist),
+                self._f, self._time, self._refine]
+
+    def set_snapshot(self, snapshot):
+        """Restore a snapshot obtained with
+        :meth:`~MulticanonicalState.get_snapshot`."""
+        S_min, S_max, density, hist, phist, f, time, refine = snapshot
+        if len(hist) != len(self._hist.a):
+            raise ValueError("snapshot has %d bins, but the state has %d" %
+                             (len(hist), len(self._hist.a)))
+        self._S_min, self._S_max = S_min, S_max
+        self._density.a[:] = density
+        self._hist.a[:] = hist
+        self._perm_hist[:] = phist
+        self._f, self._time, self._refine = f, time, refine
+
     def get_energies(self):
         "Get energy bounds."
         return self._S_min, self._S_max
@@ -701,4 +724,172 @@ class TemperingState(object):
         if numpy.random.random() < .5:
             return self.states_move(gibbs=True, **kwargs)
         else:
-            return self.states_swap(**kwargs)
\ No newline at end of file
+            return self.states_swap(**kwargs)
+
+    def tempering_sweep(self, niter=1, nsweeps=1, entropy_args={}, **kwargs):
+        r"""Perform ``niter`` rounds of parallel tempering entirely in C++. In
+        each round, every state is swept ``nsweeps`` times with
+        :meth:`~graph_tool.inference.BlockState.mcmc_sweep` at its own inverse
+        temperature, with the states running concurrently in different
+        threads. Swaps between all neighbouring temperatures are then
+        attempted, in random order.
+
+        All states must be of type :class:`~graph_tool.inference.BlockState`,
+        and must be of the same kind, i.e. they must have the same type of
+        graph (e.g. all filtered or all unfiltered), and the same types of
+        weights, degrees and edge covariates. The remaining keyword arguments are passed to the individual states'
+        :meth:`~graph_tool.inference.BlockState.mcmc_sweep` method, except
+        ``beta`` and ``parallel``, which are not allowed.
+
+        Returns
+        -------
+        dS : ``float``
+            Difference of the weighted sum of entropies (as given by
+            :meth:`entropy`) after the sweeps.
+        nmoves : ``int``
+            Number of vertices moved, over all states.
+        nswaps : ``int``
+            Number of swaps accepted.
+
+        Notes
+        -----
+        The list :attr:`states` is reordered in place according to the
+        accepted swaps, in the same way as with :meth:`states_swap`.
+        """
+        from . blockmodel import BlockState
+        if any(type(s) is not BlockState for s in self.states):
+            raise ValueError("all states must be of type BlockState")
+        # each combination of graph, weight and covariate types corresponds
+        # to a different C++ state type, and the replicas are dispatched
+        # together
+        if len(set(id(s) for s in self.states)) < len(self.states):
+            raise ValueError("the states must be distinct, since they are " +
+                             "modified concurrently")
+        if len(set(type(s._state) for s in self.states)) > 1:
+            raise ValueError("all states must be of the same kind, with the " +
+                             "same type of graph (e.g. filtered or not), and " +
+                             "the same types of weights, degrees and edge " +
+                             "covariates")
+        for k in ["beta", "parallel"]:
+            if k in kwargs:
+                raise ValueError("parameter '%s' is not allowed" % k)
+
+        mcmc_states = []
+        S = []
+        for state, beta in zip(self.states, self.betas):
+            mcmc_state, eargs = state._get_mcmc_state(beta=beta, niter=nsweeps,
+                                                      entropy_args=entropy_args,
+                                                      **kwargs)
+            mcmc_states.append(mcmc_state)
+            S.append(state.entropy(**eargs))
+
+        dS, nmoves, nswaps, S, idx = \
+            self.states[0]._tempering_sweep_dispatch(mcmc_states, S, niter)
+
+        self.states[:] = [self.states[i] for i in idx]
+        return dS, nmoves, nswaps
+
+
+def save_checkpoint(filename, state, m_state=None):
+    r"""Save a checkpoint of an inference run to a file.
+
+    Parameters
+    ----------
+    filename : ``str``
+        Path of the checkpoint file. It is replaced atomically, so that an
+        interrupted write never leaves a corrupt checkpoint behind.
+    state : :class:`~graph_tool.inference.BlockState` or :class:`~graph_tool.inference.NestedBlockState`
+        State to be saved, via its ``get_snapshot()`` method.
+    m_state : :class:`~graph_tool.inference.MulticanonicalState` (optional, default: ``None``)
+        If given, its histogram and density of states are also saved.
+
+    Notes
+    -----
+    The checkpoint contains the snapshot of the state, the number of groups
+    (of every level, for a hierarchy) and the degree correction, the
+    multicanonical histograms, and the state of graph-tool's and numpy's random
+    number generators, but not the graph itself. It is meant to be called
+    periodically, e.g. via the ``callback`` parameter of
+    :func:`~graph_tool.inference.mcmc_equilibrate`, and restored with
+    :func:`~graph_tool.inference.load_checkpoint`.
+    """
+    import graph_tool
+    from . nested_blockmodel import NestedBlockState
+    if isinstance(state, NestedBlockState):
+        kind = "nested"
+        B = [s.B for s in state.levels]
+        deg_corr = state.levels[0].deg_corr
+    else:
+        kind = "flat"
+        B = state.B
+        deg_corr = state.deg_corr
+    data = dict(version=1, kind=kind, B=B, deg_corr=deg_corr,
+                snapshot=state.get_snapshot(),
+                m_state=m_state.get_snapshot() if m_state is not None else None,
+                rng=graph_tool._get_rng(),
+                numpy_rng=numpy.random.get_state())
+    tmp = filename + ".tmp"
+    with open(tmp, "wb") as f:
+        pickle.dump(data, f, protocol=pickle.HIGHEST_PROTOCOL)
+        f.flush()
+        os.fsync(f.fileno())
+    if sys.version_info < (3,):
+        os.rename(tmp, filename)
+    else:
+        os.replace(tmp, filename)
+
+def load_checkpoint(filename, state, m_state=None, state_args={}):
+    r"""Restore a checkpoint saved with :func:`~graph_tool.inference.save_checkpoint`.
+
+    Parameters
+    ----------
+    filename : ``str``
+        Path of the checkpoint file.
+    state : :class:`~graph_tool.Graph`, :class:`~graph_tool.inference.BlockState` or :class:`~graph_tool.inference.NestedBlockState`
+        If a graph is given, a new state of the saved kind is built for it, with
+        the saved number of groups and degree correction. Otherwise, the
+        snapshot is restored into the given state, which must have been
+        constructed with the same graph and parameters as the saved one.
+    m_state : :class:`~graph_tool.inference.MulticanonicalState` (optional, default: ``None``)
+        If given, the saved histogram and density of states are restored into
+        it.
+    state_args : ``dict`` (optional, default: ``{}``)
+        Additional parameters passed to the constructor of the state (e.g. edge
+        covariates), if ``state`` is a graph.
+
+    Returns
+    -------
+    state : :class:`~graph_tool.inference.BlockState` or :class:`~graph_tool.inference.NestedBlockState`
+        The restored state.
+
+    Notes
+    -----
+    The random number generators are also restored, so that the run continues
+    exactly as it would have without interruption.
+    """
+    import graph_tool
+    from .. import Graph
+    from . blockmodel import BlockState
+    from . nested_blockmodel import NestedBlockState
+    with open(filename, "rb") as f:
+        data = pickle.load(f)
+    if data.get("version", None) != 1:
+        raise ValueError("unsupported checkpoint version")
+    if isinstance(state, Graph):
+        g = state
+        B = data["B"]
+        state_args = dict(state_args, deg_corr=data["deg_corr"])
+        if data["kind"] == "nested":
+            bs = [numpy.zeros(g.num_vertices(), dtype="int")]
+            bs += [numpy.zeros(b, dtype="int") for b in B[:-1]]
+            state = NestedBlockState(g, bs=bs, **dict(state_args, B=B[0]))
+        else:
+            state = BlockState(g, B=B, **state_args)
+    state.set_snapshot(data["snapshot"])
+    if m_state is not None:
+        if data["m_state"] is None:
+            raise ValueError("checkpoint contains no multicanonical state")
+        m_state.set_snapshot(data["m_state"])
+    graph_tool._rng = data["rng"]
+    numpy.random.set_state(data["numpy_rng"])
+    return state
@@ -24,6 +24,7 @@ if sys.version_info < (3,):
     range = xrange
 
 import numpy
+import time
 from . util import *
 from . mcmc import *
 from . bisection import *
@@ -60,6 +61,26 @@ def default_args(mcmc_args={}, anneal_args={}, mcmc_equilibrate_args={},
     return mcmc_multilevel_args
 
 
+class _Checkpointer(object):
+    r"""Callable which saves the state passed to it with
+    :func:`~graph_tool.inference.save_checkpoint`, at most once every
+    ``interval`` seconds, unless ``force == True``. Nothing is done if
+    ``filename`` is ``None``."""
+
+    def __init__(self, filename, interval=0):
+        self.filename = filename
+        self.interval = interval
+        self.last = None
+
+    def __call__(self, state, force=False):
+        if self.filename is None:
+            return
+        if (force or self.last is None or
+            time.time() - self.last >= self.interval):
+            save_checkpoint(self.filename, state)
+            self.last = time.time()
+
+
 def get_states(g, B_min=None, B_max=None, b_min=None, b_max=None, deg_corr=True,
                overlap=False, nonoverlap_init=True, layers=False, clabel=None,
                state_args={}, mcmc_multilevel_args={}):
@@ -119,7 +140,8 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
                            layers=False, state_args={}, bisection_args={},
                            mcmc_args={}, anneal_args={},
                            mcmc_equilibrate_args={}, shrink_args={},
-                           mcmc_multilevel_args={}, verbose=False):
+                           mcmc_multilevel_args={}, checkpoint=None,
+                           checkpoint_interval=0, verbose=False):
     """Fit the stochastic block model.
 
     Parameters
@@ -162,6 +184,15 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
         :meth:`graph_tool.inference.LayeredBlockState.shrink`.
     mcmc_multilevel_args : ``dict`` (optional, default: ``{}``)
         Arguments to be passed to :func:`~graph_tool.inference.mcmc_multilevel`.
+    checkpoint : ``str`` (optional, default: ``None``)
+        If given, the state with the smallest description length found so far
+        is saved to this file with :func:`~graph_tool.inference.save_checkpoint`
+        after each bisection step, and the final state at the end. It can be
+        restored with ``load_checkpoint(checkpoint, g, state_args=state_args)``
+        (see :func:`~graph_tool.inference.load_checkpoint`). This is not
+        supported for overlapping or layered states.
+    checkpoint_interval : ``float`` (optional, default: ``0``)
+        Minimum time (in seconds) between two checkpoints.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -270,6 +301,10 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
 
     """
 
+    if checkpoint is not None and (overlap or layers):
+        raise ValueError("checkpoints are not supported for overlapping or " +
+                         "layered states")
+
     b_cache = {} # keep a global cache
 
     mcmc_multilevel_args = \
@@ -307,9 +342,15 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
         if B > B_max or B < B_min:
             del b_cache[B]
 
+    checkpointer = _Checkpointer(checkpoint, checkpoint_interval)
+    if checkpoint is not None:
+        bisection_args = dict(bisection_args, callback=checkpointer)
+
     state = bisection_minimize([min_state, max_state], verbose=verbose,
                                **bisection_args)
 
+    checkpointer(state, force=True)
+
     return state
 
 def minimize_nested_blockmodel_dl(g, B_min=None, B_max=None, b_min=None,
@@ -319,7 +360,8 @@ def minimize_nested_blockmodel_dl(g, B_min=None, B_max=None, b_min=None,
                                   state_args={}, bisection_args={},
                                   mcmc_args={}, anneal_args={},
                                   mcmc_equilibrate_args={}, shrink_args={},
-                                  mcmc_multilevel_args={}, verbose=False):
+                                  mcmc_multilevel_args={}, checkpoint=None,
+                                  checkpoint_interval=0, verbose=False):
     """Fit the nested stochastic block model.
 
     Parameters
@@ -368,6 +410,16 @@ def minimize_nested_blockmodel_dl(g, B_min=None, B_max=None, b_min=None,
         :meth:`graph_tool.inference.LayeredBlockState.shrink`.
     mcmc_multilevel_args : ``dict`` (optional, default: ``{}``)
         Arguments to be passed to :func:`~graph_tool.inference.mcmc_multilevel`.
+    checkpoint : ``str`` (optional, default: ``None``)
+        If given, the current hierarchy is saved to this file with
+        :func:`~graph_tool.inference.save_checkpoint` each time a level has
+        been processed by :func:`~graph_tool.inference.hierarchy_minimize`, and
+        the final state at the end. It can be restored with
+        ``load_checkpoint(checkpoint, g, state_args=state_args)`` (see
+        :func:`~graph_tool.inference.load_checkpoint`). This is not supported
+        for overlapping or layered states.
+    checkpoint_interval : ``float`` (optional, default: ``0``)
+        Minimum time (in seconds) between two checkpoints.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -457,6 +509,10 @@ def minimize_nested_blockmodel_dl(g, B_min=None, B_max=None, b_min=None,
 
     """
 
+    if checkpoint is not None and (overlap or layers):
+        raise ValueError("checkpoints are not supported for overlapping or " +
+                         "layered states")
+
     mcmc_multilevel_args = \
             default_args(mcmc_args=mcmc_args,
                          anneal_args=anneal_args,
@@ -508,10 +564,17 @@ def minimize_nested_blockmodel_dl(g, B_min=None, B_max=None, b_min=None,
                                random_bisection=False),
                           **bisection_args)
 
+    checkpointer = _Checkpointer(checkpoint, checkpoint_interval)
+    if checkpoint is not None:
+        hierarchy_minimize_args = dict(hierarchy_minimize_args,
+                                       callback=checkpointer)
+
     hierarchy_minimize(state, B_max=B_max, B_min=B_min, b_max=b_max,
                        b_min=b_min, bisection_args=bisection_args,
                        verbose=verbose,
                        **dmask(hierarchy_minimize_args,
                                ["B_max", "B_min", "bisection_args", "verbose"]))
 
+    checkpointer(state, force=True)
+
     return state
\ No newline at end of file
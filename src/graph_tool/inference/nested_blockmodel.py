@@ -32,6 +32,7 @@ from . layered_blockmodel import *
 from numpy import *
 import numpy
 import copy
+import pickle
 
 def get_edges_dl(state, hstate_args, hentropy_args):
     bclabel = state.get_bclabel()
@@ -159,6 +160,43 @@ class NestedBlockState(object):
             del  state["kwargs"]
         self.__init__(**state)
 
+    def get_snapshot(self):
+        r"""Return a compact binary snapshot of the hierarchy, as a ``bytes``
+        object.
+
+        The bottom level is saved with :meth:`~BlockState.get_snapshot`, and the
+        upper levels by their partitions only, since their graphs are the block
+        graphs of the levels below. It can be restored with
+        :meth:`~NestedBlockState.set_snapshot`."""
+        bs = [numpy.array(s.b.fa, dtype="int32") for s in self.levels[1:]]
+        return pickle.dumps((self.levels[0].get_snapshot(), bs),
+                            protocol=pickle.HIGHEST_PROTOCOL)
+
+    def set_snapshot(self, snapshot):
+        r"""Restore a snapshot obtained with :meth:`~NestedBlockState.get_snapshot`.
+
+        The bottom level is restored in place, and the upper levels are rebuilt
+        from it and their saved partitions. The hierarchy must have the same
+        number of levels, and its bottom level the same graph and parameters,
+        as the one the snapshot was taken from."""
+        s0, bs = pickle.loads(snapshot)
+        if len(bs) != len(self.levels) - 1:
+            raise ValueError("snapshot has %d levels, but the hierarchy has %d" %
+                             (len(bs) + 1, len(self.levels)))
+        # the upper levels are replaced below, so no level may remain coupled
+        # to them
+        for lstate in self.levels:
+            lstate._couple_state(None, None)
+        self.levels[0].set_snapshot(s0)
+        for l, b in enumerate(bs):
+            args = self.hstate_args
+            if l == len(bs) - 1:
+                args = dict(args, clabel=None, pclabel=None)
+            self.levels[l + 1] = self.levels[l].get_block_state(b=b, **args)
+
+        if _bm_test():
+            self._consistency_check()
+
     def get_bs(self):
         """Get hierarchy levels as a list of :class:`numpy.ndarray` objects with the
         group memberships at each level.
@@ -652,7 +690,7 @@ class NestedBlockState(object):
 
 def hierarchy_minimize(state, B_min=None, B_max=None, b_min=None, b_max=None,
                        frozen_levels=None, sparse_thres=100, bisection_args={},
-                       epsilon=1e-8, verbose=False):
+                       epsilon=1e-8, callback=None, verbose=False):
     """Attempt to find a fit of the nested stochastic block model that minimizes the
     description length.
 
@@ -679,6 +717,9 @@ def hierarchy_minimize(state, B_min=None, B_max=None, b_min=None, b_max=None,
     epsilon: ``float`` (optional, default: ``1e-8``)
         Only replace levels if the description length difference is above this
         threshold.
+    callback : ``function`` (optional, default: ``None``)
+        If given, this function will be called with the current state as its
+        argument, each time a level has been processed.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -873,6 +914,9 @@ def hierarchy_minimize(state, B_min=None, B_max=None, b_min=None, b_max=None,
         if l >= len(state.levels):
             l = len(state.levels) - 1
 
+        if callback is not None:
+            callback(state)
+
     return dS
 
 
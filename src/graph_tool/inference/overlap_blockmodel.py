@@ -78,15 +78,16 @@ class OverlapBlockState(BlockState):
     allow_empty : ``bool`` (optional, default: ``True``)
         If ``True``, partition description length computed will allow for empty
         groups.
-    max_BE : ``int`` (optional, default: ``1000``)
-        If the number of blocks exceeds this number, a sparse representation of
-        the block graph is used, which is slightly less efficient, but uses less
-        memory,
+    max_BE : ``int`` (optional, default: ``None``)
+        If given, and the number of blocks exceeds this value, a sparse
+        representation of the block graph is always used. Otherwise, a dense
+        or sparse representation is chosen automatically, depending on the
+        number of blocks and the density of the block graph.
     """
 
     def __init__(self, g, b=None, B=None, recs=[], rec_types=[], rec_params=[],
                  clabel=None, pclabel=None, deg_corr=True, allow_empty=True,
-                 max_BE=1000, **kwargs):
+                 max_BE=None, **kwargs):
 
         kwargs = kwargs.copy()
 
@@ -233,7 +234,7 @@ class OverlapBlockState(BlockState):
 
         self.max_BE = max_BE
 
-        self.use_hash = self.B > self.max_BE
+        self.use_hash = self.max_BE is not None and self.B > self.max_BE
 
         self.allow_empty = allow_empty
 